@@ -3,7 +3,9 @@
 #include <memory>
 
 #include "Context.h"
+#include "log.h"
 
+#include "Connection.h"
 #include "connection/Core.h"
 #if !(_WIN32)
 #include <cstdlib>
@@ -45,3 +47,46 @@ namespace Gadgetron::Server::Connection {
 
 #endif
 }
+
+namespace Gadgetron::Server::Connection {
+
+    PersistentWorkers::PersistentWorkers(
+            const Gadgetron::Core::Context::Paths &paths,
+            const Gadgetron::Core::Context::Args &args,
+            size_t workers
+    ) : paths(paths), args(args) {
+        for (size_t i = 0; i < workers; i++) {
+            this->workers.emplace_back([this]() { serve_connections(); });
+        }
+    }
+
+    PersistentWorkers::~PersistentWorkers() {
+        pending.close();
+        for (auto &worker : workers) worker.join();
+    }
+
+    void PersistentWorkers::handle(std::unique_ptr<std::iostream> stream) {
+        // Claiming an idle worker before queueing the connection ensures it is picked up right away.
+        auto available = idle.load();
+        while (available && !idle.compare_exchange_weak(available, available - 1));
+
+        if (available) {
+            pending.push(std::move(stream));
+            return;
+        }
+
+        GDEBUG_STREAM("All persistent workers busy; handling connection on a new thread.");
+        auto thread = std::thread(handle_connection, std::move(stream), paths, args);
+        thread.detach();
+    }
+
+    void PersistentWorkers::serve_connections() {
+        try {
+            while (true) {
+                idle++;
+                handle_connection(pending.pop(), paths, args);
+            }
+        }
+        catch (const Core::ChannelClosed &) {}
+    }
+}
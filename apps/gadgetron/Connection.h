@@ -1,9 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "Context.h"
+#include "MPMCChannel.h"
 
 namespace Gadgetron::Server::Connection {
     void handle(
@@ -11,4 +15,31 @@ namespace Gadgetron::Server::Connection {
             const Gadgetron::Core::Context::Args &args,
             std::unique_ptr<std::iostream> stream
     );
+
+    /**
+     * Handles connections on persistent threads in the server process, rather than forking for every connection.
+     * Loaded shared libraries, parsed configuration files and FFTW plans then carry over from one connection to
+     * the next. Connections arriving while every worker is busy are handled on a thread of their own.
+     */
+    class PersistentWorkers {
+    public:
+        PersistentWorkers(
+                const Gadgetron::Core::Context::Paths &paths,
+                const Gadgetron::Core::Context::Args &args,
+                size_t workers
+        );
+        ~PersistentWorkers();
+
+        void handle(std::unique_ptr<std::iostream> stream);
+
+    private:
+        void serve_connections();
+
+        const Gadgetron::Core::Context::Paths paths;
+        const Gadgetron::Core::Context::Args args;
+
+        Gadgetron::Core::MPMCChannel<std::unique_ptr<std::iostream>> pending;
+        std::atomic<size_t> idle{ 0 };
+        std::vector<std::thread> workers;
+    };
 }
@@ -28,12 +28,25 @@ void Server::serve() {
     boost::asio::ip::tcp::acceptor acceptor(service, local);
     acceptor.set_option(boost::asio::socket_base::reuse_address(true));
 
+    auto persistent_workers = args["connection_workers"].as<size_t>();
+    auto workers = persistent_workers ?
+            std::make_unique<Connection::PersistentWorkers>(paths, args, persistent_workers) : nullptr;
+
     while(true) {
         auto socket = std::make_unique<boost::asio::ip::tcp::socket>(service);
         acceptor.accept(*socket);
 
         GINFO_STREAM("Accepted connection from: " << socket->remote_endpoint().address());
 
-        Connection::handle(paths, args, Gadgetron::Connection::stream_from_socket(std::move(socket)));
+        auto stream = Gadgetron::Connection::stream_from_socket(
+                std::move(socket),
+                args["socket_buffer_size"].as<size_t>()
+        );
+
+        if (workers) {
+            workers->handle(std::move(stream));
+        } else {
+            Connection::handle(paths, args, std::move(stream));
+        }
     }
 }
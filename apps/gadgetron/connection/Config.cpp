@@ -6,6 +6,7 @@
 #include <memory>
 #include <string>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/parameter/name.hpp>
 #include <boost/range/algorithm/transform.hpp>
 #include <boost/range/algorithm/count_if.hpp>
@@ -107,6 +108,7 @@ namespace {
         template<class ConfigNode>
         static pugi::xml_node add_node(const ConfigNode &configNode, pugi::xml_node &node) {
             auto gadget_node = add_basenode(configNode, node);
+            if (configNode.fuse) gadget_node.append_attribute("fuse").set_value(*configNode.fuse);
             add_name(configNode, gadget_node);
             for (auto property : configNode.properties) add_property(property, gadget_node);
             return gadget_node;
@@ -136,6 +138,7 @@ namespace {
             auto execute_node = node.append_child("execute");
             execute_node.append_attribute("name").set_value(execute.name.c_str());
             execute_node.append_attribute("type").set_value(execute.type.c_str());
+            if (execute.shared_memory) execute_node.append_attribute("shared_memory").set_value(true);
             return execute_node;
         }
 
@@ -163,6 +166,11 @@ namespace {
         static pugi::xml_node add_node(const Config::Stream &stream, pugi::xml_node &node) {
             auto stream_node = node.append_child("stream");
             stream_node.append_attribute("key").set_value(stream.key.c_str());
+            if (stream.backpressure) {
+                stream_node.append_attribute("high_watermark").set_value((long long unsigned int)stream.backpressure->high_watermark);
+                stream_node.append_attribute("low_watermark").set_value((long long unsigned int)stream.backpressure->low_watermark);
+            }
+            if (!stream.fuse) stream_node.append_attribute("fuse").set_value(false);
             for (auto node : stream.nodes) {
                 visit([&stream_node](auto &typed_node) { add_node(typed_node, stream_node); }, node);
             }
@@ -320,10 +328,14 @@ namespace {
 
         template<class NODE>
         NODE parse_node(const pugi::xml_node &gadget_node) {
-            return NODE{gadget_node.child_value("name"),
-                        gadget_node.child_value("dll"),
-                        gadget_node.child_value("classname"),
-                        parse_properties(gadget_node)};
+            NODE node{gadget_node.child_value("name"),
+                      gadget_node.child_value("dll"),
+                      gadget_node.child_value("classname"),
+                      parse_properties(gadget_node)};
+
+            auto fuse = gadget_node.attribute("fuse");
+            if (fuse) node.fuse = fuse.as_bool();
+            return node;
         }
 
     private:
@@ -535,7 +547,26 @@ namespace {
             for (auto &node : stream_node.children()) {
                 nodes.push_back(node_parsers.at(node.name())(node));
             }
-            return Config::Stream{stream_node.attribute("key").value(), nodes};
+            return Config::Stream{
+                    stream_node.attribute("key").value(),
+                    nodes,
+                    parse_backpressure(stream_node),
+                    stream_node.attribute("fuse").as_bool(true)
+            };
+        }
+
+        static optional<Config::Backpressure> parse_backpressure(const pugi::xml_node &stream_node) {
+            auto high_watermark = stream_node.attribute("high_watermark");
+            if (!high_watermark) return none;
+
+            size_t high = std::stoul(high_watermark.value());
+            if (high == 0) throw ConfigNodeError("Stream high_watermark must be positive", stream_node);
+
+            auto low_watermark = stream_node.attribute("low_watermark");
+            size_t low = low_watermark ? std::stoul(low_watermark.value()) : high / 2;
+            if (low >= high) throw ConfigNodeError("Stream low_watermark must be below high_watermark", stream_node);
+
+            return Config::Backpressure{high, low};
         }
 
         Config::PureStream parse_purestream(const pugi::xml_node &purestream_node){
@@ -565,11 +596,18 @@ namespace {
         }
 
         static Config::Execute parse_execute(const pugi::xml_node &execute_node) {
-            return Config::Execute {
+            auto execute = Config::Execute {
                 execute_node.attribute("name").value(),
                 execute_node.attribute("type").value(),
-                parse_target(execute_node.attribute("target").value())
+                parse_target(execute_node.attribute("target").value()),
+                execute_node.attribute("shared_memory").as_bool(false)
             };
+
+            // Only the Python modules know how to read arrays placed in shared memory.
+            if (execute.shared_memory && !boost::algorithm::iequals(execute.type, "python"))
+                throw ConfigNodeError("Shared memory is only supported for python externals", execute_node);
+
+            return execute;
         }
 
         static Config::Connect parse_connect(const pugi::xml_node &connect_node) {
@@ -31,9 +31,15 @@ namespace Gadgetron::Server::Connection {
             std::string dll, classname;
         };
 
+        struct Backpressure {
+            size_t high_watermark, low_watermark;
+        };
+
         struct Stream {
             std::string key;
             std::vector<Node> nodes;
+            boost::optional<Backpressure> backpressure;
+            bool fuse = true;
         };
 
         struct PureStream{
@@ -43,6 +49,7 @@ namespace Gadgetron::Server::Connection {
         struct Gadget {
             std::string name, dll, classname;
             std::unordered_map<std::string, std::string> properties;
+            boost::optional<bool> fuse;
             Gadget(std::string name, std::string dll, std::string classname, std::unordered_map<std::string, std::string> properties):
             name(std::move(name)), dll(std::move(dll)), classname(std::move(classname)), properties(std::move(properties))
             {
@@ -53,6 +60,7 @@ namespace Gadgetron::Server::Connection {
         struct Execute {
             std::string name, type;
             boost::optional<std::string> target;
+            bool shared_memory = false;
         };
 
         struct Connect {
@@ -2,6 +2,8 @@
 #include "ConfigConnection.h"
 
 #include <map>
+#include <mutex>
+#include <fstream>
 #include <iostream>
 
 #include "gadgetron_config.h"
@@ -28,6 +30,32 @@ namespace {
         return std::string(buffer.data());
     }
 
+    // Parsed configuration files are kept for the lifetime of the process, and reparsed only if modified.
+    Config load_config_file(const boost::filesystem::path &filename) {
+        static std::mutex mutex;
+        static std::map<std::string, std::pair<std::time_t, Config>> parsed_configs;
+
+        boost::system::error_code error;
+        auto modified = boost::filesystem::last_write_time(filename, error);
+        if (error) {
+            std::ifstream config_stream(filename.string());
+            return parse_config(config_stream);
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto parsed = parsed_configs.find(filename.string());
+            if (parsed != parsed_configs.end() && parsed->second.first == modified) return parsed->second.second;
+        }
+
+        std::ifstream config_stream(filename.string());
+        auto config = parse_config(config_stream);
+
+        std::lock_guard<std::mutex> guard(mutex);
+        parsed_configs[filename.string()] = std::make_pair(modified, config);
+        return config;
+    }
+
     class ConfigHandler : public Handler {
     public:
         explicit ConfigHandler(std::function<void(Config)> callback)
@@ -37,6 +65,10 @@ namespace {
             callback(parse_config(config_stream));
         }
 
+        void handle_callback(Config config) {
+            callback(std::move(config));
+        }
+
     private:
         std::function<void(Config)> callback;
     };
@@ -53,8 +85,7 @@ namespace {
 
             GDEBUG_STREAM("Reading config file: " << filename);
 
-            std::ifstream config_stream(filename.string());
-            handle_callback(config_stream);
+            handle_callback(load_config_file(filename));
         }
 
     private:
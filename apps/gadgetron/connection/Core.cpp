@@ -2,6 +2,7 @@
 #include "Core.h"
 
 #include "ConfigConnection.h"
+#include "Metrics.h"
 #include "Writers.h"
 
 namespace {
@@ -56,6 +57,8 @@ namespace Gadgetron::Server::Connection {
     ) {
 
         stream->exceptions(std::istream::failbit | std::istream::badbit | std::istream::eofbit);
+        Metrics::write_periodically(args);
+
         ErrorSender sender;
 
         ErrorHandler error_handler(sender,"Connection Main Thread");
@@ -6,6 +6,7 @@
 
 
 #include "io/primitives.h"
+#include "OutputPipeline.h"
 #include "Writer.h"
 #include "Channel.h"
 #include "Context.h"
@@ -101,20 +102,14 @@ namespace Gadgetron::Server::Connection {
     }
 
     template<class F>
-    void process_output(std::iostream &stream, Core::GenericInputChannel messages, F writer_factory) {
-
+    void process_output(
+            std::iostream &stream,
+            Core::GenericInputChannel messages,
+            F writer_factory,
+            size_t max_bytes_in_flight
+    ) {
         auto writers = writer_factory();
-
-        for (auto message : messages) {
-
-            auto writer = std::find_if(writers.begin(), writers.end(),
-                                       [&](auto &writer) { return writer->accepts(message); }
-            );
-
-            if (writer != writers.end()) {
-                (*writer)->write(stream, std::move(message));
-            }
-        }
+        pipeline_output(stream, std::move(messages), writers, max_bytes_in_flight);
     }
 
     std::vector<std::unique_ptr<Core::Writer>> default_writers();
@@ -137,10 +132,13 @@ namespace Gadgetron::Server::Connection {
             std::iostream &stream,
             Core::GenericInputChannel channel,
             F writer_factory,
-            ErrorHandler &error_handler
+            ErrorHandler &error_handler,
+            size_t max_bytes_in_flight = default_max_output_bytes_in_flight
     ) {
         return ErrorHandler(error_handler,"Connection Output Thread").run(
-                [&stream](auto c, auto w) { process_output(stream, std::move(c), w); },
+                [&stream, max_bytes_in_flight](auto c, auto w) {
+                    process_output(stream, std::move(c), w, max_bytes_in_flight);
+                },
                 std::move(channel), writer_factory
         );
     }
@@ -6,6 +6,7 @@
 
 #include "io/primitives.h"
 #include "Response.h"
+#include "Metrics.h"
 
 namespace {
 
@@ -56,6 +57,12 @@ namespace {
         answers["gadgetron::cuda::memory"]       = cuda_memory();
         answers["gadgetron::cuda::capabilities"] = cuda_capabilities();
     }
+
+    void initialize_with_live_queries(std::map<std::string, std::function<std::string()>> &answers) {
+
+        answers["gadgetron::metrics"]             = Connection::Metrics::to_json;
+        answers["gadgetron::metrics::prometheus"] = Connection::Metrics::to_prometheus;
+    }
 }
 
 namespace Gadgetron::Server::Connection::Handlers {
@@ -66,6 +73,7 @@ namespace Gadgetron::Server::Connection::Handlers {
     QueryHandler::QueryHandler()
     {
         initialize_with_default_queries(answers);
+        initialize_with_live_queries(live_answers);
     }
 
     QueryHandler::QueryHandler(
@@ -83,6 +91,12 @@ namespace Gadgetron::Server::Connection::Handlers {
             throw std::runtime_error("Unsupported value in reserved bytes.");
         }
 
+        auto live_answer = live_answers.find(query);
+        if (live_answer != live_answers.end()) {
+            channel.push(Response(corr_id, live_answer->second()));
+            return;
+        }
+
         channel.push(Response(corr_id, answers.at(query)));
     }
 
@@ -27,6 +27,9 @@ namespace Gadgetron::Server::Connection::Handlers {
         void handle(std::istream &stream, Gadgetron::Core::OutputChannel &channel) override;
 
         std::map<std::string, std::string> answers;
+
+        /// Queries answered anew every time they are asked, such as the metrics of the running streams.
+        std::map<std::string, std::function<std::string()>> live_answers;
     };
 
     class ErrorProducingHandler : public Handler {
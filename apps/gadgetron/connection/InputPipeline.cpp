@@ -0,0 +1,110 @@
+#include "InputPipeline.h"
+
+namespace {
+    using namespace Gadgetron::Core;
+
+    std::future<Message> ready(Message message) {
+        std::promise<Message> promise;
+        promise.set_value(std::move(message));
+        return promise.get_future();
+    }
+}
+
+namespace Gadgetron::Server::Connection {
+
+    unsigned int input_decode_workers(const Core::Context::Args &args) {
+        if (!args.count("input_decode_workers")) return default_input_decode_workers;
+        return args["input_decode_workers"].as<unsigned int>();
+    }
+
+    InputPipeline::InputPipeline(unsigned int workers)
+        : workers{workers},
+          pool{std::max(workers, 1u)},
+          queue{4 * size_t(std::max(workers, 1u)), 2 * size_t(std::max(workers, 1u))} {
+        if (workers) forwarder = std::thread([this]() { forward(); });
+    }
+
+    InputPipeline::~InputPipeline() {
+        queue.close();
+        if (forwarder.joinable()) forwarder.join();
+    }
+
+    void InputPipeline::push(Core::Reader::PendingMessage pending, Core::OutputChannel &output) {
+
+        if (auto message = Core::get_if<Core::Message>(&pending)) {
+            {
+                std::lock_guard<std::mutex> guard(m);
+                rethrow_error();
+                // Nothing ahead of this message; it may overtake the pipeline.
+                if (outstanding == 0) {
+                    output.push_message(std::move(*message));
+                    return;
+                }
+                outstanding++;
+            }
+            queue.push(ready(std::move(*message)));
+            return;
+        }
+
+        auto &decode = Core::get<std::packaged_task<Core::Message()>>(pending);
+
+        if (!workers) {
+            auto message = decode.get_future();
+            decode();
+            output.push_message(message.get());
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m);
+            rethrow_error();
+            channel = &output;
+            outstanding++;
+        }
+
+        auto message = decode.get_future();
+        pool.async(std::move(decode));
+        queue.push(std::move(message));
+    }
+
+    void InputPipeline::flush() {
+        std::unique_lock<std::mutex> lock(m);
+        drained.wait(lock, [this]() { return outstanding == 0; });
+        rethrow_error();
+    }
+
+    void InputPipeline::rethrow_error() {
+        if (error) std::rethrow_exception(error);
+    }
+
+    void InputPipeline::forward() {
+        while (true) {
+            std::future<Core::Message> message;
+            try {
+                message = queue.pop();
+            } catch (const Core::ChannelClosed &) {
+                return;
+            }
+
+            bool failed;
+            Core::OutputChannel *output;
+            {
+                std::lock_guard<std::mutex> guard(m);
+                failed = bool(error);
+                output = channel;
+            }
+
+            // Once a message is lost, the ones behind it are dropped too, rather than delivered out of sequence.
+            std::exception_ptr failure;
+            try {
+                if (failed) message.wait(); else output->push_message(message.get());
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> guard(m);
+            if (failure && !error) error = failure;
+            if (--outstanding == 0) drained.notify_all();
+        }
+    }
+}
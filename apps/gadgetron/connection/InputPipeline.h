@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "Channel.h"
+#include "Context.h"
+#include "MPMCChannel.h"
+#include "Reader.h"
+#include "ThreadPool.h"
+
+namespace Gadgetron::Server::Connection {
+
+    constexpr unsigned int default_input_decode_workers = 4;
+
+    unsigned int input_decode_workers(const Core::Context::Args &args);
+
+    /**
+     * Decodes messages on a pool of workers while the input thread reads on, for readers which defer decoding
+     * (see Core::Reader::read_pending). Messages reach the channel in the order they were read. Reading blocks
+     * while a few messages per worker are waiting to be decoded or forwarded.
+     *
+     * With no workers, messages are decoded on the input thread as they are read.
+     */
+    class InputPipeline {
+    public:
+        explicit InputPipeline(unsigned int workers);
+        ~InputPipeline();
+
+        void push(Core::Reader::PendingMessage message, Core::OutputChannel &channel);
+
+        /// Waits until every message pushed so far has reached the channel.
+        void flush();
+
+    private:
+        void forward();
+        void rethrow_error();
+
+        const unsigned int workers;
+        Core::ThreadPool pool;
+        Core::BoundedMPMCChannel<std::future<Core::Message>> queue;
+
+        Core::OutputChannel *channel = nullptr;
+
+        std::mutex m;
+        std::condition_variable drained;
+        size_t outstanding = 0;
+        std::exception_ptr error;
+
+        std::thread forwarder;
+    };
+}
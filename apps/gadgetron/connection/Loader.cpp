@@ -1,6 +1,8 @@
 #include "Loader.h"
 
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include "stream/Stream.h"
 
@@ -9,6 +11,27 @@ namespace {
 
     using reader_factory = std::unique_ptr<Reader>();
     using writer_factory = std::unique_ptr<Writer>();
+
+    // Libraries stay loaded for the lifetime of the process, so connections after the first skip loading them.
+    boost::dll::shared_library load_shared_library(const std::string &shared_library_name) {
+        static std::mutex mutex;
+        static std::map<std::string, boost::dll::shared_library> loaded_libraries;
+
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto loaded = loaded_libraries.find(shared_library_name);
+        if (loaded != loaded_libraries.end()) return loaded->second;
+
+        auto lib = boost::dll::shared_library(
+                shared_library_name,
+                boost::dll::load_mode::append_decorations |
+                boost::dll::load_mode::search_system_folders |
+                boost::dll::load_mode::rtld_global
+        );
+
+        loaded_libraries.emplace(shared_library_name, lib);
+        return lib;
+    }
 }
 
 namespace Gadgetron::Server::Connection {
@@ -18,15 +41,7 @@ namespace Gadgetron::Server::Connection {
 
 
     boost::dll::shared_library Loader::load_library(const std::string &shared_library_name) {
-        auto lib = boost::dll::shared_library(
-			shared_library_name,
-                                boost::dll::load_mode::append_decorations |
-                                boost::dll::load_mode::search_system_folders |
-                boost::dll::load_mode::rtld_global 
-                
-
-        );
-
+        auto lib = load_shared_library(shared_library_name);
         libraries.push_back(lib);
         return lib;
     }
@@ -0,0 +1,346 @@
+#include "Metrics.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "log.h"
+
+namespace {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron::Server::Connection::Metrics;
+
+    int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    class InstrumentedInput : public Channel {
+    public:
+        InstrumentedInput(GenericInputChannel channel, NodeMetrics &metrics)
+                : channel{std::move(channel)}, metrics{metrics} {}
+
+    protected:
+        Message pop() override {
+            auto start = now();
+            try {
+                auto message = channel.pop();
+                count(message, now() - start);
+                return message;
+            }
+            catch (const ChannelClosed &) {
+                metrics.pop_blocked += now() - start;
+                throw;
+            }
+        }
+
+        optional<Message> try_pop() override {
+            auto start = now();
+            auto message = channel.try_pop();
+            if (message) count(*message, now() - start);
+            return message;
+        }
+
+        void push_message(Message) override {
+            throw std::runtime_error("Messages cannot be pushed to the input of a node");
+        }
+
+        // The wrapped channel is closed when this channel is destroyed; see InstrumentedEnds.
+        void close() override {}
+
+    private:
+        void count(const Message &message, int64_t blocked) {
+            metrics.pop_blocked += blocked;
+            metrics.bytes_in += message.bytes();
+            metrics.messages_in++;
+        }
+
+        GenericInputChannel channel;
+        NodeMetrics &metrics;
+    };
+
+    class InstrumentedOutput : public Channel {
+    public:
+        InstrumentedOutput(OutputChannel channel, NodeMetrics &metrics)
+                : channel{std::move(channel)}, metrics{metrics} {}
+
+    protected:
+        Message pop() override {
+            throw std::runtime_error("Messages cannot be popped from the output of a node");
+        }
+
+        optional<Message> try_pop() override {
+            throw std::runtime_error("Messages cannot be popped from the output of a node");
+        }
+
+        void push_message(Message message) override {
+            auto bytes = message.bytes();
+            auto start = now();
+            channel.push_message(std::move(message));
+            metrics.push_blocked += now() - start;
+            metrics.bytes_out += bytes;
+            metrics.messages_out++;
+        }
+
+        void close() override {}
+
+    private:
+        OutputChannel channel;
+        NodeMetrics &metrics;
+    };
+
+    std::mutex registry_mutex;
+    std::list<std::weak_ptr<StreamMetrics>> registry;
+    uint64_t next_instance = 0;
+
+    std::vector<std::shared_ptr<StreamMetrics>> running_streams() {
+        std::lock_guard<std::mutex> guard(registry_mutex);
+        registry.remove_if([](auto &stream) { return stream.expired(); });
+
+        std::vector<std::shared_ptr<StreamMetrics>> streams;
+        for (auto &stream : registry) {
+            if (auto metrics = stream.lock()) streams.push_back(std::move(metrics));
+        }
+        return streams;
+    }
+
+    struct NodeSnapshot {
+        const NodeMetrics &node;
+        uint64_t messages_in, messages_out, bytes_in, bytes_out;
+        double processing, pop_blocked, push_blocked;
+        optional<int64_t> queue_depth;
+        bool running;
+    };
+
+    double seconds(int64_t nanoseconds) {
+        return std::max<int64_t>(nanoseconds, 0) * 1e-9;
+    }
+
+    // The time a node has run, less the time it waited on its channels.
+    std::vector<NodeSnapshot> snapshot(const StreamMetrics &stream) {
+        std::vector<NodeSnapshot> snapshots;
+        auto time = now();
+
+        for (size_t i = 0; i < stream.nodes.size(); i++) {
+            auto &node = *stream.nodes[i];
+
+            auto started  = node.started.load();
+            auto finished = node.finished.load();
+            auto pop_blocked  = int64_t(node.pop_blocked.load());
+            auto push_blocked = int64_t(node.push_blocked.load());
+            auto active = started ? (finished ? finished : time) - started : 0;
+
+            NodeSnapshot snapshot{
+                    node,
+                    node.messages_in, node.messages_out, node.bytes_in, node.bytes_out,
+                    seconds(active - pop_blocked - push_blocked), seconds(pop_blocked), seconds(push_blocked),
+                    none,
+                    started && !finished
+            };
+
+            // Only messages pushed by the node upstream are seen; the first node's input queue is not.
+            if (i > 0) snapshot.queue_depth = int64_t(stream.nodes[i - 1]->messages_out) - int64_t(snapshot.messages_in);
+
+            snapshots.push_back(snapshot);
+        }
+        return snapshots;
+    }
+
+    std::string json_string(const std::string &value) {
+        std::stringstream stream;
+        stream << '"';
+        for (char c : value) {
+            if (c == '"' || c == '\\') stream << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+            else stream << c;
+        }
+        stream << '"';
+        return stream.str();
+    }
+
+    std::string label_value(std::string value) {
+        boost::replace_all(value, "\\", "\\\\");
+        boost::replace_all(value, "\"", "\\\"");
+        boost::replace_all(value, "\n", "\\n");
+        return value;
+    }
+
+    void write_file(const boost::filesystem::path &path) {
+        auto contents = boost::algorithm::ends_with(path.string(), ".json") ? to_json() : to_prometheus();
+
+        // Written next to the file and renamed over it, so readers never see a partial file.
+        auto temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary.string(), std::ios::trunc);
+            file << contents;
+            if (!file) throw std::runtime_error("Unable to write metrics to " + temporary.string());
+        }
+        boost::filesystem::rename(temporary, path);
+    }
+}
+
+namespace Gadgetron::Server::Connection::Metrics {
+
+    std::shared_ptr<StreamMetrics> track(std::string key, const std::vector<std::string> &node_names) {
+        auto stream = std::make_shared<StreamMetrics>();
+        stream->key = std::move(key);
+        for (auto &name : node_names) stream->nodes.push_back(std::make_unique<NodeMetrics>(name));
+
+        std::lock_guard<std::mutex> guard(registry_mutex);
+        stream->instance = next_instance++;
+        registry.push_back(stream);
+        return stream;
+    }
+
+    InstrumentedEnds::InstrumentedEnds(
+            Core::GenericInputChannel input,
+            Core::OutputChannel output,
+            NodeMetrics &metrics
+    ) : InstrumentedEnds(
+            make_channel<InstrumentedInput>(std::move(input), metrics),
+            make_channel<InstrumentedOutput>(std::move(output), metrics),
+            metrics
+    ) {
+        metrics.started = now();
+    }
+
+    InstrumentedEnds::InstrumentedEnds(Core::ChannelPair input, Core::ChannelPair output, NodeMetrics &metrics)
+            : input{std::move(input.input)},
+              output{std::move(output.output)},
+              unused_output{std::move(input.output)},
+              unused_input{std::move(output.input)},
+              metrics{metrics} {}
+
+    InstrumentedEnds::~InstrumentedEnds() {
+        metrics.finished = now();
+    }
+
+    std::string to_json() {
+        std::stringstream stream;
+        stream << "{\"streams\":[";
+
+        auto streams = running_streams();
+        for (size_t s = 0; s < streams.size(); s++) {
+            if (s) stream << ",";
+            stream << "{\"stream\":" << json_string(streams[s]->key)
+                   << ",\"instance\":" << streams[s]->instance
+                   << ",\"nodes\":[";
+
+            auto nodes = snapshot(*streams[s]);
+            for (size_t n = 0; n < nodes.size(); n++) {
+                auto &node = nodes[n];
+                if (n) stream << ",";
+                stream << "{\"node\":" << json_string(node.node.name)
+                       << ",\"running\":" << (node.running ? "true" : "false")
+                       << ",\"messages_in\":" << node.messages_in
+                       << ",\"messages_out\":" << node.messages_out
+                       << ",\"bytes_in\":" << node.bytes_in
+                       << ",\"bytes_out\":" << node.bytes_out
+                       << ",\"processing_seconds\":" << node.processing
+                       << ",\"pop_blocked_seconds\":" << node.pop_blocked
+                       << ",\"push_blocked_seconds\":" << node.push_blocked
+                       << ",\"queue_depth\":";
+                if (node.queue_depth) stream << *node.queue_depth; else stream << "null";
+                stream << "}";
+            }
+            stream << "]}";
+        }
+
+        stream << "]}";
+        return stream.str();
+    }
+
+    std::string to_prometheus() {
+        struct Family {
+            const char *name, *type, *help;
+            std::function<optional<double>(const NodeSnapshot &)> value;
+        };
+
+        const std::vector<Family> families{
+                {"gadgetron_node_messages_in_total", "counter", "Messages taken from the node's input.",
+                 [](auto &node) { return double(node.messages_in); }},
+                {"gadgetron_node_messages_out_total", "counter", "Messages sent on by the node.",
+                 [](auto &node) { return double(node.messages_out); }},
+                {"gadgetron_node_bytes_in_total", "counter", "Payload bytes taken from the node's input.",
+                 [](auto &node) { return double(node.bytes_in); }},
+                {"gadgetron_node_bytes_out_total", "counter", "Payload bytes sent on by the node.",
+                 [](auto &node) { return double(node.bytes_out); }},
+                {"gadgetron_node_processing_seconds_total", "counter",
+                 "Time the node ran, less the time it waited on its input and output.",
+                 [](auto &node) { return node.processing; }},
+                {"gadgetron_node_pop_blocked_seconds_total", "counter", "Time the node waited for input.",
+                 [](auto &node) { return node.pop_blocked; }},
+                {"gadgetron_node_push_blocked_seconds_total", "counter", "Time the node spent pushing output.",
+                 [](auto &node) { return node.push_blocked; }},
+                {"gadgetron_node_queue_depth", "gauge", "Messages waiting in the node's input channel.",
+                 [](auto &node) -> optional<double> {
+                     if (node.queue_depth) return double(*node.queue_depth);
+                     return none;
+                 }},
+        };
+
+        std::vector<std::pair<std::shared_ptr<StreamMetrics>, std::vector<NodeSnapshot>>> snapshots;
+        for (auto &stream : running_streams()) snapshots.emplace_back(stream, snapshot(*stream));
+
+        std::stringstream stream;
+        stream << std::setprecision(9);
+        for (auto &family : families) {
+            stream << "# HELP " << family.name << " " << family.help << "\n";
+            stream << "# TYPE " << family.name << " " << family.type << "\n";
+
+            for (auto &pair : snapshots) {
+                for (auto &node : pair.second) {
+                    auto value = family.value(node);
+                    if (!value) continue;
+                    stream << family.name
+                           << "{stream=\"" << label_value(pair.first->key)
+                           << "\",instance=\"" << pair.first->instance
+                           << "\",node=\"" << label_value(node.node.name) << "\"} "
+                           << *value << "\n";
+                }
+            }
+        }
+        return stream.str();
+    }
+
+    void write_periodically(const Core::Context::Args &args) {
+        if (!args.count("metrics_file")) return;
+
+        static std::once_flag started;
+        std::call_once(started, [&]() {
+            auto path = args["metrics_file"].as<std::string>();
+            boost::replace_all(path, "{pid}", std::to_string(getpid()));
+            auto interval = std::chrono::seconds(std::max(args["metrics_interval"].as<unsigned int>(), 1u));
+
+            std::thread([=]() {
+                while (true) {
+                    std::this_thread::sleep_for(interval);
+                    try {
+                        write_file(path);
+                    }
+                    catch (const std::exception &e) {
+                        GERROR_STREAM("Writing metrics failed: " << e.what());
+                    }
+                }
+            }).detach();
+        });
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Channel.h"
+#include "Context.h"
+
+namespace Gadgetron::Server::Connection::Metrics {
+
+    /**
+     * Counters for one node of a running stream, updated as messages pass through the node's channels. Times are
+     * in nanoseconds of the steady clock.
+     */
+    struct NodeMetrics {
+        explicit NodeMetrics(std::string name) : name(std::move(name)) {}
+
+        const std::string name;
+
+        std::atomic<uint64_t> messages_in{0}, messages_out{0};
+        std::atomic<uint64_t> bytes_in{0}, bytes_out{0};
+        std::atomic<uint64_t> pop_blocked{0}, push_blocked{0};
+        std::atomic<int64_t> started{0}, finished{0};
+    };
+
+    struct StreamMetrics {
+        std::string key;
+        uint64_t instance;
+        std::vector<std::unique_ptr<NodeMetrics>> nodes;
+    };
+
+    /**
+     * Registers a stream about to run the named nodes. The stream is reported on until the returned metrics are
+     * released.
+     */
+    std::shared_ptr<StreamMetrics> track(std::string key, const std::vector<std::string> &node_names);
+
+    /**
+     * Wraps the channel ends of a node, so the messages and bytes passing through them, and the time the node spends
+     * waiting on them, are counted in metrics. The node counts as running for as long as the ends exist.
+     */
+    struct InstrumentedEnds {
+        InstrumentedEnds(Core::GenericInputChannel input, Core::OutputChannel output, NodeMetrics &metrics);
+        ~InstrumentedEnds();
+
+        Core::GenericInputChannel input;
+        Core::OutputChannel output;
+
+    private:
+        InstrumentedEnds(Core::ChannelPair input, Core::ChannelPair output, NodeMetrics &metrics);
+
+        // The other ends of the wrappers. They are unused, but their channels must stay open while the node runs.
+        Core::OutputChannel unused_output;
+        Core::GenericInputChannel unused_input;
+        NodeMetrics &metrics;
+    };
+
+    /// All running streams, as a JSON document.
+    std::string to_json();
+
+    /// All running streams, in the Prometheus text exposition format.
+    std::string to_prometheus();
+
+    /// Starts writing the metrics to the file given by --metrics_file, if any, every --metrics_interval seconds.
+    /// Only the first call in a process has any effect.
+    void write_periodically(const Core::Context::Args &args);
+}
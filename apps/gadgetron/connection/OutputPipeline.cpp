@@ -0,0 +1,175 @@
+#include "OutputPipeline.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#include "SocketStreamBuf.h"
+
+namespace {
+    using namespace Gadgetron::Core;
+
+    class MemoryBuffer : public std::streambuf {
+    public:
+        explicit MemoryBuffer(std::vector<char> &data) : data{data} {}
+
+    protected:
+        std::streamsize xsputn(const char *bytes, std::streamsize length) override {
+            data.insert(data.end(), bytes, bytes + length);
+            return length;
+        }
+
+        int overflow(int ch) override {
+            if (ch != traits_type::eof()) data.push_back(traits_type::to_char_type(ch));
+            return ch;
+        }
+
+    private:
+        std::vector<char> &data;
+    };
+
+    class InFlight {
+    public:
+        explicit InFlight(size_t max_bytes) : max_bytes{max_bytes}, max_spare_bytes{max_bytes / 4} {}
+
+        std::vector<char> spare() {
+            std::lock_guard<std::mutex> guard(m);
+            if (spares.empty()) return {};
+            auto buffer = std::move(spares.back());
+            spares.pop_back();
+            spare_bytes -= buffer.capacity();
+            return buffer;
+        }
+
+        void push(std::vector<char> buffer) {
+            std::unique_lock<std::mutex> lock(m);
+            // A message larger than the limit is still sent; it just has to wait for the pipe to drain.
+            space_available.wait(lock, [&]() {
+                return failed || queued.empty() || bytes + buffer.size() <= max_bytes;
+            });
+            if (failed) throw ChannelClosed();
+            bytes += buffer.size();
+            queued.emplace_back(std::move(buffer));
+            data_available.notify_one();
+        }
+
+        std::list<std::vector<char>> pop_all() {
+            std::unique_lock<std::mutex> lock(m);
+            data_available.wait(lock, [&]() { return closed || !queued.empty(); });
+            if (queued.empty()) throw ChannelClosed();
+            std::list<std::vector<char>> batch;
+            batch.swap(queued);
+            return batch;
+        }
+
+        void sent(std::list<std::vector<char>> buffers) {
+            std::lock_guard<std::mutex> guard(m);
+            for (auto buffer = buffers.begin(); buffer != buffers.end();) {
+                bytes -= buffer->size();
+                buffer->clear();
+
+                // Buffers are kept by their capacity; one large message must not pin its memory indefinitely.
+                auto next = std::next(buffer);
+                if (spares.size() < max_spares && spare_bytes + buffer->capacity() <= max_spare_bytes) {
+                    spare_bytes += buffer->capacity();
+                    spares.splice(spares.end(), buffers, buffer);
+                }
+                buffer = next;
+            }
+            space_available.notify_all();
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> guard(m);
+            closed = true;
+            data_available.notify_all();
+        }
+
+        void fail() {
+            std::lock_guard<std::mutex> guard(m);
+            failed = true;
+            space_available.notify_all();
+        }
+
+    private:
+        static constexpr size_t max_spares = 16;
+
+        const size_t max_bytes, max_spare_bytes;
+        size_t bytes = 0, spare_bytes = 0;
+        bool closed = false, failed = false;
+
+        std::list<std::vector<char>> queued, spares;
+        std::mutex m;
+        std::condition_variable data_available, space_available;
+    };
+
+    void transmit(std::iostream &stream, InFlight &in_flight) {
+        std::vector<boost::asio::const_buffer> buffers;
+        while (true) {
+            auto batch = in_flight.pop_all();
+
+            buffers.clear();
+            for (auto &buffer : batch) buffers.emplace_back(buffer.data(), buffer.size());
+            Gadgetron::Connection::write_buffers(stream, buffers);
+
+            in_flight.sent(std::move(batch));
+        }
+    }
+}
+
+namespace Gadgetron::Server::Connection {
+
+    size_t max_output_bytes_in_flight(const Core::Context::Args &args) {
+        if (!args.count("max_output_bytes_in_flight")) return default_max_output_bytes_in_flight;
+        return args["max_output_bytes_in_flight"].as<size_t>();
+    }
+
+    void pipeline_output(
+            std::iostream &stream,
+            Core::GenericInputChannel messages,
+            std::vector<std::unique_ptr<Core::Writer>> &writers,
+            size_t max_bytes_in_flight
+    ) {
+        InFlight in_flight{max_bytes_in_flight};
+        std::exception_ptr transmission_error;
+
+        std::thread transmitter([&]() {
+            try {
+                transmit(stream, in_flight);
+            } catch (const ChannelClosed &) {
+            } catch (...) {
+                transmission_error = std::current_exception();
+                in_flight.fail();
+            }
+        });
+
+        try {
+            for (auto message : messages) {
+                auto writer = std::find_if(writers.begin(), writers.end(),
+                                           [&](auto &writer) { return writer->accepts(message); }
+                );
+                if (writer == writers.end()) continue;
+
+                auto data = in_flight.spare();
+                MemoryBuffer buffer{data};
+                std::ostream serialized{&buffer};
+                (*writer)->write(serialized, std::move(message));
+
+                in_flight.push(std::move(data));
+            }
+        } catch (const ChannelClosed &) {
+            // Either the input is exhausted, or the transmitter failed; the latter is rethrown below.
+        } catch (...) {
+            in_flight.close();
+            transmitter.join();
+            throw;
+        }
+
+        in_flight.close();
+        transmitter.join();
+
+        if (transmission_error) std::rethrow_exception(transmission_error);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Channel.h"
+#include "Context.h"
+#include "Writer.h"
+
+namespace Gadgetron::Server::Connection {
+
+    constexpr size_t default_max_output_bytes_in_flight = 64 * 1024 * 1024;
+
+    size_t max_output_bytes_in_flight(const Core::Context::Args &args);
+
+    /**
+     * Serializes messages into memory on the calling thread, while a transmitter thread sends previously
+     * serialized messages. Whatever has accumulated while the transmitter was busy is sent as one vectored write.
+     * Serialization blocks once max_bytes_in_flight bytes are waiting to be sent.
+     * Sent buffers are reused for later messages, up to a quarter of max_bytes_in_flight.
+     */
+    void pipeline_output(
+            std::iostream &stream,
+            Core::GenericInputChannel messages,
+            std::vector<std::unique_ptr<Core::Writer>> &writers,
+            size_t max_bytes_in_flight
+    );
+}
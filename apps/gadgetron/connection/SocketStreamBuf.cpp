@@ -7,6 +7,14 @@
 #include "Types.h"
 
 #include <boost/asio.hpp>
+#include <array>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <sys/socket.h>
+#endif
+
 namespace {
     using boost::asio::ip::tcp;
 
@@ -19,18 +27,54 @@ namespace {
         return std::move(socket);
     }
 
+    std::unique_ptr<tcp::socket> connect_socket(const std::string& host, const std::string& service,
+        boost::asio::io_service& context, std::chrono::milliseconds timeout) {
+        tcp::resolver resolver{ context };
+        auto endpoints = resolver.resolve(tcp::resolver::query(host, service));
+        auto socket    = std::make_unique<tcp::socket>(context);
+
+        // Closing the socket when the timer expires aborts the pending connect.
+        boost::asio::deadline_timer timer{ context, boost::posix_time::milliseconds(timeout.count()) };
+        boost::system::error_code result = boost::asio::error::would_block;
+
+        boost::asio::async_connect(*socket, endpoints, [&](const boost::system::error_code& error, auto) {
+            result = error;
+            timer.cancel();
+        });
+        timer.async_wait([&](const boost::system::error_code& error) {
+            if (error != boost::asio::error::operation_aborted)
+                socket->close();
+        });
+
+        context.run();
+        context.reset();
+
+        if (result == boost::asio::error::operation_aborted)
+            throw std::runtime_error("Timed out connecting to " + host + ":" + service);
+        if (result)
+            throw boost::system::system_error(result);
+        return socket;
+    }
+
     class SocketStreamBuf : public std::streambuf {
     public:
-        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = 1024);
+        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket,
+            size_t buffer_size = Gadgetron::Connection::default_socket_buffer_size);
+
+        void write_buffers(const std::vector<boost::asio::const_buffer>& buffers);
+        void shutdown();
 
     protected:
         std::streamsize xsputn(const char_type* data, std::streamsize length) override;
+        std::streamsize xsgetn(char_type* data, std::streamsize length) override;
 
         int sync() override;
         int underflow() override;
         int overflow(int ch = traits_type::eof()) override;
 
     private:
+        void read_directly(char* data, size_t length);
+
         std::unique_ptr<boost::asio::ip::tcp::socket> socket;
         std::vector<char> input_buffer;
         std::vector<char> output_buffer;
@@ -48,6 +92,62 @@ namespace {
         this->setg(this->eback(), this->eback(), this->eback() + elements_read);
         return traits_type::to_int_type(*this->gptr());
     }
+    std::streamsize SocketStreamBuf::xsgetn(char* data, std::streamsize length) {
+
+        auto buffered = std::min<std::streamsize>(length, this->egptr() - this->gptr());
+        std::memcpy(data, this->gptr(), buffered);
+        this->gbump(static_cast<int>(buffered));
+        if (buffered == length) return length;
+
+        // Buffer is drained; payloads go straight into the destination memory from here on.
+        data += buffered;
+        auto remaining = static_cast<size_t>(length - buffered);
+        this->setg(this->eback(), this->eback(), this->eback());
+
+        if (remaining >= input_buffer.size()) {
+            read_directly(data, remaining);
+            return length;
+        }
+
+        // Scatter read: finish the destination and refill the input buffer with a single readv.
+        while (remaining) {
+            std::array<boost::asio::mutable_buffer, 2> buffers{
+                boost::asio::buffer(data, remaining),
+                boost::asio::buffer(input_buffer.data(), input_buffer.size())
+            };
+            auto elements_read = socket->read_some(buffers);
+
+            if (elements_read <= remaining) {
+                data += elements_read;
+                remaining -= elements_read;
+                continue;
+            }
+
+            this->setg(this->eback(), this->eback(), this->eback() + (elements_read - remaining));
+            remaining = 0;
+        }
+
+        return length;
+    }
+
+    void SocketStreamBuf::read_directly(char* data, size_t length) {
+#if !defined(_WIN32)
+        // MSG_WAITALL lets the kernel fill the whole payload in (usually) a single call.
+        while (length) {
+            auto received = ::recv(socket->native_handle(), data, length, MSG_WAITALL);
+            if (received > 0) {
+                data += received;
+                length -= received;
+                continue;
+            }
+            if (received == 0) throw boost::system::system_error(boost::asio::error::eof);
+            if (errno == EINTR) continue;
+            break; // Non-blocking socket or other error; let asio deal with it.
+        }
+#endif
+        boost::asio::read(*socket, boost::asio::buffer(data, length));
+    }
+
     int SocketStreamBuf::overflow(int ch) {
         if (this->pptr() != this->pbase()) {
             boost::asio::write(*socket, boost::asio::buffer(this->pbase(), std::distance(this->pbase(), this->pptr())));
@@ -60,6 +160,16 @@ namespace {
         return 0;
     }
 
+    void SocketStreamBuf::write_buffers(const std::vector<boost::asio::const_buffer>& buffers) {
+        this->overflow();
+        boost::asio::write(*socket, buffers);
+    }
+
+    void SocketStreamBuf::shutdown() {
+        boost::system::error_code ignored;
+        socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+    }
+
     std::streamsize SocketStreamBuf::xsputn(const char* data, std::streamsize length) {
         this->overflow();
         return boost::asio::write(*socket, boost::asio::buffer(data, length));
@@ -73,8 +183,9 @@ namespace {
     using namespace Gadgetron::Connection;
     class SocketStream : public std::iostream {
     public:
-        explicit SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket)
-            : std::iostream(new SocketStreamBuf(std::move(socket))) {
+        explicit SocketStream(std::unique_ptr<boost::asio::ip::tcp::socket> socket,
+            size_t buffer_size = default_socket_buffer_size)
+            : std::iostream(new SocketStreamBuf(std::move(socket), buffer_size)) {
             buffer = std::unique_ptr<SocketStreamBuf>(static_cast<SocketStreamBuf*>(this->rdbuf()));
         }
 
@@ -84,6 +195,12 @@ namespace {
             this->io_service = io_service;
         }
 
+        SocketStream(const std::string& host, const std::string& service, std::chrono::milliseconds timeout,
+            std::shared_ptr<boost::asio::io_service> io_service = std::make_shared<boost::asio::io_service>())
+            : SocketStream(connect_socket(host, service, *io_service, timeout)) {
+            this->io_service = io_service;
+        }
+
         ~SocketStream() override = default;
 
     private:
@@ -94,11 +211,31 @@ namespace {
 
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::stream_from_socket(
-    std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
-    return std::make_unique<SocketStream>(std::move(socket));
+    std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size) {
+    return std::make_unique<SocketStream>(std::move(socket), buffer_size);
 }
 
 std::unique_ptr<std::iostream> Gadgetron::Connection::remote_stream(
     const std::string& host, const std::string& service) {
     return std::make_unique<SocketStream>(host, service);
 }
+
+std::unique_ptr<std::iostream> Gadgetron::Connection::remote_stream(
+    const std::string& host, const std::string& service, std::chrono::milliseconds timeout) {
+    return std::make_unique<SocketStream>(host, service, timeout);
+}
+
+void Gadgetron::Connection::write_buffers(
+    std::ostream& stream, const std::vector<boost::asio::const_buffer>& buffers) {
+    if (auto socket_buffer = dynamic_cast<SocketStreamBuf*>(stream.rdbuf())) {
+        socket_buffer->write_buffers(buffers);
+        return;
+    }
+    for (auto& buffer : buffers)
+        stream.write(static_cast<const char*>(buffer.data()), buffer.size());
+}
+
+void Gadgetron::Connection::shutdown_stream(std::iostream& stream) {
+    if (auto socket_buffer = dynamic_cast<SocketStreamBuf*>(stream.rdbuf()))
+        socket_buffer->shutdown();
+}
@@ -1,10 +1,28 @@
 
 #pragma once
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <chrono>
 #include <iostream>
+#include <vector>
 
 namespace Gadgetron::Connection {
 
-    std::unique_ptr<std::iostream> stream_from_socket(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
+    /// Size of the socket stream buffers. Reads larger than this bypass the buffer entirely.
+    constexpr size_t default_socket_buffer_size = 64 * 1024;
+    /// Smaller socket buffers would turn every message header into a read of its own.
+    constexpr size_t minimum_socket_buffer_size = 4 * 1024;
+
+    std::unique_ptr<std::iostream> stream_from_socket(
+            std::unique_ptr<boost::asio::ip::tcp::socket> socket,
+            size_t buffer_size = default_socket_buffer_size
+    );
+    /// Writes all buffers to the stream; with a single vectored write if the stream is a socket stream.
+    void write_buffers(std::ostream &stream, const std::vector<boost::asio::const_buffer> &buffers);
+    /// Shuts down the socket underneath a socket stream, so reads and writes blocked on it fail. Other streams are left alone.
+    void shutdown_stream(std::iostream &stream);
+
     std::unique_ptr<std::iostream> remote_stream(const std::string & host, const std::string& service);
+    /// Connects to a remote host, giving up once timeout has passed without a connection being established.
+    std::unique_ptr<std::iostream> remote_stream(const std::string & host, const std::string& service, std::chrono::milliseconds timeout);
 }
\ No newline at end of file
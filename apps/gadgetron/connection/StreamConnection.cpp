@@ -4,6 +4,7 @@
 #include "StreamConnection.h"
 
 #include "Handlers.h"
+#include "InputPipeline.h"
 #include "Writers.h"
 #include "Loader.h"
 
@@ -26,31 +27,53 @@ namespace {
 
     class ReaderHandler : public Handler {
     public:
-        ReaderHandler(std::unique_ptr<Reader> &&reader)
-                : reader(std::move(reader)) {}
+        ReaderHandler(std::unique_ptr<Reader> &&reader, std::shared_ptr<InputPipeline> pipeline)
+                : reader(std::move(reader)), pipeline(std::move(pipeline)) {}
 
         void handle(std::istream &stream, OutputChannel &channel) override {
-            channel.push_message(reader->read(stream));
+            pipeline->push(reader->read_pending(stream), channel);
         }
 
         std::unique_ptr<Reader> reader;
-        std::shared_ptr<MessageChannel> channel;
+        std::shared_ptr<InputPipeline> pipeline;
+    };
+
+    // Messages still being decoded must reach the channel before anything another handler does.
+    class OrderedHandler : public Handler {
+    public:
+        OrderedHandler(std::unique_ptr<Handler> &&handler, std::shared_ptr<InputPipeline> pipeline)
+                : handler(std::move(handler)), pipeline(std::move(pipeline)) {}
+
+        void handle(std::istream &stream, OutputChannel &channel) override {
+            pipeline->flush();
+            handler->handle(stream, channel);
+        }
+
+        std::unique_ptr<Handler> handler;
+        std::shared_ptr<InputPipeline> pipeline;
     };
 
     std::map<uint16_t, std::unique_ptr<Handler>> prepare_handlers(
             std::function<void()> close,
-            std::map<uint16_t, std::unique_ptr<Reader>> &readers
+            std::map<uint16_t, std::unique_ptr<Reader>> &readers,
+            unsigned int decode_workers
     ) {
         std::map<uint16_t, std::unique_ptr<Handler>> handlers{};
 
+        auto pipeline = std::make_shared<InputPipeline>(decode_workers);
+
         handlers[FILENAME] = std::make_unique<ErrorProducingHandler>(CONFIG_ERROR);
         handlers[CONFIG] = std::make_unique<ErrorProducingHandler>(CONFIG_ERROR);
         handlers[HEADER] = std::make_unique<ErrorProducingHandler>(HEADER_ERROR);
         handlers[QUERY] = std::make_unique<QueryHandler>();
         handlers[CLOSE] = std::make_unique<CloseHandler>(close);
 
+        for (auto &pair : handlers) {
+            pair.second = std::make_unique<OrderedHandler>(std::move(pair.second), pipeline);
+        }
+
         for (auto &pair : readers) {
-            handlers[pair.first] = std::make_unique<ReaderHandler>(std::move(pair.second));
+            handlers[pair.first] = std::make_unique<ReaderHandler>(std::move(pair.second), pipeline);
         }
 
         return handlers;
@@ -76,7 +99,8 @@ namespace Gadgetron::Server::Connection::StreamConnection {
 
         Loader loader{context};
 
-        auto ichannel = make_channel<MessageChannel>();
+        // A bounded input channel stalls the input thread, and thus the socket, when the stream falls behind.
+        auto ichannel = Stream::make_stream_channel(config.stream.backpressure);
         auto ochannel = make_channel<MessageChannel>();
 
         auto node = loader.load(config.stream);
@@ -86,7 +110,7 @@ namespace Gadgetron::Server::Connection::StreamConnection {
         std::thread input_thread = start_input_thread(
                 stream,
                 std::move(ichannel.output),
-                [&](auto close) { return prepare_handlers(close, readers); },
+                [&](auto close) { return prepare_handlers(close, readers, input_decode_workers(context.args)); },
                 error_handler
         );
 
@@ -94,7 +118,8 @@ namespace Gadgetron::Server::Connection::StreamConnection {
                 stream,
                 std::move(ochannel.input),
                 [&]() { return prepare_writers(writers); },
-                error_handler
+                error_handler,
+                max_output_bytes_in_flight(context.args)
         );
 
         node->process(std::move(ichannel.input), std::move(ochannel.output), error_handler);
@@ -1,12 +1,13 @@
 
 #include <list>
+#include <future>
 #include <algorithm>
 
 #include "Distributed.h"
 
 #include "connection/stream/common/Closer.h"
-#include "connection/stream/common/Discovery.h"
 #include "connection/stream/common/ExternalChannel.h"
+#include "connection/stream/distributed/PeerPool.h"
 #include "io/iostream_operators.h"
 
 namespace {
@@ -16,10 +17,12 @@ namespace {
     using namespace Gadgetron::Server::Connection;
     using namespace Gadgetron::Server::Connection::Stream;
 
+    constexpr std::chrono::seconds connection_timeout{ 5 };
+    constexpr size_t max_connection_attempts = 3;
+
     class ChannelWrapper {
     public:
         ChannelWrapper(
-                const Address &peer,
                 std::shared_ptr<Serialization> serialization,
                 std::shared_ptr<Configuration> configuration
         );
@@ -28,32 +31,76 @@ namespace {
         void process_output(OutputChannel output);
 
     private:
-        std::shared_ptr<ExternalChannel> external;
+        std::shared_ptr<ExternalChannel> connect_to_peer();
+
+        std::shared_ptr<Serialization> serialization;
+        std::shared_ptr<Configuration> configuration;
+
+        std::unique_ptr<PeerPool::Lease> lease;
+        std::promise<std::shared_ptr<ExternalChannel>> connected;
+        std::shared_future<std::shared_ptr<ExternalChannel>> external;
     };
 
     ChannelWrapper::ChannelWrapper(
-            const Address &peer,
             std::shared_ptr<Serialization> serialization,
             std::shared_ptr<Configuration> configuration
-    ) {
-        GINFO_STREAM("Connecting to peer: " << peer);
-        external = std::make_shared<ExternalChannel>(
-                connect(peer, configuration),
-                std::move(serialization),
-                std::move(configuration)
-        );
+    ) : serialization(std::move(serialization)),
+        configuration(std::move(configuration)),
+        external(connected.get_future().share()) {}
+
+    std::shared_ptr<ExternalChannel> ChannelWrapper::connect_to_peer() {
+        auto &peers = PeerPool::instance();
+        auto attempts = std::max<size_t>(1, std::min(peers.size(), max_connection_attempts));
+
+        for (size_t attempt = 1;; attempt++) {
+            auto lease = std::make_unique<PeerPool::Lease>(peers.acquire());
+            try {
+                GINFO_STREAM("Connecting to peer: " << lease->address());
+                auto channel = std::make_shared<ExternalChannel>(
+                        connect(lease->address(), configuration, connection_timeout),
+                        serialization,
+                        configuration
+                );
+                lease->succeeded();
+                this->lease = std::move(lease);
+                return channel;
+            }
+            catch (const std::exception &e) {
+                lease->failed();
+                if (attempt == attempts) throw;
+                GWARN_STREAM("Failed to connect to peer " << lease->address() << "; trying another. [" << e.what() << "]");
+            }
+        }
     }
 
+    // Connecting happens here rather than when the channel is created, so the distributor is never held up by it.
     void ChannelWrapper::process_input(GenericInputChannel input) {
-        auto closer = make_closer(external);
+        try {
+            connected.set_value(connect_to_peer());
+        }
+        catch (...) {
+            connected.set_exception(std::current_exception());
+            throw;
+        }
+
+        auto channel = external.get();
+        auto closer = make_closer(channel);
         for (auto message : input) {
-            external->push_message(std::move(message));
+            channel->push_message(std::move(message));
         }
     }
 
     void ChannelWrapper::process_output(OutputChannel output) {
+        std::shared_ptr<ExternalChannel> channel;
+        try {
+            channel = external.get();
+        }
+        catch (...) {
+            return; // Failing to connect is reported by the input side.
+        }
+
         while(true) {
-            output.push_message(external->pop());
+            output.push_message(channel->pop());
             GDEBUG_STREAM("Pushed message to distributed output.");
         }
     }
@@ -71,14 +118,11 @@ namespace {
         );
 
     private:
-        Address next_peer();
-
         OutputChannel output;
 
         std::shared_ptr<Serialization> serialization;
         std::shared_ptr<Configuration> configuration;
 
-        std::list<Address> peers;
         std::list<std::thread> threads;
 
         ErrorHandler error_handler;
@@ -92,18 +136,13 @@ namespace {
     ) : serialization(std::move(serialization)),
         configuration(std::move(configuration)),
         output(std::move(output_channel)),
-        error_handler(error_handler, "Distributed") {
-
-        auto ps = discover_peers();
-        std::copy(ps.begin(), ps.end(), std::back_inserter(peers));
-    }
+        error_handler(error_handler, "Distributed") {}
 
     OutputChannel ChannelCreatorImpl::create() {
 
         auto pair = Core::make_channel<MessageChannel>();
 
         auto channel = std::make_shared<ChannelWrapper>(
-                next_peer(),
                 serialization,
                 configuration
         );
@@ -123,12 +162,6 @@ namespace {
     void ChannelCreatorImpl::join() {
         for (auto &thread : threads) thread.join();
     }
-
-    Address ChannelCreatorImpl::next_peer() {
-        auto peer = peers.front(); peers.pop_front();
-        peers.push_back(peer);
-        return peer;
-    }
 }
 
 namespace {
@@ -4,6 +4,7 @@
 #include "connection/SocketStreamBuf.h"
 #include "connection/stream/common/Closer.h"
 #include "connection/stream/common/ExternalChannel.h"
+#include "io/shared_memory.h"
 
 #include "external/Python.h"
 #include "external/Matlab.h"
@@ -63,7 +64,9 @@ namespace Gadgetron::Server::Connection::Stream {
 
         GINFO_STREAM("Connected to external module '" << execute.name << "' on port: " << port);
 
-        return Gadgetron::Connection::stream_from_socket(std::move(socket));
+        auto stream = Gadgetron::Connection::stream_from_socket(std::move(socket));
+        if (execute.shared_memory) Core::IO::enable_shared_memory(*stream);
+        return stream;
     }
 
     std::shared_ptr<ExternalChannel> External::open_external_channel(
@@ -0,0 +1,119 @@
+#include "Fused.h"
+
+#include <deque>
+#include <numeric>
+
+namespace {
+    using namespace Gadgetron::Core;
+    using namespace Gadgetron::Server::Connection;
+    using namespace Gadgetron::Server::Connection::Stream;
+
+    std::string joined_names(const std::vector<Fused::Member> &members) {
+        return std::accumulate(
+                std::next(members.begin()), members.end(), members.front().name,
+                [](auto names, auto &member) { return names + "+" + member.name; }
+        );
+    }
+
+    FusibleNode &fusible(const Fused::Member &member) {
+        auto node = dynamic_cast<FusibleNode *>(member.node.get());
+        if (!node) throw std::runtime_error("Node " + member.name + " cannot be fused");
+        return *node;
+    }
+
+    class Stage {
+    public:
+        Stage(FusibleNode &node, OutputChannel output, const ErrorHandler &error_handler, const std::string &name)
+                : node{node}, output{std::move(output)}, error_handler{error_handler, name} {
+            this->error_handler.handle([&]() {
+                this->node.start(this->output);
+                open = true;
+            });
+        }
+
+        void push(Message message) {
+            if (!open) throw ChannelClosed();
+
+            bool processed = false;
+            error_handler.handle([&]() {
+                node.process_message(std::move(message), output);
+                processed = true;
+            });
+
+            if (!processed) {
+                open = false;
+                throw ChannelClosed();
+            }
+        }
+
+        void close() {
+            if (!open) return;
+            open = false;
+            error_handler.handle([&]() { node.finish(output); });
+        }
+
+    private:
+        FusibleNode &node;
+        OutputChannel output;
+        ErrorHandler error_handler;
+        bool open = false;
+    };
+
+    // Stands in for the channel between two fused nodes; pushing a message runs the next node on the pushing thread.
+    // Closing is left to Fused::process, which finishes the stages in order.
+    class DirectChannel : public Channel {
+    public:
+        explicit DirectChannel(Stage &next) : next{next} {}
+
+    protected:
+        Message pop() override {
+            throw std::runtime_error("Messages between fused nodes cannot be popped");
+        }
+
+        optional<Message> try_pop() override {
+            throw std::runtime_error("Messages between fused nodes cannot be popped");
+        }
+
+        void push_message(Message message) override {
+            next.push(std::move(message));
+        }
+
+        void close() override {}
+
+    private:
+        Stage &next;
+    };
+}
+
+namespace Gadgetron::Server::Connection::Stream {
+
+    Fused::Fused(std::vector<Member> members) : members{std::move(members)}, name_{joined_names(this->members)} {}
+
+    void Fused::process(
+            Core::GenericInputChannel input,
+            Core::OutputChannel output,
+            ErrorHandler &error_handler
+    ) {
+        // Built back to front, so each stage can be handed a channel to the one downstream of it. The channels refer
+        // to the stages, which a deque never moves.
+        std::deque<Stage> stages;
+        stages.emplace_front(fusible(members.back()), std::move(output), error_handler, members.back().name);
+        for (auto member = std::next(members.rbegin()); member != members.rend(); member++) {
+            auto channel = Core::make_channel<DirectChannel>(stages.front());
+            stages.emplace_front(fusible(*member), std::move(channel.output), error_handler, member->name);
+        }
+
+        try {
+            for (auto message : input) stages.front().push(std::move(message));
+        }
+        catch (const Core::ChannelClosed &) {
+            // The first stage has stopped; the remaining ones are closed below.
+        }
+
+        for (auto &stage : stages) stage.close();
+    }
+
+    const std::string &Fused::name() {
+        return name_;
+    }
+}
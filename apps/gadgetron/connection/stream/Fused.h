@@ -0,0 +1,38 @@
+#pragma once
+
+#include "connection/stream/Processable.h"
+
+#include "Channel.h"
+#include "Node.h"
+
+namespace Gadgetron::Server::Connection::Stream {
+
+    /**
+     * Runs a chain of FusibleNodes on a single thread. Each node hands its output directly to the next one, so
+     * messages travel the chain without passing through channels or waking other threads.
+     *
+     * A node which fails stops taking messages, as it would on a thread of its own. The nodes upstream of it stop as
+     * well, while the nodes downstream of it are finished and closed.
+     */
+    class Fused : public Processable {
+    public:
+        struct Member {
+            std::string name;
+            std::unique_ptr<Core::Node> node;
+        };
+
+        explicit Fused(std::vector<Member> members);
+
+        void process(
+                Core::GenericInputChannel input,
+                Core::OutputChannel output,
+                ErrorHandler &error_handler
+        ) override;
+
+        const std::string &name() override;
+
+    private:
+        std::vector<Member> members;
+        const std::string name_;
+    };
+}
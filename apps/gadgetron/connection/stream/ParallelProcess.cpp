@@ -8,7 +8,8 @@ namespace Gadgetron::Server::Connection::Stream {
 
     void ParallelProcess::process_input(GenericInputChannel input, Queue &queue) {
 
-        ThreadPool pool(workers ? workers : std::thread::hardware_concurrency());
+        // Shares the process wide executor with every other stream; workers only caps our share of it.
+        ThreadPool pool(workers);
 
         for (auto message : input) {
             queue.push(
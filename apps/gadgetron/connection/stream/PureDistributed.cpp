@@ -51,7 +51,11 @@ namespace Gadgetron::Server::Connection::Stream {
 
 
     void PureDistributed::process_outbound(GenericInputChannel input, Queue &jobs) {
-        auto workers = Pool(finish_connecting_to_peers(std::move(pending_workers)));
+        Pool workers(
+                finish_connecting_to_peers(std::move(pending_workers)),
+                Pool::default_max_jobs_per_worker,
+                inactivity_timeout
+        );
 
         for (auto message : input) {
             jobs.push(workers.push(std::move(message)));
@@ -96,7 +100,8 @@ namespace Gadgetron::Server::Connection::Stream {
         configuration(std::make_shared<Configuration>(
                 context,
                 config
-        )) {
+        )),
+        inactivity_timeout(distributed_inactivity_timeout(context.args)) {
         pending_workers = begin_connecting_to_peers(std::async(discover_peers), serialization, configuration);
     }
 
@@ -1,12 +1,14 @@
 #include "Stream.h"
 
 #include "connection/stream/Processable.h"
+#include "connection/stream/Fused.h"
 #include "connection/stream/Parallel.h"
 #include "connection/stream/External.h"
 #include "connection/stream/Distributed.h"
 #include "connection/stream/ParallelProcess.h"
 #include "connection/stream/PureDistributed.h"
 #include "connection/Loader.h"
+#include "connection/Metrics.h"
 
 #include "Node.h"
 
@@ -30,7 +32,8 @@ namespace {
 
     class NodeProcessable : public Processable {
     public:
-        NodeProcessable(std::unique_ptr<Node> node, std::string name) : node(std::move(node)), name_(std::move(name)) {}
+        NodeProcessable(std::unique_ptr<Node> node, std::string name, optional<bool> fuse = none)
+            : node(std::move(node)), name_(std::move(name)), fuse(fuse) {}
 
         void process(GenericInputChannel input,
                 OutputChannel output,
@@ -43,16 +46,49 @@ namespace {
             return name_;
         }
 
+        bool fusible() const {
+            auto fusible_node = dynamic_cast<FusibleNode *>(node.get());
+            return fusible_node && fuse.value_or(fusible_node->lightweight());
+        }
+
+        Fused::Member release() {
+            return Fused::Member{name_, std::move(node)};
+        }
+
     private:
         std::unique_ptr<Node> node;
         const std::string name_;
+        const optional<bool> fuse;
+    };
+
+    // Counts the messages passing through a node and the time it spends on them; see Metrics.
+    class InstrumentedProcessable : public Processable {
+    public:
+        InstrumentedProcessable(std::shared_ptr<Processable> processable, Metrics::NodeMetrics &metrics)
+            : processable(std::move(processable)), metrics(metrics) {}
+
+        void process(GenericInputChannel input,
+                OutputChannel output,
+                ErrorHandler &error_handler
+        ) override {
+            Metrics::InstrumentedEnds ends(std::move(input), std::move(output), metrics);
+            processable->process(std::move(ends.input), std::move(ends.output), error_handler);
+        }
+
+        const std::string& name() override {
+            return processable->name();
+        }
+
+    private:
+        std::shared_ptr<Processable> processable;
+        Metrics::NodeMetrics &metrics;
     };
 
     std::shared_ptr<Processable> load_node(const Config::Gadget &conf, const Context &context, Loader &loader) {
         GDEBUG("Loading Gadget %s of class %s from \n",conf.name.c_str(),conf.classname.c_str(),conf.dll.c_str());
         auto factory = loader.load_factory<Loader::generic_factory<Node>>("gadget_factory_export_", conf.classname,
                                                                           conf.dll);
-        return std::make_shared<NodeProcessable>(factory(context, conf.properties), Config::name(conf));
+        return std::make_shared<NodeProcessable>(factory(context, conf.properties), Config::name(conf), conf.fuse);
     }
 
     std::shared_ptr<Processable> load_node(const Config::Parallel &conf, const Context &context, Loader &loader) {
@@ -79,16 +115,53 @@ namespace {
         GDEBUG("Loading PureDistributed block\n");
         return std::make_shared<Gadgetron::Server::Connection::Stream::PureDistributed>(conf,context,loader);
     }
+
+    // Replaces each run of two or more consecutive fusible nodes with a single Fused node.
+    std::vector<std::shared_ptr<Processable>> fuse_nodes(const std::vector<std::shared_ptr<Processable>> &nodes) {
+        std::vector<std::shared_ptr<Processable>> fused{};
+        std::vector<std::shared_ptr<NodeProcessable>> run{};
+
+        auto end_run = [&]() {
+            if (run.size() == 1) fused.push_back(run.front());
+            if (run.size() > 1) {
+                std::vector<Fused::Member> members{};
+                for (auto &node : run) members.push_back(node->release());
+                fused.push_back(std::make_shared<Fused>(std::move(members)));
+                GDEBUG("Fused nodes %s onto one thread\n", fused.back()->name().c_str());
+            }
+            run.clear();
+        };
+
+        for (auto &node : nodes) {
+            auto candidate = std::dynamic_pointer_cast<NodeProcessable>(node);
+            if (candidate && candidate->fusible()) {
+                run.push_back(candidate);
+                continue;
+            }
+            end_run();
+            fused.push_back(node);
+        }
+        end_run();
+
+        return fused;
+    }
 }
 
 namespace Gadgetron::Server::Connection::Stream {
 
-    Stream::Stream(const Config::Stream &config, const Core::Context &context, Loader &loader) : key(config.key) {
+    Core::ChannelPair make_stream_channel(const boost::optional<Config::Backpressure> &backpressure) {
+        if (!backpressure) return make_channel<MessageChannel>();
+        return make_channel<BoundedMessageChannel>(backpressure->high_watermark, backpressure->low_watermark);
+    }
+
+    Stream::Stream(const Config::Stream &config, const Core::Context &context, Loader &loader)
+        : key(config.key), backpressure(config.backpressure) {
         for (auto &node_config : config.nodes) {
             nodes.emplace_back(
                     Core::visit([&](auto n) { return load_node(n, context, loader); }, node_config)
             );
         }
+        if (config.fuse) nodes = fuse_nodes(nodes);
     }
 
     void Stream::process(GenericInputChannel input,
@@ -102,7 +175,7 @@ namespace Gadgetron::Server::Connection::Stream {
         std::vector<OutputChannel> output_channels{};
 
         for (auto i = 0; i < nodes.size()-1; i++) {
-            auto channel = make_channel<MessageChannel>();
+            auto channel = make_stream_channel(backpressure);
             input_channels.emplace_back(std::move(channel.input));
             output_channels.emplace_back(std::move(channel.output));
         }
@@ -111,9 +184,14 @@ namespace Gadgetron::Server::Connection::Stream {
 
         ErrorHandler nested_handler{error_handler, key};
 
+        std::vector<std::string> names{};
+        for (auto &node : nodes) names.push_back(node->name());
+        auto metrics = Metrics::track(key, names);
+
         std::vector<std::thread> threads(nodes.size());
         for (auto i = 0; i < nodes.size(); i++) {
-            threads[i] = Processable::process_async(nodes[i],std::move(input_channels[i]),std::move(output_channels[i]),nested_handler);
+            auto node = std::make_shared<InstrumentedProcessable>(nodes[i], *metrics->nodes[i]);
+            threads[i] = Processable::process_async(node,std::move(input_channels[i]),std::move(output_channels[i]),nested_handler);
         }
 
         for (auto &thread : threads) {
@@ -16,9 +16,15 @@ namespace Gadgetron::Server::Connection {
 
 namespace Gadgetron::Server::Connection::Stream {
 
+    /**
+     * Creates the channel used between nodes of a stream; bounded if the stream configures backpressure.
+     */
+    Core::ChannelPair make_stream_channel(const boost::optional<Config::Backpressure> &backpressure);
+
     class Stream : public Processable {
     public:
         const std::string key;
+        const boost::optional<Config::Backpressure> backpressure;
         Stream(const Config::Stream &, const Core::Context &, Loader &);
 
         void process(
@@ -55,8 +55,7 @@ namespace {
         );
 
         if (first != last || !r ) {
-            GWARN_STREAM("Failed to parse worker list from discovery command: " << input);
-            return std::vector<Address>{};
+            throw std::runtime_error("Failed to parse worker list from discovery command: " + input);
         }
 
         return result;
@@ -71,19 +70,34 @@ namespace Gadgetron::Server::Connection::Stream {
         if (!worker_discovery_command) return std::vector<Address>{};
 
         std::future<std::string> output;
-        boost::process::system(
+        auto exit_code = boost::process::system(
                 worker_discovery_command,
                 boost::process::std_out > output,
                 boost::process::std_err > boost::process::null,
                 boost::asio::io_service{}
         );
 
+        if (exit_code) {
+            throw std::runtime_error("Discovery command failed with exit code " + std::to_string(exit_code));
+        }
+
         return parse_remote_workers(output.get());
     }
 
     std::vector<Address> discover_peers() {
 
-        auto workers = Stream::discover_remote_peers();
+        std::vector<Address> workers;
+        try {
+            workers = Stream::discover_remote_peers();
+        }
+        catch (const std::exception &e) {
+            GWARN_STREAM(e.what());
+        }
+
+        return with_local_fallback(std::move(workers));
+    }
+
+    std::vector<Address> with_local_fallback(std::vector<Address> workers) {
 
         if (workers.empty()) {
             GWARN_STREAM(
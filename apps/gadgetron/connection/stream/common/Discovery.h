@@ -5,8 +5,11 @@
 #include "Types.h"
 
 namespace Gadgetron::Server::Connection::Stream {
+    /// Runs GADGETRON_REMOTE_WORKER_COMMAND, if set. Throws if the command fails or its output can't be read.
     std::vector<Address> discover_remote_peers();
+    /// The remote peers, or the local worker if there are none or discovery fails.
     std::vector<Address> discover_peers();
+    std::vector<Address> with_local_fallback(std::vector<Address> workers);
 }
 
 
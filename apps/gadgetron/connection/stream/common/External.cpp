@@ -77,4 +77,13 @@ namespace Gadgetron::Server::Connection::Stream {
     std::unique_ptr<std::iostream> connect(const Address &address, std::shared_ptr<Configuration> configuration) {
         return connect(Core::visit([&](auto address) { return as_remote(address, configuration); }, address));
     }
+
+    std::unique_ptr<std::iostream> connect(
+            const Address &address,
+            std::shared_ptr<Configuration> configuration,
+            std::chrono::milliseconds timeout
+    ) {
+        auto remote = Core::visit([&](auto address) { return as_remote(address, configuration); }, address);
+        return Gadgetron::Connection::remote_stream(remote.address, remote.port, timeout);
+    }
 }
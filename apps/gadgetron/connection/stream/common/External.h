@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include "Serialization.h"
@@ -31,4 +32,9 @@ namespace Gadgetron::Server::Connection::Stream {
     std::unique_ptr<std::iostream> connect(const std::string &address, const std::string &port);
     std::unique_ptr<std::iostream> connect(const Remote &remote);
     std::unique_ptr<std::iostream> connect(const Address &address, std::shared_ptr<Configuration> configuration);
+    std::unique_ptr<std::iostream> connect(
+            const Address &address,
+            std::shared_ptr<Configuration> configuration,
+            std::chrono::milliseconds timeout
+    );
 }
\ No newline at end of file
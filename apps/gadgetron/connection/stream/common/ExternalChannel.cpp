@@ -5,6 +5,9 @@
 #include "Configuration.h"
 #include "External.h"
 
+#include "connection/SocketStreamBuf.h"
+#include "io/shared_memory.h"
+
 using namespace Gadgetron::Core;
 
 namespace Gadgetron::Server::Connection::Stream {
@@ -87,6 +90,11 @@ namespace Gadgetron::Server::Connection::Stream {
         configuration->send(*this->stream);
     }
 
+    ExternalChannel::~ExternalChannel() {
+        // Arrays in shared memory the module never got to read would otherwise stay in /dev/shm.
+        Core::IO::release_shared_memory(*stream);
+    }
+
     Core::Message ExternalChannel::pop() {
         return inbound->pop();
     }
@@ -98,4 +106,9 @@ namespace Gadgetron::Server::Connection::Stream {
     void ExternalChannel::close() {
         outbound->close();
     }
+
+    void ExternalChannel::abort() {
+        // No lock; a push blocked on the stream is holding it.
+        Gadgetron::Connection::shutdown_stream(*stream);
+    }
 }
\ No newline at end of file
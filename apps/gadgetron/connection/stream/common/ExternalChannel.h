@@ -28,9 +28,13 @@ namespace Gadgetron::Server::Connection::Stream {
                 std::shared_ptr<Configuration> configuration
         );
 
+        ~ExternalChannel();
+
         Core::Message pop();
         void push_message(Core::Message message);
         void close();
+        // Drops the connection without a goodbye; a pop or push blocked on an unresponsive peer fails.
+        void abort();
 
     private:
         std::unique_ptr<std::iostream> stream;
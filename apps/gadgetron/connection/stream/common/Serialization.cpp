@@ -1,4 +1,5 @@
-
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 
 #include "Serialization.h"
@@ -8,14 +9,125 @@
 
 using namespace Gadgetron::Core;
 
+namespace {
+
+    size_t signature_hash(const Message &message) {
+        size_t hash = message.messages().size();
+        for (auto &chunk : message.messages())
+            hash ^= std::type_index(typeid(*chunk)).hash_code() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
+    template<class Signature>
+    bool matches(const Signature &signature, const Message &message) {
+        auto &chunks = message.messages();
+        if (signature.size() != chunks.size()) return false;
+
+        for (size_t i = 0; i < chunks.size(); i++)
+            if (signature[i] != std::type_index(typeid(*chunks[i]))) return false;
+        return true;
+    }
+
+    // Writers issue a stream write for every field of a message, and every write to a socket stream is a
+    // system call. Messages are gathered here first, and handed to the stream with one write each; payloads
+    // larger than the buffer still go straight through.
+    class MessageBuffer : public std::streambuf {
+    public:
+        static constexpr size_t capacity = 64 * 1024;
+
+        MessageBuffer() : buffer(capacity) { reset(); }
+
+        template<class F>
+        void write(std::ostream &target, F &&serialize) {
+            this->target = &target;
+
+            // The buffer outlives any one peer; a failure writing to a previous one must not stick.
+            stream.clear();
+
+            // Carries stream settings, such as shared memory for arrays, over to the writers.
+            stream.copyfmt(target);
+            try {
+                serialize(stream);
+                if (sync() || !stream.good() || !target.good())
+                    throw std::runtime_error("Failed to write message to external peer");
+            } catch (...) {
+                reset();
+                stream.clear();
+                throw;
+            }
+        }
+
+    protected:
+        int sync() override {
+            target->write(pbase(), pptr() - pbase());
+            reset();
+            return target->good() ? 0 : -1;
+        }
+
+        int overflow(int ch) override {
+            if (sync()) return traits_type::eof();
+            if (ch != traits_type::eof()) sputc(traits_type::to_char_type(ch));
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char *data, std::streamsize length) override {
+            if (length > epptr() - pptr()) {
+                if (sync()) return 0;
+                if (size_t(length) >= capacity) {
+                    target->write(data, length);
+                    return target->good() ? length : 0;
+                }
+            }
+            std::memcpy(pptr(), data, length);
+            pbump(int(length));
+            return length;
+        }
+
+    private:
+        void reset() { setp(buffer.data(), buffer.data() + buffer.size()); }
+
+        std::vector<char> buffer;
+        std::ostream stream{this};
+        std::ostream *target = nullptr;
+    };
+}
+
 namespace Gadgetron::Server::Connection::Stream {
 
     Serialization::Serialization(
             Readers readers,
             Writers writers
-    ) : readers(std::move(readers)), writers(std::move(writers)) {}
+    ) : readers(std::move(readers)), writers(std::move(writers)) {
 
-    void Serialization::write(std::iostream &stream, Core::Message message) const {
+        size_t size = ERROR + 1;
+        if (!this->readers.empty()) size = std::max(size, size_t(this->readers.rbegin()->first) + 1);
+
+        handlers = std::vector<Handler>(size, Handler{Handler::Kind::illegal, nullptr});
+
+        for (auto &pair : this->readers) handlers[pair.first] = Handler{Handler::Kind::reader, pair.second.get()};
+
+        // Control messages take precedence over any reader registered for their ids.
+        for (auto id : {FILENAME, CONFIG, HEADER, TEXT, QUERY, RESPONSE})
+            handlers[id] = Handler{Handler::Kind::illegal, nullptr};
+        handlers[CLOSE] = Handler{Handler::Kind::close, nullptr};
+        handlers[ERROR] = Handler{Handler::Kind::error, nullptr};
+    }
+
+    const Serialization::Handler &Serialization::handler(uint16_t id) const {
+        static const Handler illegal{Handler::Kind::illegal, nullptr};
+        return id < handlers.size() ? handlers[id] : illegal;
+    }
+
+    Core::Writer &Serialization::writer_for(const Core::Message &message) const {
+
+        auto hash = signature_hash(message);
+
+        {
+            std::shared_lock<std::shared_mutex> lock(writer_mutex);
+            auto range = writer_cache.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it)
+                if (matches(it->second.signature, message)) return *it->second.writer;
+        }
 
         auto writer = std::find_if(
                 writers.begin(),
@@ -26,37 +138,46 @@ namespace Gadgetron::Server::Connection::Stream {
         if (writer == writers.end())
             throw std::runtime_error("Could not find appropriate writer for message.");
 
-        (*writer)->write(stream, std::move(message));
+        WriterEntry entry{{}, writer->get()};
+        for (auto &chunk : message.messages()) entry.signature.emplace_back(typeid(*chunk));
+
+        std::unique_lock<std::shared_mutex> lock(writer_mutex);
+        writer_cache.emplace(hash, std::move(entry));
+
+        return **writer;
+    }
+
+    void Serialization::write(std::iostream &stream, Core::Message message) const {
+        thread_local MessageBuffer buffer;
+
+        auto &writer = writer_for(message);
+        buffer.write(stream, [&](std::ostream &out) { writer.write(out, std::move(message)); });
     }
 
     Core::Message Serialization::read(
             std::iostream &stream,
-            std::function<void()> on_close,
-            std::function<void(std::string message)> on_error
+            const std::function<void()> &on_close,
+            const std::function<void(std::string message)> &on_error
     ) const {
 
-        auto id = IO::read<uint16_t>(stream);
-        auto illegal_message = [&](auto &) {
-            throw std::runtime_error("Received illegal message id from external peer: " + std::to_string(id));
-        };
-        //TODO: Let's not construct a brand new map for every message, eh?
-
-        const std::map<uint16_t, std::function<void(std::iostream &)>> handlers{
-                {FILENAME,  illegal_message},
-                {CONFIG,    illegal_message},
-                {HEADER,    illegal_message},
-                {CLOSE,     [&](auto &) { on_close(); }},
-                {TEXT,      illegal_message},
-                {QUERY,     illegal_message},
-                {RESPONSE,  illegal_message},
-                {ERROR,     [&](auto &stream) { on_error(IO::read_string_from_stream<uint64_t>(stream)); }}
-        };
-
-        for (; handlers.count(id); id = IO::read<uint16_t>(stream)) handlers.at(id)(stream);
-        return readers.at(id)->read(stream);
+        for (auto id = IO::read<uint16_t>(stream);; id = IO::read<uint16_t>(stream)) {
+            auto &h = handler(id);
+            switch (h.kind) {
+                case Handler::Kind::reader:
+                    return h.reader->read(stream);
+                case Handler::Kind::close:
+                    on_close();
+                    break;
+                case Handler::Kind::error:
+                    on_error(IO::read_string_from_stream<uint64_t>(stream));
+                    break;
+                case Handler::Kind::illegal:
+                    throw std::runtime_error("Received illegal message id from external peer: " + std::to_string(id));
+            }
+        }
     }
 
     void Serialization::close(std::iostream &stream) const {
         IO::write(stream, CLOSE);
     }
-}
\ No newline at end of file
+}
@@ -3,6 +3,9 @@
 #include <map>
 #include <memory>
 #include <functional>
+#include <shared_mutex>
+#include <typeindex>
+#include <unordered_map>
 
 #include "Reader.h"
 #include "Writer.h"
@@ -19,11 +22,31 @@ namespace Gadgetron::Server::Connection::Stream {
         void write(std::iostream &stream, Core::Message message) const;
         Core::Message read(
                 std::iostream &stream,
-                std::function<void()> on_close,
-                std::function<void(std::string message)> on_error
+                const std::function<void()> &on_close,
+                const std::function<void(std::string message)> &on_error
         ) const;
     private:
         const Readers readers;
         const Writers writers;
+
+        // Everything a message id can mean to us, indexed by id. Built once, when the readers are known.
+        struct Handler {
+            enum class Kind : uint8_t { illegal, close, error, reader } kind;
+            Core::Reader *reader;
+        };
+        std::vector<Handler> handlers;
+
+        const Handler &handler(uint16_t id) const;
+
+        // Writers are chosen by the types of the chunks of a message, which are only known once messages
+        // arrive. The writer for every combination of chunk types seen so far is remembered here.
+        struct WriterEntry {
+            std::vector<std::type_index> signature;
+            Core::Writer *writer;
+        };
+        mutable std::shared_mutex writer_mutex;
+        mutable std::unordered_multimap<size_t, WriterEntry> writer_cache;
+
+        Core::Writer &writer_for(const Core::Message &message) const;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,151 @@
+#include "PeerPool.h"
+
+#include <algorithm>
+
+#include "connection/stream/common/Discovery.h"
+
+#include "log.h"
+
+namespace {
+    using namespace Gadgetron::Server::Connection::Stream;
+
+    std::string key(const Address &address) {
+        return Gadgetron::Core::visit([](auto &address) { return to_string(address); }, address);
+    }
+}
+
+namespace Gadgetron::Server::Connection::Stream {
+
+    struct PeerPool::Peer {
+        Address address;
+        size_t channels = 0;
+        size_t failures = 0;
+        std::chrono::steady_clock::time_point evicted_until;
+    };
+
+    PeerPool::Lease::Lease(PeerPool &pool, std::shared_ptr<Peer> peer) : pool(&pool), peer(std::move(peer)) {}
+
+    PeerPool::Lease::Lease(Lease &&other) noexcept : pool(other.pool), peer(std::move(other.peer)) {}
+
+    PeerPool::Lease::~Lease() {
+        if (!peer) return;
+        std::lock_guard<std::mutex> guard(pool->mutex);
+        peer->channels--;
+    }
+
+    const Address &PeerPool::Lease::address() const {
+        return peer->address;
+    }
+
+    void PeerPool::Lease::succeeded() {
+        std::lock_guard<std::mutex> guard(pool->mutex);
+        peer->failures = 0;
+    }
+
+    void PeerPool::Lease::failed() {
+        std::lock_guard<std::mutex> guard(pool->mutex);
+
+        auto eviction = std::min<std::chrono::seconds>(
+                std::chrono::seconds(1ll << std::min<size_t>(peer->failures, 6)),
+                max_eviction
+        );
+
+        peer->failures++;
+        peer->evicted_until = std::chrono::steady_clock::now() + eviction;
+
+        GWARN_STREAM("Evicting peer " << key(peer->address) << " for " << eviction.count() << " seconds.");
+    }
+
+    PeerPool &PeerPool::instance() {
+        static PeerPool pool;
+        return pool;
+    }
+
+    PeerPool::Lease PeerPool::acquire() {
+        refresh_if_due();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        if (peers.empty()) throw std::runtime_error("No peers available for distributed processing");
+
+        auto now = std::chrono::steady_clock::now();
+
+        auto preferred = [&](auto &a, auto &b) {
+            bool a_healthy = a->evicted_until <= now, b_healthy = b->evicted_until <= now;
+            if (a_healthy != b_healthy) return a_healthy;
+            return a_healthy ? a->channels < b->channels : a->evicted_until < b->evicted_until;
+        };
+
+        auto peer = *std::min_element(peers.begin(), peers.end(), preferred);
+        peer->channels++;
+        return Lease(*this, peer);
+    }
+
+    size_t PeerPool::size() {
+        refresh_if_due();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        return peers.size();
+    }
+
+    void PeerPool::refresh_if_due() {
+        std::unique_lock<std::mutex> discovery(discovery_mutex, std::defer_lock);
+
+        auto due = [&]() {
+            return !discovered || std::chrono::steady_clock::now() - last_discovery > rediscovery_interval;
+        };
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (!due()) return;
+            // With peers known, a channel does not wait for another thread's rediscovery.
+            if (discovered && !discovery.try_lock()) return;
+        }
+
+        if (!discovery.owns_lock()) discovery.lock();
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (!due()) return;
+        }
+
+        refresh();
+    }
+
+    void PeerPool::refresh() {
+
+        // The discovery command may take a while; it runs without holding the pool's mutex.
+        std::vector<Address> addresses;
+        bool failed = false;
+        try {
+            addresses = discover_remote_peers();
+        }
+        catch (const std::exception &e) {
+            GWARN_STREAM("Peer discovery failed: " << e.what());
+            failed = true;
+        }
+
+        std::lock_guard<std::mutex> guard(mutex);
+        last_discovery = std::chrono::steady_clock::now();
+
+        if (failed && !peers.empty()) {
+            GWARN_STREAM("Keeping the " << peers.size() << " peers discovered before.");
+            return;
+        }
+
+        std::vector<std::shared_ptr<Peer>> refreshed;
+        for (auto &address : with_local_fallback(std::move(addresses))) {
+            auto existing = std::find_if(peers.begin(), peers.end(), [&](auto &peer) {
+                return key(peer->address) == key(address);
+            });
+
+            if (existing != peers.end()) {
+                refreshed.push_back(*existing);
+            } else {
+                refreshed.push_back(std::make_shared<Peer>(Peer{ address }));
+            }
+        }
+
+        // Peers dropped by discovery stay alive for as long as their outstanding leases.
+        peers = std::move(refreshed);
+        discovered = true;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "connection/stream/common/External.h"
+
+namespace Gadgetron::Server::Connection::Stream {
+
+    /**
+     * Process wide registry of the peers available for distributed processing.
+     *
+     * Peers are discovered once and rediscovered periodically, rather than for every distributed stream. The
+     * registry tracks how many channels each peer is serving, and how its recent connections have fared.
+     * Peers that fail are evicted for a while, with the eviction growing for repeated failures; the first
+     * channel assigned to a peer after its eviction expires serves as its health check.
+     *
+     * Discovery runs without holding up channels; once peers are known, channels carry on with them while
+     * one thread rediscovers. If rediscovery fails, the peers found before are kept.
+     */
+    class PeerPool {
+    public:
+        static constexpr std::chrono::seconds rediscovery_interval{ 60 };
+        static constexpr std::chrono::seconds max_eviction{ 60 };
+
+        struct Peer;
+
+        /// A channel's claim on a peer. The peer counts the channel as active for as long as the lease lives.
+        class Lease {
+        public:
+            Lease(PeerPool &pool, std::shared_ptr<Peer> peer);
+            ~Lease();
+
+            Lease(Lease &&) noexcept;
+            Lease(const Lease &) = delete;
+            Lease &operator=(const Lease &) = delete;
+            Lease &operator=(Lease &&) = delete;
+
+            const Address &address() const;
+
+            void succeeded();
+            void failed();
+
+        private:
+            PeerPool *pool;
+            std::shared_ptr<Peer> peer;
+        };
+
+        static PeerPool &instance();
+
+        /// Leases the healthy peer serving the fewest channels. If every peer is evicted, the one due back first.
+        /// Throws if there are no peers at all.
+        Lease acquire();
+
+        size_t size();
+
+    private:
+        void refresh_if_due();
+        void refresh(); // Called holding discovery_mutex
+
+        std::mutex mutex;
+        std::mutex discovery_mutex;
+        std::vector<std::shared_ptr<Peer>> peers;
+        std::chrono::steady_clock::time_point last_discovery;
+        bool discovered = false;
+    };
+}
@@ -1,6 +1,7 @@
-
 #include "Pool.h"
 
+#include <cmath>
+
 #include "connection/stream/common/Discovery.h"
 
 #include "log.h"
@@ -11,52 +12,216 @@ using namespace Gadgetron::Server::Connection::Stream;
 
 namespace {
 
-    bool compare_load(const std::unique_ptr<Worker> &a, const std::unique_ptr<Worker> &b) {
-        return a->current_load() < b->current_load();
-    }
+    constexpr size_t attempts_per_job = 3;
 
-    std::unique_ptr<Worker> &select_best_worker(std::list<std::unique_ptr<Worker>> &workers) {
-        return *std::min_element(workers.begin(), workers.end(), compare_load);
+    std::vector<std::unique_ptr<Worker>> to_vector(std::list<std::unique_ptr<Worker>> workers) {
+        return std::vector<std::unique_ptr<Worker>>(
+                std::make_move_iterator(workers.begin()),
+                std::make_move_iterator(workers.end())
+        );
     }
 
-    Message send_to_best_worker(
-            Message message,
-            std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers,
-            size_t retries
-    ) {
-
-        if (!retries) throw std::runtime_error("Multiple workers failed processing job; aborting.");
-
-        auto &worker = select_best_worker(*workers);
-
+    std::string describe(const std::exception_ptr &error) {
         try {
-            auto response = worker->push(message.clone());
-            GDEBUG_STREAM("Pushed message; waiting for response from worker " << worker->address);
-            auto response_message = response.get();
-            GDEBUG_STREAM("Response gotten from worker " << worker->address);
-            return std::move(response_message);
+            std::rethrow_exception(error);
         }
         catch (const std::exception &e) {
-            GWARN_STREAM("Worker " << worker->address << " failed processing job. The job will be retried. [" << e.what() << "]");
-            return send_to_best_worker(std::move(message), std::move(workers), retries - 1);
+            return e.what();
+        }
+        catch (...) {
+            return "Unknown error";
         }
     }
 }
 
 namespace Gadgetron::Server::Connection::Stream {
 
+    std::chrono::seconds distributed_inactivity_timeout(const Core::Context::Args &args) {
+        if (!args.count("distributed_inactivity_timeout"))
+            return std::chrono::seconds(default_distributed_inactivity_timeout);
+        return std::chrono::seconds(args["distributed_inactivity_timeout"].as<unsigned int>());
+    }
+
+    struct Pool::Job {
+        Message message;
+        std::promise<Message> response;
+        size_t attempts_left;
+    };
+
     Pool::Pool(
-            std::list<std::unique_ptr<Worker>> workers
-    ) : workers(std::make_shared<std::list<std::unique_ptr<Worker>>>(std::move(workers))) {}
+            std::list<std::unique_ptr<Worker>> workers,
+            size_t max_jobs_per_worker,
+            std::chrono::seconds inactivity_timeout
+    ) : max_jobs_per_worker(std::max<size_t>(1, max_jobs_per_worker)),
+        inactivity_timeout(inactivity_timeout),
+        workers(to_vector(std::move(workers))),
+        jobs_in_flight(this->workers.size(), 0),
+        random(std::random_device()()) {
+
+        auto number_of_dispatchers = std::max<size_t>(1, std::min(this->workers.size(), max_dispatchers));
+        for (size_t i = 0; i < number_of_dispatchers; i++) {
+            dispatchers.emplace_back([this]() { dispatch_jobs(); });
+        }
+    }
+
+    Pool::~Pool() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wait_for_outstanding_jobs(lock);
+        }
+
+        pending.close();
+        for (auto &dispatcher : dispatchers) dispatcher.join();
+    }
+
+    void Pool::wait_for_outstanding_jobs(std::unique_lock<std::mutex> &lock) {
+        auto done = [&]() { return outstanding_jobs == 0; };
+
+        if (inactivity_timeout == std::chrono::seconds::zero()) {
+            idle.wait(lock, done);
+            return;
+        }
+
+        // Every reply moves the deadline; jobs may take as long as they need, as long as the workers keep replying.
+        while (!done()) {
+            if (std::chrono::steady_clock::now() < last_activity + inactivity_timeout) {
+                idle.wait_until(lock, last_activity + inactivity_timeout);
+                continue;
+            }
+
+            GWARN_STREAM("No reply from any worker in " << inactivity_timeout.count() << " seconds; aborting workers.");
+
+            // Aborted workers fail their jobs, which are then failed outright as no workers remain.
+            lock.unlock();
+            for (auto &worker : workers) worker->abort();
+            lock.lock();
+
+            idle.wait(lock, done);
+        }
+    }
 
     std::future<Message> Pool::push(Message message) {
-        return std::async(
-                std::launch::async,
-                send_to_best_worker,
-                std::move(message),
-                workers,
-                3
-        );
+        auto job = std::make_shared<Job>(Job{ std::move(message), std::promise<Message>(), attempts_per_job });
+        auto future = job->response.get_future();
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            outstanding_jobs++;
+            last_activity = std::chrono::steady_clock::now();
+        }
+
+        pending.push(std::move(job));
+        return future;
     }
-}
 
+    void Pool::dispatch_jobs() {
+        try {
+            while (true) dispatch(pending.pop());
+        }
+        catch (const ChannelClosed &) {}
+    }
+
+    void Pool::dispatch(std::shared_ptr<Job> job) {
+        size_t index;
+        Worker *worker;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            worker = select_worker(lock, index);
+            if (worker) jobs_in_flight[index]++;
+        }
+
+        if (!worker) {
+            job->response.set_exception(std::make_exception_ptr(
+                    std::runtime_error("No workers available to process job; aborting.")
+            ));
+            std::lock_guard<std::mutex> guard(mutex);
+            if (!--outstanding_jobs) idle.notify_all();
+            return;
+        }
+
+        try {
+            worker->push(
+                    job->message.clone(),
+                    [=](Message response) {
+                        GDEBUG_STREAM("Response gotten from worker " << worker->address);
+                        job->response.set_value(std::move(response));
+                        complete(index);
+                    },
+                    [=](std::exception_ptr error) { retry(job, index, error); }
+            );
+            GDEBUG_STREAM("Pushed message to worker " << worker->address);
+        }
+        catch (...) {
+            retry(job, index, std::current_exception());
+        }
+    }
+
+    void Pool::retry(std::shared_ptr<Job> job, size_t index, std::exception_ptr error) {
+        GWARN_STREAM("Worker " << workers[index]->address << " failed processing job. [" << describe(error) << "]");
+
+        if (!--job->attempts_left) {
+            job->response.set_exception(std::make_exception_ptr(
+                    std::runtime_error("Multiple workers failed processing job; aborting.")
+            ));
+            complete(index);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            jobs_in_flight[index]--;
+            last_activity = std::chrono::steady_clock::now();
+        }
+        capacity_available.notify_one();
+
+        // The job is still outstanding, so the pending channel cannot have been closed yet.
+        pending.push(std::move(job));
+    }
+
+    void Pool::complete(size_t index) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            jobs_in_flight[index]--;
+            last_activity = std::chrono::steady_clock::now();
+            if (!--outstanding_jobs) idle.notify_all();
+        }
+        capacity_available.notify_one();
+    }
+
+    Worker *Pool::select_worker(std::unique_lock<std::mutex> &lock, size_t &index) {
+
+        std::vector<double> loads(workers.size());
+        std::vector<size_t> candidates;
+
+        while (true) {
+            // Workers may be busy sending; their loads are read without holding up the other dispatchers.
+            lock.unlock();
+            std::transform(workers.begin(), workers.end(), loads.begin(),
+                    [](auto &worker) { return worker->current_load(); });
+            lock.lock();
+
+            candidates.clear();
+            bool any_open = false;
+            for (size_t i = 0; i < workers.size(); i++) {
+                if (std::isinf(loads[i])) continue;
+                any_open = true;
+                if (jobs_in_flight[i] < max_jobs_per_worker) candidates.push_back(i);
+            }
+
+            if (!any_open) return nullptr;
+            if (!candidates.empty()) break;
+
+            // Loads are read outside the lock, so workers closing in the meantime are only noticed on a later pass.
+            capacity_available.wait_for(lock, std::chrono::milliseconds(100));
+        }
+
+        // Comparing two random candidates, rather than all of them, keeps dispatchers acting on slightly
+        // stale loads from herding onto the same worker.
+        std::uniform_int_distribution<size_t> pick(0, candidates.size() - 1);
+        auto a = candidates[pick(random)], b = candidates[pick(random)];
+        while (candidates.size() > 1 && a == b) b = candidates[pick(random)];
+
+        index = loads[a] <= loads[b] ? a : b;
+        return workers[index].get();
+    }
+}
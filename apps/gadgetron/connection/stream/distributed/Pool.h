@@ -3,24 +3,79 @@
 #include <mutex>
 #include <vector>
 #include <memory>
+#include <chrono>
 #include <future>
-#include <algorithm>
+#include <random>
+#include <thread>
+#include <condition_variable>
 
 #include "connection/stream/common/External.h"
 
+#include "Context.h"
+
 #include "Worker.h"
 
 #include "Message.h"
+#include "MPMCChannel.h"
 
 
 namespace Gadgetron::Server::Connection::Stream {
 
+    /// Seconds a closing pool waits for its workers without a reply or a new job before aborting them; with 0,
+    /// it waits for as long as the jobs take.
+    constexpr unsigned int default_distributed_inactivity_timeout = 0;
+
+    std::chrono::seconds distributed_inactivity_timeout(const Core::Context::Args &args);
+
+    /**
+     * Distributes jobs over a set of remote workers.
+     *
+     * A fixed set of dispatcher threads sends jobs to workers; responses are delivered by the workers' own
+     * inbound threads, so no thread waits on an individual job. Each job goes to the better of two randomly
+     * chosen workers, judged by their estimated completion time, and no worker is given more than
+     * max_jobs_per_worker jobs at a time. Jobs wait in the pool until a worker has capacity for them.
+     *
+     * Destroying the pool waits for outstanding jobs. With an inactivity timeout, workers are aborted, failing
+     * their jobs, once that long has passed without a reply from any of them or a job pushed to the pool.
+     */
     class Pool {
     public:
-        explicit Pool(std::list<std::unique_ptr<Worker>> workers);
+        static constexpr size_t default_max_jobs_per_worker = 4;
+        static constexpr size_t max_dispatchers = 8;
+
+        explicit Pool(
+                std::list<std::unique_ptr<Worker>> workers,
+                size_t max_jobs_per_worker = default_max_jobs_per_worker,
+                std::chrono::seconds inactivity_timeout = std::chrono::seconds(default_distributed_inactivity_timeout)
+        );
+        ~Pool();
+
         std::future<Core::Message> push(Core::Message message);
 
     private:
-        std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers;
+        struct Job;
+
+        void dispatch_jobs();
+        void dispatch(std::shared_ptr<Job> job);
+        void retry(std::shared_ptr<Job> job, size_t worker, std::exception_ptr error);
+        void complete(size_t worker);
+        void wait_for_outstanding_jobs(std::unique_lock<std::mutex> &lock);
+
+        Worker *select_worker(std::unique_lock<std::mutex> &lock, size_t &index);
+
+        const size_t max_jobs_per_worker;
+        const std::chrono::seconds inactivity_timeout;
+        const std::vector<std::unique_ptr<Worker>> workers;
+
+        std::mutex mutex;
+        std::condition_variable capacity_available;
+        std::condition_variable idle;
+        std::vector<size_t> jobs_in_flight;
+        size_t outstanding_jobs = 0;
+        std::chrono::steady_clock::time_point last_activity = std::chrono::steady_clock::now();
+        std::minstd_rand random;
+
+        Core::MPMCChannel<std::shared_ptr<Job>> pending;
+        std::vector<std::thread> dispatchers;
     };
-}
\ No newline at end of file
+}
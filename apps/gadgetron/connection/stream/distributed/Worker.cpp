@@ -1,8 +1,9 @@
 
 #include "Worker.h"
 
+#include <algorithm>
 #include <chrono>
-#include <future>
+#include <limits>
 
 #include "connection/stream/common/External.h"
 #include "connection/stream/common/ExternalChannel.h"
@@ -13,19 +14,29 @@ using namespace Gadgetron::Server::Connection::Stream;
 
 namespace {
 
-    template<class T>
-    std::chrono::milliseconds time_since(std::chrono::time_point<T> instance) {
-        return std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - instance
-        );
+    // Weight of the most recent observation in the running averages of latency and service time.
+    constexpr double smoothing = 0.2;
+
+    double milliseconds_between(
+            std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end
+    ) {
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+
+    double smoothed(double average, double observation) {
+        return average == 0.0 ? observation : (1.0 - smoothing) * average + smoothing * observation;
     }
 }
 
 namespace Gadgetron::Server::Connection::Stream {
 
     struct Worker::Job {
-        std::chrono::time_point<std::chrono::steady_clock> start;
-        std::promise<Core::Message> response;
+        uint64_t id;
+        std::chrono::steady_clock::time_point start;
+        size_t jobs_ahead;
+        ResponseCallback on_response;
+        FailureCallback on_failure;
     };
 
     struct Module {
@@ -37,44 +48,44 @@ namespace Gadgetron::Server::Connection::Stream {
     struct Worker::PushModule : public Module {
         using Module::Module;
 
-        virtual std::future<Message> push(Message message) {
+        virtual uint64_t record(ResponseCallback on_response, FailureCallback on_failure) {
             GDEBUG_STREAM("Pushing message to remote worker " << worker.address);
 
             Job job {
+                    worker.next_job_id++,
                     std::chrono::steady_clock::now(),
-                    std::promise<Message>()
+                    worker.jobs.size(),
+                    std::move(on_response),
+                    std::move(on_failure)
             };
 
-            auto future = job.response.get_future();
-            worker.channel->push_message(std::move(message));
             worker.jobs.push_back(std::move(job));
-            return future;
+            return worker.jobs.back().id;
         };
     };
 
     struct Worker::LoadModule : public Module {
         using Module::Module;
 
-        virtual long long current_load() {
-            auto current_job_duration_estimate = std::max(
-                    worker.timing.latest.count(),
-                    time_since(worker.jobs.front().start).count()
-            );
-
-            return current_job_duration_estimate * worker.jobs.size();
+        // A new job waits for the jobs already queued on the worker, each taking about one service time
+        // (the inverse of the throughput), and then completes after about one round trip.
+        virtual double current_load() {
+            auto &timing = worker.timing;
+            auto latency = timing.latency == 0.0 ? timing.service_time : timing.latency;
+            return latency + timing.service_time * worker.jobs.size();
         };
     };
 
     struct Worker::ClosedPushModule : public Worker::PushModule {
         using Worker::PushModule::PushModule;
-        std::future<Message> push(Message message) override {
+        uint64_t record(ResponseCallback, FailureCallback) override {
             throw std::runtime_error("Cannot push message to closed/failed worker.");
         }
     };
 
     struct Worker::ClosedLoadModule : public Worker::LoadModule {
         using Worker::LoadModule::LoadModule;
-        long long current_load() override { return std::numeric_limits<long long>::max(); }
+        double current_load() override { return std::numeric_limits<double>::infinity(); }
     };
 }
 
@@ -82,7 +93,11 @@ namespace Gadgetron::Server::Connection::Stream {
 namespace Gadgetron::Server::Connection::Stream {
 
     Worker::~Worker() {
-        channel->close();
+        try {
+            channel->close();
+        } catch (...) {
+            // The connection is gone already; the inbound thread has noticed, or will.
+        }
         inbound_thread.join();
     }
 
@@ -105,48 +120,108 @@ namespace Gadgetron::Server::Connection::Stream {
         inbound_thread = std::thread([=]() { handle_inbound_messages(); });
     }
 
-    long long Worker::current_load() const {
+    double Worker::current_load() const {
         std::lock_guard<std::mutex> guard(mutex);
         return load_module->current_load();
     }
 
-    std::future<Message> Worker::push(Message message) {
+    Worker::Statistics Worker::statistics() const {
         std::lock_guard<std::mutex> guard(mutex);
-        return push_module->push(std::move(message));
+        return Statistics {
+                jobs.size(),
+                timing.latency,
+                timing.service_time == 0.0 ? 0.0 : 1000.0 / timing.service_time
+        };
     }
 
-    void Worker::close() {
+    void Worker::push(Message message, ResponseCallback on_response, FailureCallback on_failure) {
+        std::lock_guard<std::mutex> sending(send_mutex);
+
+        uint64_t job_id;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            job_id = push_module->record(std::move(on_response), std::move(on_failure));
+        }
+
+        try {
+            channel->push_message(std::move(message));
+        }
+        catch (...) {
+            // Unless the inbound thread has failed the job already, and so taken over reporting it, the job was
+            // never sent; it is withdrawn and the push fails.
+            if (withdraw(job_id)) throw;
+        }
+    }
+
+    bool Worker::withdraw(uint64_t job_id) {
         std::lock_guard<std::mutex> guard(mutex);
+        auto job = std::find_if(jobs.begin(), jobs.end(), [&](const Job &job) { return job.id == job_id; });
+        if (job == jobs.end()) return false;
+        jobs.erase(job);
+        return true;
+    }
+
+    void Worker::close() {
+        std::lock_guard<std::mutex> sending(send_mutex);
         channel->close();
     }
 
+    void Worker::abort() {
+        GWARN_STREAM("Aborting connection to worker " << address);
+        channel->abort();
+    }
+
     void Worker::handle_inbound_messages() {
+        std::exception_ptr error;
         try {
             while(true) process_inbound_message(channel->pop());
         }
-        catch (const ChannelClosed &) {}
+        catch (const ChannelClosed &) {
+            error = std::make_exception_ptr(std::runtime_error("Connection to worker closed with jobs outstanding."));
+        }
         catch (const std::exception &e) {
             GWARN_STREAM("Worker " << address << " failed: " << e.what());
-            fail_pending_messages(std::current_exception());
+            error = std::current_exception();
         }
+
+        // No new jobs are accepted once closed, so every job pending at this point is failed.
         switch_to_closed_modules();
+        fail_pending_messages(error);
     }
 
     void Worker::process_inbound_message(Core::Message message) {
         GDEBUG_STREAM("Received message from remote worker " << address);
 
-        std::lock_guard<std::mutex> guard(mutex);
+        std::unique_lock<std::mutex> lock(mutex);
 
         auto job = std::move(jobs.front()); jobs.pop_front();
-        timing.latest = time_since(job.start);
-        job.response.set_value(std::move(message));
+        update_timing(job, std::chrono::steady_clock::now());
+
+        // Callbacks are invoked without holding the lock; they are free to push more work to this worker.
+        lock.unlock();
+        job.on_response(std::move(message));
+    }
+
+    void Worker::update_timing(const Job &job, std::chrono::steady_clock::time_point now) {
+        // Time spent on this job alone; any time before the previous job completed was spent waiting for it.
+        auto started = job.jobs_ahead ? std::max(job.start, timing.latest_completion) : job.start;
+        timing.service_time = smoothed(timing.service_time, milliseconds_between(started, now));
+
+        // Only jobs with nothing ahead of them tell us about the round trip; the rest include queueing.
+        if (!job.jobs_ahead) timing.latency = smoothed(timing.latency, milliseconds_between(job.start, now));
+
+        timing.latest_completion = now;
     }
 
     void Worker::fail_pending_messages(const std::exception_ptr &e) {
-        std::lock_guard<std::mutex> guard(mutex);
+        std::list<Job> failed;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            std::swap(failed, jobs);
+        }
 
-        for (auto &job : jobs) {
-            job.response.set_exception(e);
+        for (auto &job : failed) {
+            job.on_failure(e);
         }
     }
 
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
-#include <future>
+#include <functional>
+#include <list>
 
 #include "connection/Core.h"
 #include "connection/stream/common/Serialization.h"
@@ -26,21 +28,45 @@ namespace Gadgetron::Server::Connection::Stream {
                 std::shared_ptr<Configuration> configuration
         );
 
-        std::future<Core::Message> push(Core::Message message);
-        long long current_load() const;
+        struct Statistics {
+            size_t jobs;
+            double latency;     // Exponentially weighted average round trip of a job, in milliseconds.
+            double throughput;  // Exponentially weighted average of completed jobs per second.
+        };
+
+        using ResponseCallback = std::function<void(Core::Message)>;
+        using FailureCallback = std::function<void(std::exception_ptr)>;
+
+        /**
+         * Sends a job to the worker. Exactly one of the callbacks is invoked, from the thread handling
+         * responses from the worker, once the job completes or the worker fails.
+         */
+        void push(Core::Message message, ResponseCallback on_response, FailureCallback on_failure);
+
+        /// Estimated time in milliseconds until a job pushed now is complete. Infinite for closed workers.
+        double current_load() const;
+        Statistics statistics() const;
         void close();
+        /// Drops the connection to an unresponsive worker; its outstanding jobs fail.
+        void abort();
 
     private:
         mutable std::mutex mutex;
+        // Held across recording a job and sending its message, so jobs are recorded in the order they are sent.
+        // Sending happens outside of the mutex above, leaving the load and statistics available meanwhile.
+        std::mutex send_mutex;
 
         std::thread inbound_thread;
 
         struct Timing {
-            std::chrono::milliseconds latest = std::chrono::seconds(5);
+            std::chrono::steady_clock::time_point latest_completion;
+            double latency = 0.0;
+            double service_time = 0.0;
         } timing;
 
         struct Job;
         std::list<Job> jobs;
+        uint64_t next_job_id = 0;
         std::unique_ptr<ExternalChannel> channel;
 
         struct PushModule; struct LoadModule; struct ClosedPushModule; struct ClosedLoadModule;
@@ -50,6 +76,8 @@ namespace Gadgetron::Server::Connection::Stream {
 
         void handle_inbound_messages();
         void process_inbound_message(Core::Message message);
+        bool withdraw(uint64_t job_id);
+        void update_timing(const Job &job, std::chrono::steady_clock::time_point now);
         void fail_pending_messages(const std::exception_ptr &e);
     };
 }
@@ -22,10 +22,16 @@ namespace Gadgetron::Server::Connection::Stream {
 
         if(execute.target) args.push_back(execute.target.get());
 
+        boost::process::environment environment = boost::this_process::environment();
+        environment["PYTHONPATH"] += {python_path};
+
+        // Tells the module that arrays may arrive in shared memory segments; see io/shared_memory.h.
+        if (execute.shared_memory) environment["GADGETRON_SHARED_MEMORY"] = "1";
+
         boost::process::child module(
                 boost::process::search_path("python3"),
                 boost::process::args=args,
-                boost::process::env["PYTHONPATH"]+={python_path}
+                environment
         );
 
         module.detach();
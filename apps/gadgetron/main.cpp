@@ -10,6 +10,10 @@
 #include "system_info.h"
 
 #include "Server.h"
+#include "connection/InputPipeline.h"
+#include "connection/OutputPipeline.h"
+#include "connection/stream/distributed/Pool.h"
+#include "connection/SocketStreamBuf.h"
 
 using namespace boost::filesystem;
 using namespace boost::program_options;
@@ -29,11 +33,50 @@ int main(int argc, char *argv[]) {
              "Set the Gadgetron home directory.")
             ("port,p",
              value<unsigned short>()->default_value(9002),
-             "Listen for incoming connections on this port.");
+             "Listen for incoming connections on this port.")
+            ("socket_buffer_size",
+             value<size_t>()->default_value(Gadgetron::Connection::default_socket_buffer_size)->notifier(
+                     [](size_t size) {
+                         if (size < Gadgetron::Connection::minimum_socket_buffer_size)
+                             throw validation_error(validation_error::invalid_option_value, "socket_buffer_size",
+                                                    std::to_string(size));
+                     }),
+             "Size in bytes of the connection socket buffers, at least 4096. Larger reads go directly to their "
+             "destination.")
+            ("max_output_bytes_in_flight",
+             value<size_t>()->default_value(Gadgetron::Server::Connection::default_max_output_bytes_in_flight),
+             "Serialized output in bytes a connection may hold back while waiting for the socket.")
+            ("input_decode_workers",
+             value<unsigned int>()->default_value(Gadgetron::Server::Connection::default_input_decode_workers),
+             "Decompress incoming acquisitions on this many worker threads per connection, while the input thread "
+             "reads on. With 0, acquisitions are decompressed on the input thread.")
+            ("distributed_inactivity_timeout",
+             value<unsigned int>()->default_value(
+                     Gadgetron::Server::Connection::Stream::default_distributed_inactivity_timeout),
+             "Once its input has ended, a distributed stream aborts its workers if none of them has replied for this "
+             "many seconds. With 0, it waits for as long as the jobs take.")
+            ("metrics_file",
+             value<std::string>(),
+             "Periodically write per-node metrics of the running streams to this file; as JSON if the name ends in "
+             ".json, in the Prometheus text format otherwise. {pid} in the name is replaced by the process id, which "
+             "keeps connections handled in processes of their own apart.")
+            ("metrics_interval",
+             value<unsigned int>()->default_value(10),
+             "Seconds between writes of the metrics file.")
+            ("connection_workers",
+             value<size_t>()->default_value(0),
+             "Handle connections on this many persistent worker threads, keeping loaded libraries and "
+             "configurations between connections. With 0, every connection gets a process of its own.");
 
     variables_map args;
-    store(parse_command_line(argc, argv, desc), args);
-    notify(args);
+    try {
+        store(parse_command_line(argc, argv, desc), args);
+        notify(args);
+    }
+    catch (error &e) {
+        GERROR_STREAM(e.what() << std::endl);
+        return 1;
+    }
 
     if (args.count("help")) {
         std::cout << desc << std::endl;
@@ -29,6 +29,25 @@ namespace Gadgetron::Core {
        channel.close();
     }
 
+    BoundedMessageChannel::BoundedMessageChannel(size_t high_watermark, size_t low_watermark)
+        : channel(high_watermark, low_watermark) {}
+
+    Message BoundedMessageChannel::pop() {
+        return channel.pop();
+    }
+
+    optional<Message> BoundedMessageChannel::try_pop() {
+        return channel.try_pop();
+    }
+
+    void BoundedMessageChannel::push_message(Message message) {
+        channel.push(std::move(message));
+    }
+
+    void BoundedMessageChannel::close() {
+        channel.close();
+    }
+
     Message GenericInputChannel::pop() {
         return channel->pop();
     }
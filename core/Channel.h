@@ -134,6 +134,26 @@ namespace Gadgetron { namespace Core {
 		MPMCChannel<Message> channel;
     };
 
+    /***
+     * A MessageChannel with bounded capacity. Pushing to a full channel blocks the producer until the
+     * consumers have drained it to the low watermark, propagating backpressure upstream.
+     */
+    class BoundedMessageChannel : public Channel {
+    public:
+        BoundedMessageChannel(size_t high_watermark, size_t low_watermark);
+
+    protected:
+        Message pop() override;
+
+        optional<Message> try_pop() override;
+
+        void close() override;
+
+        void push_message(Message) override;
+
+        BoundedMPMCChannel<Message> channel;
+    };
+
     /***
      * A wrapper around an InputChannel. Filters the content of an Inputchannel based on the specified typelist
      * @tparam ARGS
@@ -154,10 +174,17 @@ namespace Gadgetron { namespace Core {
         }
 
         optional<decltype(force_unpack<TYPELIST...>(Message{}))> try_pop() {
+            return try_pop([]() {});
+        }
+
+        /// As try_pop, calling before_bypass() ahead of passing on each message of other types. Callers holding
+        /// messages back can emit them there, so the stream keeps its order.
+        template <class F> optional<decltype(force_unpack<TYPELIST...>(Message{}))> try_pop(F&& before_bypass) {
 
             optional<Message> message = in.try_pop();
 
             while (message && !convertible_to<TYPELIST...>(*message)) {
+                before_bypass();
                 bypass.push_message(std::move(*message));
                 message = in.try_pop();
             }
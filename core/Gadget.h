@@ -161,6 +161,12 @@ namespace Gadgetron {
 
         virtual int close(unsigned long flags = 1) { return 0; }
 
+        /**
+        *  Gadgets doing little work per message may return true, letting the stream run them on the thread of a
+        *  neighbouring node (see Core::FusibleNode::lightweight).
+        */
+        virtual bool lightweight() const { return false; }
+
         void set_context(const Core::Context& context);
 
         std::string get_string_value(const char *name);
@@ -609,7 +615,7 @@ namespace Gadgetron {
     };
 
 
-    class LegacyGadgetNode : public Core::Node {
+    class LegacyGadgetNode : public Core::Node, public Core::FusibleNode {
     public:
         LegacyGadgetNode(
                 std::unique_ptr<Gadget> gadget_ptr,
@@ -620,6 +626,11 @@ namespace Gadgetron {
         void process(Core::GenericInputChannel& in,
                      Core::OutputChannel& out) override;
 
+        void start(Core::OutputChannel& out) override;
+        void process_message(Core::Message message, Core::OutputChannel& out) override;
+        void finish(Core::OutputChannel& out) override;
+        bool lightweight() const override;
+
     private:
 
         std::unique_ptr<Gadget> gadget;
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "Types.h"
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <type_traits>
 
 namespace Gadgetron::Core {
 
@@ -28,6 +33,62 @@ namespace Gadgetron::Core {
         std::condition_variable cv;
     };
 
+    /**
+     * Bounded multi-producer multi-consumer channel backed by a lock-free ring buffer.
+     *
+     * Producers block once high_watermark messages are queued, and are only released again when the
+     * consumers have drained the channel down to low_watermark. Push and pop never take a lock unless
+     * they have to wait, so the uncontended path is a single CAS on either end of the ring.
+     */
+    template <class T> class BoundedMPMCChannel {
+    public:
+        BoundedMPMCChannel(size_t high_watermark, size_t low_watermark);
+        ~BoundedMPMCChannel();
+
+        BoundedMPMCChannel(const BoundedMPMCChannel&) = delete;
+        BoundedMPMCChannel& operator=(const BoundedMPMCChannel&) = delete;
+
+        void push(T);
+
+        template <class... ARGS> void emplace(ARGS&&... args);
+
+        T pop();
+        optional<T> try_pop();
+
+        void close();
+
+        size_t size() const;
+        size_t capacity() const;
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        };
+
+        template <class... ARGS> bool try_emplace(ARGS&&... args);
+        bool try_pop_impl(optional<T>& message);
+
+        void wait_until_writable();
+        void wake_producers();
+        void wake_consumers();
+
+        const size_t high_watermark;
+        const size_t low_watermark;
+        std::unique_ptr<Cell[]> buffer;
+
+        // Producer and consumer positions live on separate cache lines to avoid false sharing.
+        alignas(64) std::atomic<size_t> enqueue_position{ 0 };
+        alignas(64) std::atomic<size_t> dequeue_position{ 0 };
+
+        alignas(64) std::atomic<bool> is_closed{ false };
+        std::atomic<size_t> waiting_producers{ 0 };
+        std::atomic<size_t> waiting_consumers{ 0 };
+        std::mutex m;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+    };
+
     class ChannelClosed : public std::runtime_error {
     public:
         ChannelClosed() : std::runtime_error("Channel was closed"){};
@@ -90,4 +151,147 @@ namespace Gadgetron::Core {
         other.is_closed = true;
     }
 
+
+    template <class T>
+    BoundedMPMCChannel<T>::BoundedMPMCChannel(size_t high_watermark, size_t low_watermark)
+        : high_watermark{ std::max<size_t>(high_watermark, 1) },
+          low_watermark{ std::min(low_watermark, std::max<size_t>(high_watermark, 1) - 1) },
+          buffer{ std::make_unique<Cell[]>(std::max<size_t>(high_watermark, 1)) } {
+        for (size_t i = 0; i < this->high_watermark; i++)
+            buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template <class T> BoundedMPMCChannel<T>::~BoundedMPMCChannel() {
+        optional<T> message;
+        while (try_pop_impl(message))
+            message = none;
+    }
+
+    template <class T>
+    template <class... ARGS>
+    bool BoundedMPMCChannel<T>::try_emplace(ARGS&&... args) {
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell        = buffer[position % high_watermark];
+            size_t sequence   = cell.sequence.load(std::memory_order_acquire);
+            auto difference   = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    new (&cell.storage) T(std::forward<ARGS>(args)...);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <class T> bool BoundedMPMCChannel<T>::try_pop_impl(optional<T>& message) {
+        size_t position = dequeue_position.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell        = buffer[position % high_watermark];
+            size_t sequence   = cell.sequence.load(std::memory_order_acquire);
+            auto difference   = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {
+                if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    T* element = reinterpret_cast<T*>(&cell.storage);
+                    message    = std::move(*element);
+                    element->~T();
+                    cell.sequence.store(position + high_watermark, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <class T> size_t BoundedMPMCChannel<T>::size() const {
+        auto dequeued = dequeue_position.load();
+        auto enqueued = enqueue_position.load();
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    template <class T> size_t BoundedMPMCChannel<T>::capacity() const {
+        return high_watermark;
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::wake_producers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_producers.load() && size() <= low_watermark) {
+            std::lock_guard<std::mutex> guard(m);
+            not_full.notify_all();
+        }
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::wake_consumers() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_consumers.load()) {
+            std::lock_guard<std::mutex> guard(m);
+            not_empty.notify_one();
+        }
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::wait_until_writable() {
+        std::unique_lock<std::mutex> lock(m);
+        waiting_producers++;
+        not_full.wait(lock, [this]() { return is_closed.load() || size() <= low_watermark; });
+        waiting_producers--;
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::push(T message) {
+        emplace(std::move(message));
+    }
+
+    template <class T> template <class... ARGS> void BoundedMPMCChannel<T>::emplace(ARGS&&... args) {
+        while (true) {
+            if (is_closed.load())
+                throw ChannelClosed();
+            if (try_emplace(std::forward<ARGS>(args)...))
+                break;
+            wait_until_writable();
+        }
+        wake_consumers();
+    }
+
+    template <class T> optional<T> BoundedMPMCChannel<T>::try_pop() {
+        optional<T> message;
+        if (try_pop_impl(message))
+            wake_producers();
+        return message;
+    }
+
+    template <class T> T BoundedMPMCChannel<T>::pop() {
+        optional<T> message;
+        while (!try_pop_impl(message)) {
+            if (is_closed.load() && size() == 0)
+                throw ChannelClosed();
+
+            std::unique_lock<std::mutex> lock(m);
+            waiting_consumers++;
+            not_empty.wait(lock, [this]() { return is_closed.load() || size() > 0; });
+            waiting_consumers--;
+            lock.unlock();
+
+            // A producer may have claimed a slot without having published it yet.
+            if (size() > 0)
+                std::this_thread::yield();
+        }
+        wake_producers();
+        return std::move(*message);
+    }
+
+    template <class T> void BoundedMPMCChannel<T>::close() {
+        {
+            std::lock_guard<std::mutex> guard(m);
+            is_closed = true;
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
 }
@@ -31,8 +31,15 @@ std::vector<std::unique_ptr<Gadgetron::Core::MessageChunk>> Gadgetron::Core::Mes
 
 Gadgetron::Core::Message Gadgetron::Core::Message::clone(){
     std::vector<std::unique_ptr<MessageChunk>> cloned_messages;
-    for (const auto& chunk : messages_)
+    for (const auto& chunk : messages_) {
+        chunk->share();
         cloned_messages.emplace_back(chunk->clone());
+    }
 
     return Message(std::move(cloned_messages));
-}
\ No newline at end of file
+}
+
+size_t Gadgetron::Core::Message::bytes() const {
+    return std::accumulate(messages_.begin(), messages_.end(), size_t(0),
+                           [](size_t total, auto &chunk) { return total + chunk->bytes(); });
+}
@@ -24,6 +24,8 @@ namespace Gadgetron {
             virtual std::unique_ptr<MessageChunk> clone() const = 0;
         protected:
             virtual GadgetContainerMessageBase *to_container_message() = 0;
+            virtual void share() = 0;
+            virtual size_t bytes() const = 0;
 
             friend Message;
         };
@@ -47,8 +49,12 @@ namespace Gadgetron {
 
             GadgetContainerMessageBase *to_container_message();
 
+            /// Copies the message. Its arrays share their memory with the copy, until either is written to.
             Message clone();
 
+            /// Approximate size of the message's payload in bytes (see Core::payload_bytes).
+            size_t bytes() const;
+
         private:
             std::vector<std::unique_ptr<MessageChunk>> messages_;
         };
@@ -92,6 +98,10 @@ namespace Gadgetron {
 
             std::unique_ptr<MessageChunk> clone() const override;
 
+            void share() override;
+
+            size_t bytes() const override;
+
             ~TypedMessageChunk() override = default;
 
             T data;
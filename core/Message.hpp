@@ -22,6 +22,16 @@ namespace Gadgetron::Core {
         return std::make_unique<TypedMessageChunk<T>>(data);
     }
 
+    template<class T>
+    void TypedMessageChunk<T>::share() {
+        Core::share(data);
+    }
+
+    template<class T>
+    size_t TypedMessageChunk<T>::bytes() const {
+        return Core::payload_bytes(data);
+    }
+
     namespace {
         namespace gadgetron_detail {
 
@@ -22,6 +22,31 @@ namespace Gadgetron::Core {
         virtual void process(GenericInputChannel& in, OutputChannel& out) = 0;
     };
 
+    /**
+     * Implemented by Nodes which handle their input one message at a time. A Stream may run a chain of such Nodes on
+     * a single thread, with each Node handing its output directly to the next, instead of giving every Node a thread
+     * and a channel of its own.
+     */
+    class FusibleNode {
+    public:
+        virtual ~FusibleNode() = default;
+
+        /// Called once, before the first message, with the channel the Node's output is sent on.
+        virtual void start(OutputChannel& out) {}
+
+        /// Processes a single message from upstream.
+        virtual void process_message(Message message, OutputChannel& out) = 0;
+
+        /// Called once after the last message, before the output is closed.
+        virtual void finish(OutputChannel& out) {}
+
+        /**
+         * Whether processing a message is cheap compared to handing it to another thread. Lightweight Nodes are fused
+         * with their neighbours unless the configuration says otherwise.
+         */
+        virtual bool lightweight() const { return false; }
+    };
+
     class GenericChannelGadget : public Node, public PropertyMixin {
     public:
         using PropertyMixin::PropertyMixin;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include <memory>
 #include <typeindex>
 #include <boost/dll.hpp>
@@ -16,6 +17,16 @@ namespace Gadgetron::Core {
         virtual Message read(std::istream &stream) = 0;
         virtual uint16_t slot() = 0;
 
+        /// A message off the stream: either decoded already, or the work of decoding it.
+        using PendingMessage = variant<Message, std::packaged_task<Message()>>;
+
+        /**
+         * Readers of messages which are expensive to decode may split reading in two: only the bytes of the message
+         * are taken off the stream here, and the returned task decodes them, possibly on another thread while the
+         * next message is read. By default, the message is read and decoded at once.
+         */
+        virtual PendingMessage read_pending(std::istream &stream) { return read(stream); }
+
         virtual ~Reader() = default;
     };
 }
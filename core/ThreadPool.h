@@ -4,6 +4,7 @@
 
 #pragma once
 #include "MPMCChannel.h"
+#include "WorkStealingExecutor.h"
 #include <boost/hana.hpp>
 #include <future>
 
@@ -71,35 +72,76 @@ namespace Gadgetron::Core {
         };
 
     public:
-        explicit ThreadPool(unsigned int workers) {
-            for (auto i = 0u; i < workers; i++) {
-                threads.emplace_back([this]() {
-                    try {
-                        while (true)
-                            this->work_queue.pop()->execute();
-                    } catch (const ChannelClosed&) {
-                    }
-                });
-            }
-        }
+        /**
+         * A ThreadPool is a view on the process wide WorkStealingExecutor, running at most
+         * `workers` of its tasks concurrently. Pools are cheap, and do not own any threads.
+         */
+        explicit ThreadPool(unsigned int workers, WorkStealingExecutor& executor = WorkStealingExecutor::global())
+            : state{ std::make_shared<State>(executor, workers ? workers : executor.size()) } {}
 
         template <class F, class... ARGS> auto async(F&& f, ARGS&&... args) {
             auto work = std::make_unique<ConcreteWork<F, ARGS...>>(std::forward<F>(f), std::forward<ARGS>(args)...);
             auto future_result = work->get_future();
-            work_queue.push(std::move(work));
-            return std::move(future_result);
+            State::enqueue(state, std::move(work));
+            return future_result;
         }
 
+        /// Waits for all submitted work to finish. No work can be submitted afterwards.
         void join(){
-            work_queue.close();
-            for (auto& thread : threads){
-                thread.join();
-            }
+            std::unique_lock<std::mutex> lock(state->m);
+            state->is_closed = true;
+            state->idle.wait(lock, [this]() { return state->running == 0 && state->pending.empty(); });
         }
 
     private:
-        MPMCChannel<std::unique_ptr<Work>> work_queue;
-        std::vector<std::thread> threads;
+        struct State {
+            State(WorkStealingExecutor& executor, unsigned int max_running)
+                : executor{ executor }, max_running{ max_running } {}
+
+            WorkStealingExecutor& executor;
+            const unsigned int max_running;
+
+            std::mutex m;
+            std::condition_variable idle;
+            std::list<std::unique_ptr<Work>> pending;
+            unsigned int running = 0;
+            bool is_closed = false;
+
+            static void enqueue(const std::shared_ptr<State>& state, std::unique_ptr<Work> work) {
+                {
+                    std::lock_guard<std::mutex> guard(state->m);
+                    if (state->is_closed)
+                        throw ChannelClosed();
+                    if (state->running >= state->max_running) {
+                        state->pending.emplace_back(std::move(work));
+                        return;
+                    }
+                    state->running++;
+                }
+                dispatch(state, std::move(work));
+            }
+
+            static void dispatch(std::shared_ptr<State> state, std::unique_ptr<Work> work) {
+                auto& executor = state->executor;
+                executor.submit([state, work = std::move(work)]() mutable {
+                    work->execute();
+                    work.reset();
+
+                    std::unique_lock<std::mutex> lock(state->m);
+                    if (!state->pending.empty()) {
+                        auto next = std::move(state->pending.front());
+                        state->pending.pop_front();
+                        lock.unlock();
+                        dispatch(state, std::move(next));
+                        return;
+                    }
+                    if (--state->running == 0)
+                        state->idle.notify_all();
+                });
+            }
+        };
+
+        std::shared_ptr<State> state;
     };
 
 }
@@ -5,7 +5,9 @@
 #include <ismrmrd/waveform.h>
 
 #include <boost/optional.hpp>
+#include <string>
 #include <tuple>
+#include <vector>
 #include "variant.hpp"
 #include "hoNDArray.h"
 #include "TypeTraits.h"
@@ -39,6 +41,85 @@ namespace Gadgetron::Core {
                     Image<std::complex<float>>,
                     Image<std::complex<double>>
             >;
+
+    namespace { namespace gadgetron_detail {
+        // Overloads are class members, so each may recurse into the others regardless of declaration order.
+        struct Sharing {
+            template<class T>
+            static auto share(T &value, int) -> decltype(value.share(), void()) { value.share(); }
+
+            template<class T>
+            static void share(T &, long) {}
+
+            template<class T>
+            static void share(optional<T> &value, int) { if (value) share(*value, 0); }
+
+            template<class T>
+            static void share(std::vector<T> &values, int) { for (auto &value : values) share(value, 0); }
+
+            template<class... ARGS>
+            static void share(tuple<ARGS...> &values, int) {
+                std::apply([](auto &... value) { (share(value, 0), ...); }, values);
+            }
+
+            template<class... ARGS>
+            static void share(variant<ARGS...> &value, int) {
+                visit([](auto &alternative) { share(alternative, 0); }, value);
+            }
+        };
+    }}
+
+    /// Lets copies of value share the memory of the arrays in it, until they are written to (see hoNDArray::share).
+    /// Types with a share() member share their arrays; tuples, variants, optionals and vectors pass it on.
+    template<class T>
+    void share(T &value) {
+        gadgetron_detail::Sharing::share(value, 0);
+    }
+
+    namespace { namespace gadgetron_detail {
+        struct Sizing {
+            template<class T>
+            static auto bytes(const T &value, int) -> decltype(size_t(value.get_number_of_bytes())) {
+                return value.get_number_of_bytes();
+            }
+
+            template<class T>
+            static size_t bytes(const T &, long) { return sizeof(T); }
+
+            static size_t bytes(const std::string &value, int) { return value.size(); }
+
+            static size_t bytes(const ISMRMRD::Waveform &value, int) {
+                return sizeof(value.head) + value.size() * sizeof(uint32_t);
+            }
+
+            template<class T>
+            static size_t bytes(const optional<T> &value, int) { return value ? bytes(*value, 0) : 0; }
+
+            template<class T>
+            static size_t bytes(const std::vector<T> &values, int) {
+                size_t total = 0;
+                for (auto &value : values) total += bytes(value, 0);
+                return total;
+            }
+
+            template<class... ARGS>
+            static size_t bytes(const tuple<ARGS...> &values, int) {
+                return std::apply([](auto &... value) { return (size_t(0) + ... + bytes(value, 0)); }, values);
+            }
+
+            template<class... ARGS>
+            static size_t bytes(const variant<ARGS...> &value, int) {
+                return visit([](auto &alternative) { return bytes(alternative, 0); }, value);
+            }
+        };
+    }}
+
+    /// Approximate size of value in bytes. Arrays, and types with a get_number_of_bytes() member, count their
+    /// elements; tuples, variants, optionals and vectors add up their contents, and anything else counts as its sizeof.
+    template<class T>
+    size_t payload_bytes(const T &value) {
+        return gadgetron_detail::Sizing::bytes(value, 0);
+    }
 }
 
 
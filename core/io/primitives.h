@@ -5,6 +5,7 @@
 
 #include "hoNDArray.h"
 #include "Types.h"
+#include "shared_memory.h"
 #include <boost/hana/adapt_struct.hpp>
 
 namespace Gadgetron::Core::IO {
@@ -27,6 +28,10 @@ namespace Gadgetron::Core::IO {
     template<class T>
     void read(std::istream &stream, hoNDArray<T> &array);
 
+    /// Reads the elements of an array already sized by the caller; the counterpart of write_payload.
+    template<class T>
+    void read_payload(std::istream &stream, hoNDArray<T> &array);
+
     template<class T>
     std::enable_if_t<boost::hana::Struct<T>::value> read(std::istream &istream, T &x);
 
@@ -63,6 +68,11 @@ namespace Gadgetron::Core::IO {
     template<class T>
     void write(std::ostream &stream, const hoNDArray<T> &array);
 
+    /// Writes the elements of an array, without its dimensions. On streams with shared memory enabled, they may
+    /// go through a shared memory segment instead; see shared_memory.h.
+    template<class T>
+    void write_payload(std::ostream &stream, const hoNDArray<T> &array);
+
     template<class T = uint64_t>
     void write_string_to_stream(std::ostream &stream, const std::string &str);
 }
@@ -48,6 +48,17 @@ Gadgetron::Core::IO::write(std::ostream &stream, const T *data, size_t number_of
 template<class T>
 void Gadgetron::Core::IO::write(std::ostream &stream, const hoNDArray <T> &array) {
     write(stream, *array.get_dimensions());
+    write_payload(stream, array);
+}
+
+template<class T>
+void Gadgetron::Core::IO::write_payload(std::ostream &stream, const hoNDArray <T> &array) {
+    if constexpr (is_trivially_copyable_v<T>) {
+        if (shared_memory_threshold(stream)) {
+            write_shared_memory_payload(stream, array.get_data_ptr(), array.get_number_of_bytes());
+            return;
+        }
+    }
     write(stream, array.get_data_ptr(), array.get_number_of_elements());
 }
 
@@ -105,8 +116,18 @@ template<class T>
 void Gadgetron::Core::IO::read(std::istream &stream, Gadgetron::hoNDArray<T> &array) {
     auto dimensions = IO::read<std::vector<size_t>>(stream);
     array = hoNDArray<T>(dimensions);
-    IO::read(stream,array.data(),array.size());
+    read_payload(stream, array);
+}
 
+template<class T>
+void Gadgetron::Core::IO::read_payload(std::istream &stream, Gadgetron::hoNDArray<T> &array) {
+    if constexpr (is_trivially_copyable_v<T>) {
+        if (shared_memory_threshold(stream)) {
+            read_shared_memory_payload(stream, array.data(), array.get_number_of_bytes());
+            return;
+        }
+    }
+    IO::read(stream,array.data(),array.size());
 }
 
 template<class T>
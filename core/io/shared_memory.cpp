@@ -0,0 +1,189 @@
+#include "shared_memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/permissions.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include "primitives.h"
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace bip = boost::interprocess;
+
+namespace {
+
+    enum class Location : uint8_t { inline_payload = 0, shared_memory = 1 };
+
+    int shared_memory_index() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    int session_index() {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    std::string unique_segment_name() {
+        static std::atomic<uint64_t> counter{0};
+        return "gadgetron-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    }
+
+    bool segment_exists(const std::string &name) {
+        try {
+            bip::shared_memory_object segment(bip::open_only, name.c_str(), bip::read_only);
+            return true;
+        } catch (const bip::interprocess_exception &) {
+            return false;
+        }
+    }
+
+    // The segments written per stream, so the ones a receiver never removed can be cleaned up when the stream
+    // is done. Streams are told apart by a session id rather than by address; serialization writes through
+    // buffer streams that carry a copy of the target stream's format, session included.
+    class SegmentRegistry {
+    public:
+        void add(long session, std::string name) {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto &segments = sessions[session];
+            segments.names.push_back(std::move(name));
+
+            // Receivers remove segments as they go; forget those now and then, so the list stays short.
+            if (segments.names.size() < segments.prune_at) return;
+            segments.names.erase(
+                    std::remove_if(segments.names.begin(), segments.names.end(),
+                                   [](auto &name) { return !segment_exists(name); }),
+                    segments.names.end()
+            );
+            segments.prune_at = std::max(minimum_prune_size, 2 * segments.names.size());
+        }
+
+        std::vector<std::string> release(long session) {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto it = sessions.find(session);
+            if (it == sessions.end()) return {};
+            auto names = std::move(it->second.names);
+            sessions.erase(it);
+            return names;
+        }
+
+    private:
+        static constexpr size_t minimum_prune_size = 64;
+
+        struct Segments {
+            std::vector<std::string> names;
+            size_t prune_at = minimum_prune_size;
+        };
+
+        std::mutex mutex;
+        std::map<long, Segments> sessions;
+    };
+
+    SegmentRegistry &segment_registry() {
+        static auto registry = new SegmentRegistry();
+        return *registry;
+    }
+}
+
+namespace Gadgetron::Core::IO {
+
+    void enable_shared_memory(std::ios_base &stream, size_t threshold) {
+        static std::atomic<long> sessions{1};
+
+        // Zero is what every stream starts out with, so the threshold is stored one up.
+        stream.iword(shared_memory_index()) = long(threshold) + 1;
+        if (stream.iword(session_index()) == 0) stream.iword(session_index()) = sessions++;
+    }
+
+    optional<size_t> shared_memory_threshold(const std::ios_base &stream) {
+        auto value = const_cast<std::ios_base &>(stream).iword(shared_memory_index());
+        if (value == 0) return none;
+        return size_t(value - 1);
+    }
+
+    void release_shared_memory(std::ios_base &stream) {
+        auto session = stream.iword(session_index());
+        if (session == 0) return;
+
+        for (auto &name : segment_registry().release(session))
+            bip::shared_memory_object::remove(name.c_str());
+    }
+
+    void write_shared_memory_payload(std::ostream &stream, const void *data, size_t bytes) {
+
+        auto threshold = shared_memory_threshold(stream);
+        if (!threshold || bytes < *threshold || bytes == 0) {
+            IO::write(stream, Location::inline_payload);
+            stream.write(static_cast<const char *>(data), bytes);
+            return;
+        }
+
+        auto name = unique_segment_name();
+
+        {
+            // Owner only; the segment holds raw data, and the receiver runs as the same user.
+            bip::shared_memory_object segment(bip::create_only, name.c_str(), bip::read_write, bip::permissions(0600));
+            try {
+                segment.truncate(bytes);
+                bip::mapped_region region(segment, bip::read_write);
+                std::memcpy(region.get_address(), data, bytes);
+            } catch (...) {
+                bip::shared_memory_object::remove(name.c_str());
+                throw;
+            }
+        }
+
+        segment_registry().add(stream.iword(session_index()), name);
+
+        IO::write(stream, Location::shared_memory);
+        IO::write_string_to_stream<uint16_t>(stream, name);
+    }
+
+    void read_shared_memory_payload(std::istream &stream, void *data, size_t bytes) {
+
+        if (!shared_memory_threshold(stream)) {
+            stream.read(static_cast<char *>(data), bytes);
+            return;
+        }
+
+        auto location = IO::read<Location>(stream);
+        if (location == Location::inline_payload) {
+            stream.read(static_cast<char *>(data), bytes);
+            return;
+        }
+
+        if (location != Location::shared_memory)
+            throw std::runtime_error("Unknown array payload location: " + std::to_string(int(location)));
+
+        auto name = IO::read_string_from_stream<uint16_t>(stream);
+
+        try {
+            bip::shared_memory_object segment(bip::open_only, name.c_str(), bip::read_only);
+            bip::mapped_region region(segment, bip::read_only);
+
+            if (region.get_size() < bytes)
+                throw std::runtime_error("Shared memory segment " + name + " is smaller than its array");
+
+            std::memcpy(data, region.get_address(), bytes);
+        } catch (...) {
+            bip::shared_memory_object::remove(name.c_str());
+            throw;
+        }
+
+        bip::shared_memory_object::remove(name.c_str());
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <iostream>
+
+#include "Types.h"
+
+namespace Gadgetron::Core::IO {
+
+    /// Arrays of at least this many bytes are placed in shared memory, on streams with shared memory enabled.
+    constexpr size_t default_shared_memory_threshold = 64 * 1024;
+
+    /// Lets arrays written to or read from the stream pass through shared memory, for peers on the same host.
+    /// Both ends of the stream must agree; the array format on the stream changes once this is enabled.
+    ///
+    /// The payload of an array is then preceded by a byte; 0 means the payload follows inline, 1 means it was placed
+    /// in a named shared memory segment (/dev/shm/<name> on Linux), and the name follows as a string with a uint16_t
+    /// length. The receiver owns the segment and removes it once it has been mapped. Segments the receiver never got
+    /// to are removed by release_shared_memory.
+    void enable_shared_memory(std::ios_base &stream, size_t threshold = default_shared_memory_threshold);
+
+    optional<size_t> shared_memory_threshold(const std::ios_base &stream);
+
+    /// Removes the segments written to the stream that the receiver has not removed; call once the connection is done.
+    void release_shared_memory(std::ios_base &stream);
+
+    void write_shared_memory_payload(std::ostream &stream, const void *data, size_t bytes);
+    void read_shared_memory_payload(std::istream &stream, void *data, size_t bytes);
+}
@@ -12,9 +12,11 @@ namespace Gadgetron::Core::Parallel {
     template<class... ARGS>
     void Fanout<ARGS...>::process(InputChannel<ARGS...> &input, std::map<std::string, OutputChannel> output) {
         for (auto thing : input) {
+            // Branches share the arrays of the message, until one of them writes to its copy.
+            Core::share(thing);
             for (auto &pair : output) {
                 auto copy_of_thing = thing;
-                pair.second.push(copy_of_thing);
+                pair.second.push(std::move(copy_of_thing));
             }
         }
     }
@@ -22,12 +22,12 @@ namespace Gadgetron::Core::Readers {
             trajectory = hoNDArray<float>(header.trajectory_dimensions,
                                           header.number_of_samples);
 
-            IO::read(stream, trajectory->data(),trajectory->size());
+            IO::read_payload(stream, *trajectory);
         }
 
         auto data = hoNDArray<std::complex<float>>(header.number_of_samples,
                                                    header.active_channels);
-        IO::read(stream, data.data(),data.size());
+        IO::read_payload(stream, data);
 
         return Core::Message(header, data, trajectory);
     }
@@ -33,7 +33,7 @@ template<> inline constexpr uint16_t ismrmrd_data_type<complext<double>>(){retur
     template<class T>
     Core::Message read_image_message(std::istream& stream, ISMRMRD::ImageHeader header, ISMRMRD::MetaContainer meta, T type_tag){
         auto image_data = hoNDArray<T>(header.matrix_size[0],header.matrix_size[1],header.matrix_size[2],header.channels);
-        Gadgetron::Core::IO::read(stream,image_data.data(),image_data.size());
+        Gadgetron::Core::IO::read_payload(stream,image_data);
         return Core::Message(header,std::move(image_data),std::move(meta));
     }
 }
@@ -19,7 +19,7 @@ namespace Gadgetron::Core::Readers {
 
         auto data = hoNDArray<uint32_t>(header.number_of_samples, header.channels);
 
-        IO::read(stream, data.data(),data.size());
+        IO::read_payload(stream, data);
 
         return Message(std::move(header), std::move(data));
     }
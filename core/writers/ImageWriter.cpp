@@ -50,7 +50,7 @@ namespace {
             IO::write(stream, corrected_header);
             IO::write(stream, meta_size);
             stream.write(serialized_meta.c_str(), meta_size);
-            IO::write(stream, data.get_data_ptr(), data.get_number_of_elements());
+            IO::write_payload(stream, data);
         }
     };
 
@@ -26,6 +26,7 @@ namespace Gadgetron {
 
         GADGET_PROPERTY(max_iter, size_t, "Maximal number of iterations", 150);
         GADGET_PROPERTY(thres_func, double, "Threshold for minimal change of cost function", 1e-4);
+        GADGET_PROPERTY(use_levenberg_marquardt, bool, "Whether to fit many pixels at once with Levenberg-Marquardt instead of the simplex search", false);
         GADGET_PROPERTY(max_T1, double, "Maximal T1 allowed in mapping (ms)", 4000);
 
         GADGET_PROPERTY(anchor_image_index, size_t, "Index for anchor image; by default, the first image is the anchor (without SR pulse)", 0);
@@ -125,6 +125,7 @@ namespace Gadgetron {
 
             t2_mapper.max_iter_ = max_iter.value();
             t2_mapper.thres_fun_ = thres_func.value();
+            t2_mapper.use_levenberg_marquardt_ = use_levenberg_marquardt.value();
             t2_mapper.max_map_value_ = max_T2.value();
 
             t2_mapper.verbose_ = verbose.value();
@@ -26,6 +26,7 @@ namespace Gadgetron {
 
         GADGET_PROPERTY(max_iter, size_t, "Maximal number of iterations", 150);
         GADGET_PROPERTY(thres_func, double, "Threshold for minimal change of cost function", 1e-4);
+        GADGET_PROPERTY(use_levenberg_marquardt, bool, "Whether to fit many pixels at once with Levenberg-Marquardt instead of the simplex search", false);
         GADGET_PROPERTY(max_T2, double, "Maximal T2 allowed in mapping (ms)", 4000);
 
     protected:
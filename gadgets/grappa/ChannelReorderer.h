@@ -16,6 +16,8 @@ namespace Gadgetron::Grappa {
 
         AnnotatedAcquisition process_function(Core::Acquisition acquisition) const override;
 
+        bool lightweight() const override { return true; }
+
         NODE_PROPERTY(
                 uncombined_channels, std::string,
                 "Uncombined channels as a comma separated list of channel indices or names (single quoted).", ""
@@ -4,8 +4,7 @@
 #include "parallel/Merge.h"
 
 #include "hoNDArray.h"
-#include "hoNDArray_elemwise.h"
-#include "hoNDArray_reductions.h"
+#include "hoNDArray_channel_mixing.h"
 
 
 namespace {
@@ -85,21 +84,20 @@ namespace Gadgetron::Grappa {
             const Weights &weights
     ) {
         hoNDArray<std::complex<float>> unmixed_image(create_unmixed_image_dimensions(weights));
-        clear(unmixed_image);
 
         auto sets = weights.data.get_number_of_elements() / image.data.get_number_of_elements();
         auto image_elements = unmixed_image.get_number_of_elements() / sets;
         auto coils = weights.data.get_number_of_elements() / (sets * image_elements);
 
-        for (unsigned int s = 0; s < sets; s++) {
-            for (unsigned int p = 0; p < image_elements; p++) {
-                for (unsigned int c = 0; c < coils; c++) {
-                    unmixed_image[s * image_elements + p] +=
-                            weights.data[s * image_elements * coils + c * image_elements + p] *
-                            image.data[c * image_elements + p] *
-                            unmixing_scale;
-                }
-            }
+        for (size_t s = 0; s < sets; s++) {
+            combine_channels(
+                    weights.data.data() + s * image_elements * coils,
+                    image.data.data(),
+                    unmixed_image.data() + s * image_elements,
+                    image_elements,
+                    coils,
+                    unmixing_scale
+            );
         }
 
         return std::move(unmixed_image);
@@ -157,7 +157,7 @@ namespace {
 namespace Gadgetron::Grappa {
 
     template<class WeightsCore>
-    Grappa::Weights create_weights(
+    optional<Grappa::Weights> create_weights(
             uint16_t index,
             const AcquisitionBuffer &buffer,
             uint16_t n_combined_channels,
@@ -166,19 +166,24 @@ namespace Gadgetron::Grappa {
             const AccelerationMonitor &acceleration_monitor,
             WeightsCore &core
     ) {
+        auto weights = core.calculate_weights(
+                buffer.view(index),
+                index,
+                support_monitor.region_of_support(index),
+                acceleration_monitor.acceleration_factor(index),
+                n_combined_channels,
+                n_uncombined_channels
+        );
+
+        if (!weights) return none;
+
         return Grappa::Weights{
                 {
                         index,
                         n_combined_channels,
                         n_uncombined_channels
                 },
-                core.calculate_weights(
-                        buffer.view(index),
-                        support_monitor.region_of_support(index),
-                        acceleration_monitor.acceleration_factor(index),
-                        n_combined_channels,
-                        n_uncombined_channels
-                )
+                std::move(*weights)
         };
     }
 
@@ -209,7 +214,7 @@ namespace Gadgetron::Grappa {
 
         WeightsCore core{
                 {coil_map_estimation_ks, coil_map_estimation_power},
-                {block_size_samples, block_size_lines, convolution_kernel_threshold}
+                {block_size_samples, block_size_lines, convolution_kernel_threshold, weights_update_tolerance}
         };
 
         while (true) {
@@ -220,7 +225,8 @@ namespace Gadgetron::Grappa {
 
                 if (!buffer.is_fully_sampled(index)) continue;
 
-                out.push(create_weights(
+                // Unmixing keeps using the weights it has until new ones are pushed.
+                auto weights = create_weights(
                         index,
                         buffer,
                         n_combined_channels,
@@ -228,7 +234,9 @@ namespace Gadgetron::Grappa {
                         support_monitor,
                         acceleration_monitor,
                         core
-                ));
+                );
+
+                if (weights) out.push(std::move(*weights));
             }
             updated_slices.clear();
         }
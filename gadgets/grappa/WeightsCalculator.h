@@ -20,6 +20,7 @@ namespace Gadgetron::Grappa {
         NODE_PROPERTY(block_size_lines, uint16_t, "Block size used to estimate missing samples; number of lines.", 4);
         NODE_PROPERTY(block_size_samples, uint16_t, "Block size used to estimate missing samples; number of samples.", 5);
         NODE_PROPERTY(convolution_kernel_threshold, float, "Grappa convolution kernel calibration Tikhonov threshold.", 5e-4);
+        NODE_PROPERTY(weights_update_tolerance, float, "Relative residual of the updated calibration equations below which the previous weights are kept; 0 recalculates on every update.", 0.0);
 
         void process(Core::InputChannel<Slice> &in, Core::OutputChannel &out) override;
 
@@ -1,5 +1,60 @@
 #include "WeightsCore.h"
 
+#include <cstring>
+#include <set>
+
+#include "hoNDArray_linalg.h"
+#include "hoNDArray_elemwise.h"
+
+namespace {
+    using namespace Gadgetron;
+
+    // Incremental updates accumulate rounding errors in the normal equations, so they are rebuilt now and then.
+    constexpr size_t updates_between_rebuilds = 32;
+
+    std::vector<size_t> changed_lines(
+            const hoNDArray<std::complex<float>> &previous,
+            const hoNDArray<std::complex<float>> &current
+    ) {
+        size_t RO = current.get_size(0);
+        size_t E1 = current.get_size(1);
+        size_t CHA = current.get_size(2);
+
+        std::vector<size_t> lines{};
+        for (size_t e1 = 0; e1 < E1; e1++) {
+            for (size_t cha = 0; cha < CHA; cha++) {
+                if (std::memcmp(&previous(0, e1, cha), &current(0, e1, cha), RO * sizeof(std::complex<float>))) {
+                    lines.push_back(e1);
+                    break;
+                }
+            }
+        }
+        return lines;
+    }
+
+    // Fitting positions in [first, last] whose rows of A or B read any of the lines.
+    std::vector<size_t> affected_positions(
+            const std::vector<size_t> &lines,
+            const std::vector<int> &kE1,
+            const std::vector<int> &oE1,
+            long long first,
+            long long last
+    ) {
+        std::set<size_t> positions{};
+
+        auto add = [&](long long e1) {
+            if (first <= e1 && e1 <= last) positions.insert(size_t(e1));
+        };
+
+        for (auto line : lines) {
+            for (auto k : kE1) add((long long)line - k);
+            for (auto o : oE1) add((long long)line - o);
+        }
+
+        return std::vector<size_t>(positions.begin(), positions.end());
+    }
+}
+
 namespace Gadgetron::Grappa::CPU {
 
     const hoNDArray<std::complex<float>> &WeightsCore::estimate_coil_map(const hoNDArray<std::complex<float>> &data) {
@@ -26,8 +81,142 @@ namespace Gadgetron::Grappa::CPU {
         return concat(weights);
     }
 
-    hoNDArray<std::complex<float>> WeightsCore::calculate_weights(
+    void WeightsCore::rebuild_calibration(Calibration &calibration, const hoNDArray<std::complex<float>> &data) {
+
+        hoNDArray<std::complex<float>> A, B;
+
+        Gadgetron::grappa2d_prepare_calib(
+                data,
+                data,
+                kernel_params.width,
+                calibration.kE1,
+                calibration.oE1,
+                calibration.region_of_support[0],
+                calibration.region_of_support[1],
+                calibration.region_of_support[2],
+                calibration.region_of_support[3],
+                A,
+                B
+        );
+
+        Gadgetron::gemm(calibration.AHA, A, true, A, false);
+        Gadgetron::gemm(calibration.AHB, A, true, B, false);
+
+        calibration.data = data;
+        calibration.updates_since_rebuild = 0;
+    }
+
+    bool WeightsCore::update_calibration(
+            Calibration &calibration,
+            const hoNDArray<std::complex<float>> &data,
+            std::array<uint16_t, 4> region_of_support,
+            uint16_t acceleration_factor
+    ) {
+        if (calibration.data.dimensions() != data.dimensions() ||
+            calibration.region_of_support != region_of_support ||
+            calibration.acceleration_factor != acceleration_factor) {
+
+            size_t convolution_width, convolution_height;
+            Gadgetron::grappa2d_kerPattern(
+                    calibration.kE1,
+                    calibration.oE1,
+                    convolution_width,
+                    convolution_height,
+                    acceleration_factor,
+                    kernel_params.width,
+                    kernel_params.height,
+                    false
+            );
+
+            calibration.region_of_support = region_of_support;
+            calibration.acceleration_factor = acceleration_factor;
+            calibration.kernel.clear();
+
+            rebuild_calibration(calibration, data);
+            return true;
+        }
+
+        auto lines = changed_lines(calibration.data, data);
+        if (lines.empty()) return false;
+
+        long long first = std::abs(calibration.kE1.front()) + region_of_support[2];
+        long long last = region_of_support[3] - calibration.kE1.back();
+
+        auto positions = affected_positions(lines, calibration.kE1, calibration.oE1, first, last);
+
+        if (++calibration.updates_since_rebuild >= updates_between_rebuilds ||
+            2 * positions.size() > size_t(last - first + 1)) {
+            rebuild_calibration(calibration, data);
+        }
+        else if (!positions.empty()) {
+            hoNDArray<std::complex<float>> A, B, AHA, AHB;
+
+            auto accumulate = [&](const hoNDArray<std::complex<float>> &source, bool remove) {
+                Gadgetron::grappa2d_prepare_calib_lines(
+                        source,
+                        source,
+                        kernel_params.width,
+                        calibration.kE1,
+                        calibration.oE1,
+                        region_of_support[0],
+                        region_of_support[1],
+                        positions,
+                        A,
+                        B
+                );
+
+                Gadgetron::gemm(AHA, A, true, A, false);
+                Gadgetron::gemm(AHB, A, true, B, false);
+
+                if (remove) {
+                    calibration.AHA -= AHA;
+                    calibration.AHB -= AHB;
+                }
+                else {
+                    calibration.AHA += AHA;
+                    calibration.AHB += AHB;
+                }
+            };
+
+            accumulate(calibration.data, true);
+            accumulate(data, false);
+
+            calibration.data = data;
+        }
+
+        return !previous_kernel_holds(calibration);
+    }
+
+    bool WeightsCore::previous_kernel_holds(const Calibration &calibration) const {
+
+        if (kernel_params.tolerance <= 0.0f || calibration.kernel.empty()) return false;
+
+        size_t K = calibration.AHA.get_size(0);
+        size_t KB = calibration.AHB.get_size(1);
+
+        // The kernel array is the solution of the normal equations, with its dimensions split up.
+        hoNDArray<std::complex<float>> x(K, KB, const_cast<std::complex<float> *>(calibration.kernel.data()));
+
+        hoNDArray<std::complex<float>> AHAx;
+        Gadgetron::gemm(AHAx, calibration.AHA, false, x, false);
+
+        // Same regularization as grappa2d_perform_calib_normal_equations.
+        double trace = 0.0;
+        for (size_t k = 0; k < K; k++) trace += std::abs(calibration.AHA(k, k));
+        auto lambda = float(trace * kernel_params.threshold / K);
+
+        double residual = 0.0, norm = 0.0;
+        for (size_t i = 0; i < AHAx.get_number_of_elements(); i++) {
+            residual += std::norm(AHAx[i] + lambda * x[i] - calibration.AHB[i]);
+            norm += std::norm(calibration.AHB[i]);
+        }
+
+        return residual <= double(kernel_params.tolerance) * kernel_params.tolerance * norm;
+    }
+
+    Core::optional<hoNDArray<std::complex<float>>> WeightsCore::calculate_weights(
             const hoNDArray<std::complex<float>> &data,
+            uint16_t slice,
             std::array<uint16_t, 4> region_of_support,
             uint16_t acceleration_factor,
             uint16_t n_combined_channels,
@@ -39,19 +228,26 @@ namespace Gadgetron::Grappa::CPU {
         size_t E1 = data.get_size(1);
         size_t CHA = data.get_size(2);
 
+        auto &calibration = calibrations[slice];
+        if (!update_calibration(calibration, data, region_of_support, acceleration_factor)) return Core::none;
+
         auto coil_map = estimate_coil_map(data);
 
-        Gadgetron::grappa2d_calib_convolution_kernel(
-                data,
-                data,
-                acceleration_factor,
+        Gadgetron::grappa2d_perform_calib_normal_equations(
+                calibration.AHA,
+                calibration.AHB,
+                kernel_params.width,
+                calibration.kE1,
+                calibration.oE1,
                 kernel_params.threshold,
+                calibration.kernel
+        );
+
+        Gadgetron::grappa2d_convert_to_convolution_kernel(
+                calibration.kernel,
                 kernel_params.width,
-                kernel_params.height,
-                region_of_support[0],
-                region_of_support[1],
-                region_of_support[2],
-                region_of_support[3],
+                calibration.kE1,
+                calibration.oE1,
                 buffers.convolution_kernel
         );
 
@@ -77,4 +273,4 @@ namespace Gadgetron::Grappa::CPU {
                 n_combined_channels
         );
     }
-}
\ No newline at end of file
+}
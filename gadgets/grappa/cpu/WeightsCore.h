@@ -1,5 +1,9 @@
 #pragma once
 
+#include <map>
+
+#include "Types.h"
+
 #include "hoNDFFT.h"
 #include "hoNDArray.h"
 #include "hoNDArray_utils.h"
@@ -11,8 +15,10 @@ namespace Gadgetron::Grappa::CPU {
 
     class WeightsCore {
     public:
-        hoNDArray<std::complex<float>> calculate_weights(
+        // Returns none when the previous weights of the slice still fit its calibration data.
+        Core::optional<hoNDArray<std::complex<float>>> calculate_weights(
                 const hoNDArray<std::complex<float>> &data,
+                uint16_t slice,
                 std::array<uint16_t, 4> region_of_support,
                 uint16_t acceleration_factor,
                 uint16_t n_combined_channels,
@@ -36,7 +42,7 @@ namespace Gadgetron::Grappa::CPU {
 
         struct {
             uint16_t width, height;
-            float threshold;
+            float threshold, tolerance;
         } kernel_params;
 
         struct {
@@ -44,5 +50,29 @@ namespace Gadgetron::Grappa::CPU {
             hoNDArray<std::complex<float>> image, coil_map, convolution_kernel, image_domain_kernel;
             hoNDArray<float> g_factor;
         } buffers;
+
+        // Normal equations AᴴA ker = AᴴB of the kernel fit of a slice. In real-time imaging only a few lines
+        // change between updates, so only the rows of A and B reading those lines are replaced.
+        struct Calibration {
+            hoNDArray<std::complex<float>> data, AHA, AHB, kernel;
+            std::array<uint16_t, 4> region_of_support = {0, 0, 0, 0};
+            uint16_t acceleration_factor = 0;
+            std::vector<int> kE1, oE1;
+            size_t updates_since_rebuild = 0;
+        };
+
+        std::map<uint16_t, Calibration> calibrations;
+
+    private:
+        bool update_calibration(
+                Calibration &calibration,
+                const hoNDArray<std::complex<float>> &data,
+                std::array<uint16_t, 4> region_of_support,
+                uint16_t acceleration_factor
+        );
+
+        void rebuild_calibration(Calibration &calibration, const hoNDArray<std::complex<float>> &data);
+
+        bool previous_kernel_holds(const Calibration &calibration) const;
     };
-}
\ No newline at end of file
+}
@@ -9,8 +9,9 @@
 
 namespace Gadgetron::Grappa::GPU {
 
-    hoNDArray<std::complex<float>> WeightsCore::calculate_weights(
+    Core::optional<hoNDArray<std::complex<float>>> WeightsCore::calculate_weights(
             const hoNDArray<std::complex<float>> &data,
+            uint16_t slice,
             std::array<uint16_t, 4> region_of_support,
             uint16_t acceleration_factor,
             uint16_t n_combined_channels,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Types.h"
 #include "hoNDArray.h"
 #include "cuNDArray.h"
 
@@ -7,8 +8,9 @@ namespace Gadgetron::Grappa::GPU {
 
     class WeightsCore {
     public:
-        hoNDArray<std::complex<float>> calculate_weights(
+        Core::optional<hoNDArray<std::complex<float>>> calculate_weights(
                 const hoNDArray<std::complex<float>> &data,
+                uint16_t slice,
                 std::array<uint16_t, 4> region_of_support,
                 uint16_t acceleration_factor,
                 uint16_t n_combined_channels,
@@ -23,7 +25,8 @@ namespace Gadgetron::Grappa::GPU {
 
         struct {
             uint16_t width, height;
-            float threshold;
+            // Incremental calibration is not implemented on the GPU; every update recalculates the weights.
+            float threshold, tolerance;
         } kernel_params;
     };
 }
\ No newline at end of file
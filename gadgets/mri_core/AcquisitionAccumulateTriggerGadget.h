@@ -25,6 +25,8 @@ namespace Gadgetron{
 
       int close(unsigned long flags);
 
+      bool lightweight() const override { return true; }
+
 
     protected:
       GADGET_PROPERTY_LIMITS(trigger_dimension, std::string, "Dimension to trigger on", "",
@@ -15,7 +15,9 @@ namespace Gadgetron{
     {
     public:
       GADGET_DECLARE(AcquisitionPassthroughGadget);
-      
+
+      bool lightweight() const override { return true; }
+
     protected:
       virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
 			  GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2);
@@ -20,6 +20,8 @@ public:
 
     AsymmetricEchoAdjustROGadget();
 
+    bool lightweight() const override { return true; }
+
 protected:
 
     virtual int process_config(ACE_Message_Block* mb);
@@ -19,6 +19,8 @@ class ComplexToFloatGadget: public Core::PureGadget<Core::Image<float>,Core::Ima
         ComplexToFloatGadget(const Core::Context& context, const Core::GadgetProperties& props);
 
         Core::Image<float> process_function(Core::Image<std::complex<float>> args) const override;
+
+        bool lightweight() const override { return true; }
     private:
         std::map<uint16_t,std::function<hoNDArray<float>(const hoNDArray<std::complex<float>>&)>> converters;
 };
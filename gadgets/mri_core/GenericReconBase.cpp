@@ -35,6 +35,8 @@ namespace Gadgetron {
                 GERROR("Error creating the debug folder.\n");
                 return false;
             }
+
+            gt_exporter_.configure(debug_queue_size_mb.value() * 1024 * 1024, ImageIOAsync::format_from_string(debug_format.value()));
         }
         else
         {
@@ -20,7 +20,7 @@
 #include "mri_core_data.h"
 #include "mri_core_utility.h"
 
-#include "ImageIOAnalyze.h"
+#include "ImageIOAsync.h"
 
 #include "gadgetron_sha1.h"
 
@@ -41,6 +41,9 @@ namespace Gadgetron {
         /// debug and timing
         GADGET_PROPERTY(verbose, bool, "Whether to print more information", false);
         GADGET_PROPERTY(debug_folder, std::string, "If set, the debug output will be written out", "");
+        GADGET_PROPERTY(debug_queue_size_mb, size_t, "Memory of the debug output waiting to be written; once full, further output is dropped. If 0, the output is written before recon continues", 1024);
+        GADGET_PROPERTY_LIMITS(debug_format, std::string, "Format of the debug output", "analyze",
+            GadgetPropertyLimitsEnumeration, "analyze", "compressed");
         GADGET_PROPERTY(perform_timing, bool, "Whether to perform timing on some computational steps", false);
 
         /// ms for every time tick
@@ -65,8 +68,8 @@ namespace Gadgetron {
         // debug folder
         std::string debug_folder_full_path_;
 
-        // exporter
-        Gadgetron::ImageIOAnalyze gt_exporter_;
+        // exporter, writing on a thread of its own
+        Gadgetron::ImageIOAsync gt_exporter_;
 
         // --------------------------------------------------
         // gadget functions
@@ -15,6 +15,8 @@ namespace Gadgetron{
     public:
       GADGET_DECLARE(ImageArraySplitGadget)
       ImageArraySplitGadget();
+
+      bool lightweight() const override { return true; }
 	
     protected:
       virtual int process(GadgetContainerMessage<IsmrmrdImageArray>* m1);
@@ -10,5 +10,9 @@ namespace Gadgetron {
         }
     }
 
+    void ImageFinishGadget::process_message(Core::Message message, Core::OutputChannel& out) {
+        out.push_message(std::move(message));
+    }
+
     GADGETRON_GADGET_EXPORT(ImageFinishGadget);
 }
@@ -6,13 +6,17 @@
 
 namespace Gadgetron {
 
-    class EXPORTGADGETSMRICORE ImageFinishGadget : public Core::GenericChannelGadget {
+    class EXPORTGADGETSMRICORE ImageFinishGadget : public Core::GenericChannelGadget, public Core::FusibleNode {
     public:
         ImageFinishGadget(
                 const Core::Context &context,
                 const Core::GadgetProperties &properties
         ) : GenericChannelGadget(properties) {};
 
+        void process_message(Core::Message message, Core::OutputChannel& out) override;
+
+        bool lightweight() const override { return true; }
+
     protected:
         void process(Core::GenericInputChannel& in,
                     Core::OutputChannel& out) override;
@@ -1,15 +1,23 @@
 #ifndef NHLBICOMPRESSION_H
 #define NHLBICOMPRESSION_H
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <exception>
 #include <fstream>
 #include <iostream>
 #include <cmath>
 #include <string>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GADGETRON_NHLBI_COMPRESSION_X86
+#include <immintrin.h>
+#endif
+
 #pragma pack(push, 1)
 struct CompressionHeader
 {
@@ -19,6 +27,87 @@ struct CompressionHeader
 };
 #pragma pack(pop)
 
+namespace NHLBICompressionKernels
+{
+    // Values are packed back to back, bits wide, in two's complement. Each is unpacked from the 64 bit window
+    // starting at its first byte, so values may be up to 57 bits wide.
+    template <typename T>
+    inline void unpack_scalar(const uint8_t* packed, size_t packed_bytes, size_t bits, T scale,
+                              size_t begin, size_t end, T* output)
+    {
+        const unsigned unused = unsigned(64 - bits);
+
+        // Every full window is read with a fixed size copy; only the last few values need a shorter one.
+        size_t full_windows = packed_bytes >= 8 ? std::min(end, ((packed_bytes - 8) * 8) / bits + 1) : 0;
+        full_windows = std::max(full_windows, begin);
+
+        for (size_t i = begin; i < full_windows; i++) {
+            size_t bit = i * bits;
+            uint64_t window;
+            std::memcpy(&window, packed + bit / 8, sizeof(window));
+            int64_t value = int64_t((window >> (bit % 8)) << unused) >> unused;
+            output[i] = value / scale;
+        }
+
+        for (size_t i = full_windows; i < end; i++) {
+            size_t bit = i * bits;
+            uint64_t window = 0;
+            std::memcpy(&window, packed + bit / 8, std::min<size_t>(sizeof(window), packed_bytes - bit / 8));
+            int64_t value = int64_t((window >> (bit % 8)) << unused) >> unused;
+            output[i] = value / scale;
+        }
+    }
+
+#ifdef GADGETRON_NHLBI_COMPRESSION_X86
+
+    // Unpacks 8 values at a time from 32 bit windows, so values may be up to 25 bits wide.
+    // Returns the number of values unpacked; the rest would read past the end of the packed data.
+    __attribute__((target("avx2"))) inline size_t unpack_avx2(const uint8_t* packed, size_t packed_bytes,
+                                                               size_t bits, float scale, size_t elements, float* output)
+    {
+        if (packed_bytes < 4 || elements * bits >= (size_t(1) << 31)) return 0;
+
+        // The last value whose 32 bit window lies within the packed data.
+        size_t vector_end = std::min(elements, ((packed_bytes - 4) * 8) / bits + 1);
+        vector_end -= vector_end % 8;
+
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i width = _mm256_set1_epi32(int(bits));
+        const __m256i seven = _mm256_set1_epi32(7);
+        const __m128i unused = _mm_cvtsi32_si128(int(32 - bits));
+        const __m256 scales = _mm256_set1_ps(scale);
+
+        for (size_t i = 0; i < vector_end; i += 8) {
+            __m256i bit = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(int(i)), lanes), width);
+            __m256i window = _mm256_i32gather_epi32(reinterpret_cast<const int*>(packed), _mm256_srli_epi32(bit, 3), 1);
+            __m256i value = _mm256_srlv_epi32(window, _mm256_and_si256(bit, seven));
+            value = _mm256_sra_epi32(_mm256_sll_epi32(value, unused), unused);
+            _mm256_storeu_ps(output + i, _mm256_div_ps(_mm256_cvtepi32_ps(value), scales));
+        }
+
+        return vector_end;
+    }
+
+    inline bool avx2_supported()
+    {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+#endif // GADGETRON_NHLBI_COMPRESSION_X86
+
+    template <typename T>
+    inline void unpack(const uint8_t* packed, size_t packed_bytes, size_t bits, T scale, size_t elements, T* output)
+    {
+        size_t done = 0;
+#ifdef GADGETRON_NHLBI_COMPRESSION_X86
+        if (std::is_same<T, float>::value && bits <= 25 && avx2_supported())
+            done = unpack_avx2(packed, packed_bytes, bits, float(scale), elements, reinterpret_cast<float*>(output));
+#endif
+        unpack_scalar(packed, packed_bytes, bits, scale, done, elements, output);
+    }
+}
+
 template <typename T> class CompressedBuffer
 {
 
@@ -49,7 +138,7 @@ public:
             bits_++; //Signed
         } else {
             bits_ = precision_bits;
-            uint64_t max_int = (1<<(bits_-1))-1;
+            uint64_t max_int = (uint64_t(1)<<(bits_-1))-1;
             scale_ = (max_int-1)/max_val_;
             tolerance_ = 0.5/scale_;
         }
@@ -97,25 +186,40 @@ public:
 
     void deserialize(std::vector<uint8_t>& buffer)
     {
-        if (buffer.size() <= sizeof(CompressionHeader)) {
+        deserialize(buffer.data(), buffer.size());
+    }
+
+    void deserialize(const uint8_t* buffer, size_t size)
+    {
+        if (size <= sizeof(CompressionHeader)) {
             throw std::runtime_error("Invalid buffer size");
         }
 
         CompressionHeader h;
-        memcpy(&h, &buffer[0], sizeof(CompressionHeader));
+        memcpy(&h, buffer, sizeof(CompressionHeader));
         
         size_t bytes_needed = static_cast<size_t>(std::ceil((h.bits_*h.elements_)/8.0f));
-        if (bytes_needed != (buffer.size()-sizeof(CompressionHeader))) {
+        if (bytes_needed != (size-sizeof(CompressionHeader))) {
             throw std::runtime_error("Incorrect number of bytes in buffer");
         }
 
+        if (h.bits_ == 0 || h.bits_ > 57) {
+            throw std::runtime_error("Unsupported number of bits per value");
+        }
+
         this->bits_ = h.bits_;
         this->elements_ = h.elements_;
         this->scale_ = h.scale_;
         this->tolerance_ = 0.5/h.scale_;
         this->comp_.resize(bytes_needed,0);
 
-        memcpy(&comp_[0], &buffer[sizeof(CompressionHeader)], bytes_needed);
+        memcpy(&comp_[0], buffer + sizeof(CompressionHeader), bytes_needed);
+    }
+
+    /// Unpacks all values into output, which must hold size() values.
+    void decompress(T* output) const
+    {
+        NHLBICompressionKernels::unpack(comp_.data(), comp_.size(), bits_, scale_, elements_, output);
     }
 
 private:
@@ -130,31 +234,37 @@ private:
     {
         size_t sb = (idx*bits_)/8;
 
-        uint64_t* bptr = reinterpret_cast<uint64_t*>(&comp_[sb]);
+        // The 64 bit window may run past the end of the buffer for the last few values.
+        uint64_t window = 0;
+        size_t window_bytes = std::min<size_t>(sizeof(window), comp_.size()-sb);
+        memcpy(&window, &comp_[sb], window_bytes);
         
         size_t upshift = idx*bits_-sb*8;
 
         //Create mask with ones corresponding to current bits
-        const uint64_t bitmask = ((1<<bits_)-1)<<upshift;
+        const uint64_t bitmask = ((uint64_t(1)<<bits_)-1)<<upshift;
 
         //Convert number to compact integeter representation
         int64_t int_val = static_cast<int64_t>(std::round(v*scale_));
         uint64_t compact_val = compact_int(int_val);
-        *bptr = ((*bptr) & (~bitmask)) | (compact_val << upshift);         
+        window = (window & (~bitmask)) | ((compact_val << upshift) & bitmask);
+        memcpy(&comp_[sb], &window, window_bytes);
     }
 
     float getValue(size_t idx)
     {
         size_t sb = (idx*bits_)/8;
-        uint64_t* bptr = reinterpret_cast<uint64_t*>(&comp_[sb]);
+
+        uint64_t window = 0;
+        memcpy(&window, &comp_[sb], std::min<size_t>(sizeof(window), comp_.size()-sb));
         
         size_t upshift = idx*bits_-sb*8;
 
         //Create mask with ones corresponding to current bits
-        const uint64_t bitmask = ((1<<bits_)-1)<<upshift;
+        const uint64_t bitmask = ((uint64_t(1)<<bits_)-1)<<upshift;
 
         //Mask other bits and shift back down
-        uint64_t compact_val =  (*bptr & bitmask)>>upshift;
+        uint64_t compact_val =  (window & bitmask)>>upshift;
 
         //Convert back to binary
         int64_t int_val = uncompact_int(compact_val);
@@ -169,7 +279,7 @@ private:
         uint64_t abs_val = static_cast<uint64_t>(std::abs(bin));
         
         if (bin < 0) {
-            const uint64_t bitmask = ((1<<bits_)-1);
+            const uint64_t bitmask = ((uint64_t(1)<<bits_)-1);
             abs_val ^= bitmask;
             abs_val += 1;
         }
@@ -178,8 +288,8 @@ private:
 
     int64_t uncompact_int(uint64_t cbin)
     {
-        if (cbin & (1<<(bits_-1))) {
-            const uint64_t bitmask = ((1<<bits_)-1);
+        if (cbin & (uint64_t(1)<<(bits_-1))) {
+            const uint64_t bitmask = ((uint64_t(1)<<bits_)-1);
             int64_t out = static_cast<int64_t>((cbin ^ bitmask)+1);
             out = -out;
             return out;
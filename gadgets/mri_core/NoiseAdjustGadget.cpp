@@ -1,6 +1,7 @@
 #include "NoiseAdjustGadget.h"
 #include "hoArmadillo.h"
 #include "hoMatrix.h"
+#include "hoNDArray_channel_mixing.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_linalg.h"
 #include "hoNDArray_reductions.h"
@@ -122,6 +123,12 @@ namespace Gadgetron {
 #endif // _WIN32
         }
 
+        Core::optional<std::vector<ISMRMRD::CoilLabel>> coil_labels_of(const ISMRMRD::IsmrmrdHeader& header) {
+            if (!header.acquisitionSystemInformation)
+                return Core::none;
+            return header.acquisitionSystemInformation->coilLabel;
+        }
+
         std::string to_string(const std::vector<ISMRMRD::CoilLabel>& coils) {
             std::stringstream sstream;
             for (auto i = 0u; i < coils.size(); i++)
@@ -308,7 +315,13 @@ namespace Gadgetron {
             noise_dependency_folder, noise_dependency_prefix);
         GDEBUG("Stored noise dependency is %s\n", noise_dependency_file.c_str());
 
-        auto noise_covariance = loadNoiseCovariance(noise_dependency_file);
+        auto noise_covariance = noise_cache.load(noise_dependency_file, [&]() -> Core::optional<NoiseCovarianceCache::Covariance> {
+            auto parsed = loadNoiseCovariance(noise_dependency_file);
+            if (!parsed)
+                return Core::none;
+            return NoiseCovarianceCache::Covariance{ coil_labels_of(parsed->header), parsed->noise_dwell_time_us,
+                std::move(parsed->noise_covariance_matrix) };
+        });
         // try to load the precomputed noise prewhitener
         if (!noise_covariance) {
             GDEBUG("Stored noise dependency is NOT found : %s\n", noise_dependency_file.c_str());
@@ -316,18 +329,18 @@ namespace Gadgetron {
         } else {
             GDEBUG("Stored noise dependency is found : %s\n", noise_dependency_file.c_str());
             GDEBUG("Stored noise dwell time in us is %f\n", noise_covariance->noise_dwell_time_us);
-            size_t CHA = noise_covariance->noise_covariance_matrix.get_size(0);
+            size_t CHA = noise_covariance->matrix.get_size(0);
             GDEBUG("Stored noise channel number is %d\n", CHA);
 
-            if (noise_covariance->header.acquisitionSystemInformation) {
+            if (noise_covariance->coil_labels) {
                 GDEBUG_STREAM("Noise coil info: ");
-                GDEBUG_STREAM(to_string(noise_covariance->header.acquisitionSystemInformation->coilLabel));
+                GDEBUG_STREAM(to_string(*noise_covariance->coil_labels));
 
                 GDEBUG_STREAM("Data coil info: ");
                 GDEBUG_STREAM(to_string(current_ismrmrd_header.acquisitionSystemInformation->coilLabel));
 
                 std::vector<size_t> coil_order_of_data_in_noise;
-                bool labels_match = compare_coil_label(noise_covariance->header.acquisitionSystemInformation->coilLabel,
+                bool labels_match = compare_coil_label(*noise_covariance->coil_labels,
                     current_ismrmrd_header.acquisitionSystemInformation->coilLabel, coil_order_of_data_in_noise);
 
                 if (!labels_match) {
@@ -339,15 +352,15 @@ namespace Gadgetron {
                     } else {
                         if (coil_order_of_data_in_noise.size() == CHA) {
                             GWARN_STREAM("Noise and meansurement have different coils, but will be reordered ... ");
-                            noise_covariance->noise_covariance_matrix = reorder_noise_channels(
-                                noise_covariance->noise_covariance_matrix, coil_order_of_data_in_noise);
+                            noise_covariance->matrix = reorder_noise_channels(
+                                noise_covariance->matrix, coil_order_of_data_in_noise);
 
                         } else {
                             GWARN_STREAM("Noise and meansurement have different coils and cannot be reordered ... ");
                         }
                     }
                 }
-                return LoadedNoise{noise_covariance->noise_covariance_matrix,noise_covariance->noise_dwell_time_us};
+                return LoadedNoise{noise_covariance->matrix,noise_covariance->noise_dwell_time_us};
 
             } else if (current_ismrmrd_header.acquisitionSystemInformation) {
                 GERROR("Noise ismrmrd header does not have acquisition system information but current header "
@@ -399,9 +412,14 @@ namespace Gadgetron {
 
         normalize_covariance(ng);
 
+        auto noise_dependency_file
+            = generateNoiseDependencyFilePath(measurement_id, noise_dependency_folder, noise_dependency_prefix);
+
         saveNoiseCovariance(
             NoiseCovariance{ this->current_ismrmrd_header, ng.noise_dwell_time_us, ng.tmp_covariance },
-            generateNoiseDependencyFilePath(measurement_id, noise_dependency_folder, noise_dependency_prefix));
+            noise_dependency_file);
+        noise_cache.store(noise_dependency_file, NoiseCovarianceCache::Covariance{
+            coil_labels_of(current_ismrmrd_header), ng.noise_dwell_time_us, ng.tmp_covariance });
     }
 
     template <> void NoiseAdjustGadget::save_noisedata(NoiseHandler& nh) const {
@@ -421,9 +439,7 @@ namespace Gadgetron {
 
         auto& data = std::get<hoNDArray<std::complex<float>>>(acq);
         if (data.get_size(1) == pw.prewhitening_matrix.get_size(0)) {
-            auto dataM = as_arma_matrix(data);
-            auto pwm = as_arma_matrix(pw.prewhitening_matrix);
-            dataM *= pwm;
+            mix_channels(pw.prewhitening_matrix, { &data });
         } else if (!this->pass_nonconformant_data) {
             throw std::runtime_error("Input data has different number of channels from noise data");
         }
@@ -443,7 +459,7 @@ namespace Gadgetron {
 
         auto masked_covariance = mask_channels(ng.tmp_covariance, scale_only_channels);
 
-        auto prewhitening_matrix = computeNoisePrewhitener(masked_covariance);
+        auto prewhitening_matrix = noise_cache.prewhitener(masked_covariance, computeNoisePrewhitener);
         prewhitening_matrix
             *= calculate_scale_factor(head.sample_time_us, ng.noise_dwell_time_us, receiver_noise_bandwidth);
         return handle_acquisition(Prewhitener{ prewhitening_matrix }, acq);
@@ -454,7 +470,7 @@ namespace Gadgetron {
         LoadedNoise ln, Core::Acquisition& acq) const {
         auto& head               = std::get<ISMRMRD::AcquisitionHeader>(acq);
         auto masked_covariance   = mask_channels(std::move(ln.covariance), scale_only_channels);
-        auto prewhitening_matrix = computeNoisePrewhitener(masked_covariance);
+        auto prewhitening_matrix = noise_cache.prewhitener(masked_covariance, computeNoisePrewhitener);
         prewhitening_matrix
             *= calculate_scale_factor(head.sample_time_us, ln.noise_dwell_time_us, receiver_noise_bandwidth);
         return handle_acquisition(Prewhitener{ prewhitening_matrix }, acq);
@@ -478,16 +494,58 @@ namespace Gadgetron {
         auto filepath
             = generateNoiseDependencyFilePath(measurement_id, noise_dependency_folder, noise_dependency_prefix);
 
+        // Acquisitions already queued are taken along with the one we waited for, and prewhitened as a batch.
+        // Other messages are passed on as they come, so the batch so far goes out ahead of them.
+        std::vector<Core::Acquisition> batch;
+        auto flush = [&]() {
+            if (!batch.empty())
+                process_batch(batch, output);
+            batch.clear();
+        };
+
         for (auto acq : input) {
+            batch.push_back(std::move(acq));
+            while (batch.size() < prewhitening_batch_size) {
+                auto next = input.try_pop(flush);
+                if (!next)
+                    break;
+                batch.push_back(std::move(*next));
+            }
+
+            flush();
+        }
+
+        this->save_noisedata(noisehandler);
+    }
+
+    void NoiseAdjustGadget::process_batch(std::vector<Core::Acquisition>& batch, Core::OutputChannel& output) {
+
+        std::vector<hoNDArray<std::complex<float>>*> readouts;
+
+        for (auto& acq : batch) {
             if (is_noise(acq)) {
                 add_noise(noisehandler, acq);
                 continue;
             }
+
+            // Once in place, the prewhitener never changes, so conforming readouts can be deferred and mixed together.
+            auto prewhitener = Core::get_if<Prewhitener>(&noisehandler);
+            auto& data       = std::get<hoNDArray<std::complex<float>>>(acq);
+            if (prewhitener && data.get_size(1) == prewhitener->prewhitening_matrix.get_size(0)) {
+                readouts.push_back(&data);
+                continue;
+            }
+
             noisehandler = handle_acquisition(std::move(noisehandler), acq);
-            output.push(std::move(acq));
         }
 
-        this->save_noisedata(noisehandler);
+        if (!readouts.empty())
+            mix_channels(Core::get<Prewhitener>(noisehandler).prewhitening_matrix, readouts);
+
+        for (auto& acq : batch) {
+            if (!is_noise(acq))
+                output.push(std::move(acq));
+        }
     }
 
     GADGETRON_GADGET_EXPORT(NoiseAdjustGadget)
@@ -2,6 +2,7 @@
 
 #include "GadgetronTimer.h"
 #include "Node.h"
+#include "NoiseCovarianceCache.h"
 #include "Types.h"
 #include "gadgetron_mricore_export.h"
 #include "hoNDArray.h"
@@ -55,6 +56,10 @@ namespace Gadgetron {
             scale_only_channels_by_name, std::string, "List of named channels that should only be scaled", "");
         NODE_PROPERTY(noise_dependency_folder, boost::filesystem::path, "Path to the working directory",
             boost::filesystem::temp_directory_path() / "gadgetron");
+        NODE_PROPERTY(prewhitening_batch_size, size_t, "Maximum number of queued acquisitions prewhitened together", 16);
+        NODE_PROPERTY(max_cached_prewhiteners, size_t,
+            "Number of prewhitening matrices kept on disk in the noise dependency folder; 0 keeps none",
+            NoiseCovarianceCache::default_max_prewhiteners);
 
         const float receiver_noise_bandwidth;
 
@@ -64,6 +69,9 @@ namespace Gadgetron {
         // We will store/load a copy of the noise scans XML header to enable us to check which coil layout, etc.
         const ISMRMRD::IsmrmrdHeader current_ismrmrd_header;
 
+        const NoiseCovarianceCache noise_cache{ noise_dependency_folder, noise_dependency_prefix,
+            max_cached_prewhiteners };
+
 
         NoiseHandler noisehandler = IgnoringNoise{};
 
@@ -84,5 +92,7 @@ namespace Gadgetron {
         void save_noisedata(NOISEHANDLER& nh) const;
 
         NoiseHandler load_or_gather() const;
+
+        void process_batch(std::vector<Core::Acquisition>& batch, Core::OutputChannel& out);
     };
 }
@@ -0,0 +1,334 @@
+#include "NoiseCovarianceCache.h"
+#include "log.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace bf  = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace Gadgetron {
+    namespace {
+
+        constexpr uint64_t entry_magic   = 0x564f436573696f4eull; // "NoiseCOV"
+        constexpr uint32_t entry_version = 1;
+
+        enum class EntryKind : uint32_t { covariance = 1, prewhitener = 2 };
+
+        struct EntryHeader {
+            uint64_t magic;
+            uint32_t version;
+            EntryKind kind;
+            uint64_t source_time;
+            uint64_t source_size;
+        };
+
+        uint64_t fnv1a(const void* data, size_t bytes, uint64_t hash = 0xcbf29ce484222325ull) {
+            auto bytes_ptr = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < bytes; i++) {
+                hash ^= bytes_ptr[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        class EntryWriter {
+        public:
+            template <class T> void write(const T& value) {
+                static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written");
+                write_bytes(&value, sizeof(T));
+            }
+
+            void write(const std::string& value) {
+                write(uint32_t(value.size()));
+                write_bytes(value.data(), value.size());
+            }
+
+            void write(const hoNDArray<std::complex<float>>& matrix) {
+                write(uint64_t(matrix.get_size(0)));
+                write_bytes(matrix.data(), matrix.get_number_of_bytes());
+            }
+
+            void write_bytes(const void* data, size_t bytes) {
+                buffer.append(static_cast<const char*>(data), bytes);
+            }
+
+            // Written next to the entry and renamed into place, so readers never observe a partial entry.
+            void commit(const bf::path& entry) const {
+                auto temporary = entry;
+                temporary += bf::unique_path(".%%%%-%%%%-%%%%-%%%%.tmp");
+
+                {
+                    std::ofstream file(temporary.string(), std::ios::out | std::ios::binary);
+                    file.write(buffer.data(), buffer.size());
+                    if (!file.good())
+                        throw std::runtime_error("Failed to write " + temporary.string());
+                }
+
+                boost::system::error_code error;
+                bf::rename(temporary, entry, error);
+                if (error) {
+                    bf::remove(temporary, error);
+                    throw std::runtime_error("Failed to move cache entry into place at " + entry.string());
+                }
+            }
+
+        private:
+            std::string buffer;
+        };
+
+        class EntryReader {
+        public:
+            explicit EntryReader(const bf::path& entry)
+                : mapping(entry.string().c_str(), bip::read_only), region(mapping, bip::read_only) {}
+
+            template <class T> T read() {
+                static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read");
+                T value;
+                read_bytes(&value, sizeof(T));
+                return value;
+            }
+
+            std::string read_string() {
+                std::string value(read<uint32_t>(), '\0');
+                read_bytes(&value[0], value.size());
+                return value;
+            }
+
+            hoNDArray<std::complex<float>> read_matrix() {
+                auto channels = read<uint64_t>();
+                if (channels * channels * sizeof(std::complex<float>) > remaining())
+                    throw std::runtime_error("Noise covariance cache entry is truncated");
+
+                hoNDArray<std::complex<float>> matrix(channels, channels);
+                read_bytes(matrix.data(), matrix.get_number_of_bytes());
+                return matrix;
+            }
+
+            void read_bytes(void* destination, size_t bytes) {
+                if (bytes > remaining())
+                    throw std::runtime_error("Noise covariance cache entry is truncated");
+                std::memcpy(destination, static_cast<const char*>(region.get_address()) + position, bytes);
+                position += bytes;
+            }
+
+        private:
+            size_t remaining() const {
+                return region.get_size() - position;
+            }
+
+            bip::file_mapping mapping;
+            bip::mapped_region region;
+            size_t position = 0;
+        };
+
+        EntryHeader header_for(EntryKind kind, uint64_t source_time, uint64_t source_size) {
+            return EntryHeader{ entry_magic, entry_version, kind, source_time, source_size };
+        }
+
+        bool matches(const EntryHeader& header, const EntryHeader& expected) {
+            return header.magic == expected.magic && header.version == expected.version
+                   && header.kind == expected.kind && header.source_time == expected.source_time
+                   && header.source_size == expected.source_size;
+        }
+
+        Core::optional<EntryHeader> dependency_header(const bf::path& noise_dependency) {
+            boost::system::error_code error;
+            auto modified = bf::last_write_time(noise_dependency, error);
+            if (error)
+                return Core::none;
+            auto size = bf::file_size(noise_dependency, error);
+            if (error)
+                return Core::none;
+            return header_for(EntryKind::covariance, uint64_t(modified), uint64_t(size));
+        }
+
+        uint64_t key_of(const hoNDArray<std::complex<float>>& covariance) {
+            auto channels = uint64_t(covariance.get_size(0));
+            return fnv1a(covariance.data(), covariance.get_number_of_bytes(), fnv1a(&channels, sizeof(channels)));
+        }
+
+        bool same_matrix(const hoNDArray<std::complex<float>>& a, const hoNDArray<std::complex<float>>& b) {
+            return a.get_number_of_elements() == b.get_number_of_elements()
+                   && std::memcmp(a.data(), b.data(), a.get_number_of_bytes()) == 0;
+        }
+
+        // Unreadable entries are treated as missing; the cache must never fail a reconstruction.
+        template <class F> auto or_none(F&& f, const bf::path& entry) -> decltype(f()) {
+            try {
+                return f();
+            } catch (const std::exception& e) {
+                GDEBUG_STREAM("Noise covariance cache entry " << entry << " not used: " << e.what());
+                return Core::none;
+            }
+        }
+    }
+
+    NoiseCovarianceCache::NoiseCovarianceCache(bf::path folder, std::string prefix, size_t max_prewhiteners)
+        : folder(std::move(folder)), prefix(std::move(prefix)), max_prewhiteners(max_prewhiteners) {}
+
+    Core::optional<NoiseCovarianceCache::Covariance> NoiseCovarianceCache::load(
+        const bf::path& noise_dependency, const std::function<Core::optional<Covariance>()>& parse) const {
+
+        auto expected = dependency_header(noise_dependency);
+        if (!expected)
+            return Core::none;
+
+        auto entry = covariance_entry(noise_dependency);
+        auto cached = or_none(
+            [&]() -> Core::optional<Covariance> {
+                if (!bf::exists(entry))
+                    return Core::none;
+
+                EntryReader reader(entry);
+                if (!matches(reader.read<EntryHeader>(), *expected))
+                    return Core::none;
+
+                Covariance covariance;
+                covariance.noise_dwell_time_us = reader.read<float>();
+                if (reader.read<uint8_t>()) {
+                    std::vector<ISMRMRD::CoilLabel> labels(reader.read<uint32_t>());
+                    for (auto& label : labels) {
+                        label.coilNumber = reader.read<unsigned short>();
+                        label.coilName   = reader.read_string();
+                    }
+                    covariance.coil_labels = std::move(labels);
+                }
+                covariance.matrix = reader.read_matrix();
+                return covariance;
+            },
+            entry);
+
+        if (cached) {
+            GDEBUG_STREAM("Noise covariance loaded from cache entry " << entry);
+            return cached;
+        }
+
+        auto covariance = parse();
+        if (covariance)
+            store(noise_dependency, *covariance);
+        return covariance;
+    }
+
+    void NoiseCovarianceCache::store(const bf::path& noise_dependency, const Covariance& covariance) const {
+        auto header = dependency_header(noise_dependency);
+        if (!header)
+            return;
+
+        try {
+            EntryWriter writer;
+            writer.write(*header);
+            writer.write(covariance.noise_dwell_time_us);
+            writer.write(uint8_t(bool(covariance.coil_labels)));
+            if (covariance.coil_labels) {
+                writer.write(uint32_t(covariance.coil_labels->size()));
+                for (auto& label : *covariance.coil_labels) {
+                    writer.write(label.coilNumber);
+                    writer.write(label.coilName);
+                }
+            }
+            writer.write(covariance.matrix);
+            writer.commit(covariance_entry(noise_dependency));
+        } catch (const std::exception& e) {
+            GDEBUG_STREAM("Failed to cache noise covariance of " << noise_dependency << ": " << e.what());
+        }
+    }
+
+    hoNDArray<std::complex<float>> NoiseCovarianceCache::prewhitener(const hoNDArray<std::complex<float>>& covariance,
+        const std::function<hoNDArray<std::complex<float>>(const hoNDArray<std::complex<float>>&)>& compute) const {
+
+        if (!max_prewhiteners)
+            return compute(covariance);
+
+        auto key      = key_of(covariance);
+        auto entry    = prewhitener_entry(key);
+        auto expected = header_for(EntryKind::prewhitener, key, covariance.get_number_of_bytes());
+
+        auto cached = or_none(
+            [&]() -> Core::optional<hoNDArray<std::complex<float>>> {
+                if (!bf::exists(entry))
+                    return Core::none;
+
+                EntryReader reader(entry);
+                if (!matches(reader.read<EntryHeader>(), expected))
+                    return Core::none;
+
+                // The covariance is stored with the prewhitener, so a hash collision can never go unnoticed.
+                if (!same_matrix(reader.read_matrix(), covariance))
+                    return Core::none;
+                return reader.read_matrix();
+            },
+            entry);
+
+        if (cached) {
+            GDEBUG_STREAM("Noise prewhitener loaded from cache entry " << entry);
+
+            // Eviction goes by modification time, which makes it least recently used.
+            boost::system::error_code ignored;
+            bf::last_write_time(entry, std::time(nullptr), ignored);
+            return std::move(*cached);
+        }
+
+        auto prewhitener = compute(covariance);
+
+        try {
+            EntryWriter writer;
+            writer.write(expected);
+            writer.write(covariance);
+            writer.write(prewhitener);
+            writer.commit(entry);
+            evict_prewhiteners(entry);
+        } catch (const std::exception& e) {
+            GDEBUG_STREAM("Failed to cache noise prewhitener: " << e.what());
+        }
+
+        return prewhitener;
+    }
+
+    bf::path NoiseCovarianceCache::covariance_entry(const bf::path& noise_dependency) const {
+        auto entry = noise_dependency;
+        entry += ".cache";
+        return entry;
+    }
+
+    // Other processes may be evicting at the same time; entries already gone are simply skipped.
+    void NoiseCovarianceCache::evict_prewhiteners(const bf::path& keep) const {
+        auto pattern = prefix + "_prewhitener_";
+
+        std::vector<std::pair<std::time_t, bf::path>> entries;
+        boost::system::error_code error;
+        for (bf::directory_iterator it(folder, error), end; !error && it != end; it.increment(error)) {
+            auto name = it->path().filename().string();
+            if (name.compare(0, pattern.size(), pattern) != 0 || it->path().extension() != ".cache" || it->path() == keep)
+                continue;
+
+            boost::system::error_code ignored;
+            auto modified = bf::last_write_time(it->path(), ignored);
+            if (!ignored)
+                entries.emplace_back(modified, it->path());
+        }
+
+        if (entries.size() < max_prewhiteners)
+            return;
+
+        std::sort(entries.begin(), entries.end());
+        for (size_t i = 0; i + max_prewhiteners <= entries.size(); i++) {
+            boost::system::error_code ignored;
+            bf::remove(entries[i].second, ignored);
+            GDEBUG_STREAM("Evicted noise prewhitener cache entry " << entries[i].second);
+        }
+    }
+
+    bf::path NoiseCovarianceCache::prewhitener_entry(uint64_t key) const {
+        std::stringstream name;
+        name << prefix << "_prewhitener_" << std::hex << std::setw(16) << std::setfill('0') << key << ".cache";
+        return folder / name.str();
+    }
+}
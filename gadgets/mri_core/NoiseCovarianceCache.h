@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Types.h"
+#include "gadgetron_mricore_export.h"
+#include "hoNDArray.h"
+
+#include <boost/filesystem/path.hpp>
+#include <complex>
+#include <functional>
+#include <ismrmrd/xml.h>
+#include <vector>
+
+namespace Gadgetron {
+
+    /**
+     * Cache of noise covariances and prewhitening matrices, shared by every connection on the machine.
+     *
+     * Entries are flat binary files kept alongside the noise dependencies and read through memory mapping. They
+     * are written to a temporary file which is then renamed into place, so concurrent connections, in this
+     * process or others, only ever see complete entries.
+     *
+     * Covariances are keyed by their noise dependency file, and are refreshed when it changes. Prewhiteners are
+     * keyed by a hash of the covariance matrix they were computed from, which captures the coil configuration and
+     * any channel reordering or masking applied to it; the Cholesky decomposition is then done once per matrix.
+     * The dwell time dependent scaling is left to the caller.
+     *
+     * At most max_prewhiteners prewhiteners are kept on disk; the least recently used are removed as new ones are
+     * added. With max_prewhiteners 0, prewhiteners are not written to disk at all.
+     */
+    class EXPORTGADGETSMRICORE NoiseCovarianceCache {
+    public:
+        struct Covariance {
+            Core::optional<std::vector<ISMRMRD::CoilLabel>> coil_labels;
+            float noise_dwell_time_us;
+            hoNDArray<std::complex<float>> matrix;
+        };
+
+        static constexpr size_t default_max_prewhiteners = 64;
+
+        NoiseCovarianceCache(boost::filesystem::path folder, std::string prefix,
+            size_t max_prewhiteners = default_max_prewhiteners);
+
+        /// Loads the covariance of a noise dependency, calling parse to read the dependency if the cache is stale.
+        Core::optional<Covariance> load(
+            const boost::filesystem::path& noise_dependency,
+            const std::function<Core::optional<Covariance>()>& parse) const;
+
+        /// Records the covariance of a noise dependency which has just been written.
+        void store(const boost::filesystem::path& noise_dependency, const Covariance& covariance) const;
+
+        /// The prewhitener for a covariance matrix, calling compute only if it is not in the cache.
+        hoNDArray<std::complex<float>> prewhitener(const hoNDArray<std::complex<float>>& covariance,
+            const std::function<hoNDArray<std::complex<float>>(const hoNDArray<std::complex<float>>&)>& compute) const;
+
+    private:
+        boost::filesystem::path covariance_entry(const boost::filesystem::path& noise_dependency) const;
+        boost::filesystem::path prewhitener_entry(uint64_t key) const;
+        void evict_prewhiteners(const boost::filesystem::path& keep) const;
+
+        const boost::filesystem::path folder;
+        const std::string prefix;
+        const size_t max_prewhiteners;
+    };
+}
@@ -18,6 +18,8 @@ namespace Gadgetron{
         RemoveROOversamplingGadget();
         virtual ~RemoveROOversamplingGadget();
 
+        bool lightweight() const override { return true; }
+
     protected:
 
         virtual int process_config(ACE_Message_Block* mb);
@@ -9,43 +9,20 @@
 
 namespace Gadgetron {
 
-    Core::Message GadgetIsmrmrdAcquisitionMessageReader::read(std::istream &stream) {
-
+    namespace {
 
         using namespace Core;
-        using namespace std::literals;
-
-        auto header = IO::read<ISMRMRD::AcquisitionHeader>(stream);
-
-
-
-        optional<hoNDArray<float>> trajectory = boost::none;
-        if (header.trajectory_dimensions) {
-            trajectory = hoNDArray<float>(header.trajectory_dimensions,
-                                               header.number_of_samples);
-            IO::read(stream, trajectory->data(),trajectory->size());
-        }
-        auto data = hoNDArray<std::complex<float>>(header.number_of_samples,
-                                                   header.active_channels);
-
 
-        if (header.isFlagSet(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1)) { //Is this ZFP compressed data
+        void decompress_zfp(ISMRMRD::AcquisitionHeader &header, std::vector<char> &comp_buffer,
+                            hoNDArray<std::complex<float>> &data) {
 
 #if defined GADGETRON_COMPRESSION_ZFP
 
-            uint32_t comp_size = IO::read<uint32_t>(stream);
-
-            std::vector<char> comp_buffer(comp_size);
-
-            stream.read(comp_buffer.data(), comp_size);
-
             zfp_type type = zfp_type_float;
             auto field = std::unique_ptr<zfp_field, decltype(&zfp_field_free)>(zfp_field_alloc(), &zfp_field_free);
 
             auto zfp = std::unique_ptr<zfp_stream, decltype(&zfp_stream_close)>(zfp_stream_open(NULL),
                                                                                 &zfp_stream_close);
-            size_t zfpsize = comp_size;
-
 
             auto cstream = std::unique_ptr<bitstream, decltype(&stream_close)>(
                     stream_open(comp_buffer.data(), comp_buffer.size()), &stream_close);
@@ -83,7 +60,6 @@ namespace Gadgetron {
                 throw std::runtime_error("Unable to decompress stream");
             }
 
-
             //At this point the data is no longer compressed and we should clear the flag
             header.clearFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
 
@@ -93,39 +69,84 @@ namespace Gadgetron {
             throw std::runtime_error("Receiving compressed (ZFP) data, but Gadgetron was not compiled with ZFP support");
 
 #endif //GADGETRON_COMPRESSION_ZFP
+        }
 
-        } else if (header.isFlagSet(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2)) {
-            //NHLBI Compression
-            uint32_t comp_size = IO::read<uint32_t>(stream);
-
-            std::vector<uint8_t> comp_buffer(comp_size);
-            stream.read((char *) comp_buffer.data(), comp_size);
+        void decompress_nhlbi(ISMRMRD::AcquisitionHeader &header, std::vector<char> &comp_buffer,
+                              hoNDArray<std::complex<float>> &data) {
 
             CompressedBuffer<float> comp;
-            comp.deserialize(comp_buffer);
+            comp.deserialize(reinterpret_cast<const uint8_t *>(comp_buffer.data()), comp_buffer.size());
 
             if (comp.size() != data.get_number_of_elements() * 2) { //*2 for complex
                 std::stringstream error;
                 error << "Mismatch between uncompressed data samples " << comp.size();
                 error << " and expected number of samples" << data.get_number_of_elements() * 2;
+                throw std::runtime_error(error.str());
             }
 
-            float *d_ptr = (float *) data.get_data_ptr();
-            for (size_t i = 0; i < comp.size(); i++) {
-                d_ptr[i] = comp[i]; //This uncompresses sample by sample into the uncompressed array
-            }
+            comp.decompress(reinterpret_cast<float *>(data.get_data_ptr()));
 
             //At this point the data is no longer compressed and we should clear the flag
             header.clearFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
+        }
+    }
 
-        } else {
-            //Uncompressed data
-            IO::read(stream, data.data(),data.size());
+    Core::Message GadgetIsmrmrdAcquisitionMessageReader::read(std::istream &stream) {
+
+        auto pending = read_pending(stream);
+        if (auto message = Core::get_if<Core::Message>(&pending)) return std::move(*message);
+
+        auto &decompress = Core::get<std::packaged_task<Core::Message()>>(pending);
+        auto message = decompress.get_future();
+        decompress();
+        return message.get();
+    }
+
+    Core::Reader::PendingMessage GadgetIsmrmrdAcquisitionMessageReader::read_pending(std::istream &stream) {
+
+        using namespace Core;
+        using namespace std::literals;
+
+        auto header = IO::read<ISMRMRD::AcquisitionHeader>(stream);
 
+        optional<hoNDArray<float>> trajectory = boost::none;
+        if (header.trajectory_dimensions) {
+            trajectory = hoNDArray<float>(header.trajectory_dimensions,
+                                               header.number_of_samples);
+            IO::read_payload(stream, *trajectory);
+        }
+
+        using Decompressor = void (*)(ISMRMRD::AcquisitionHeader &, std::vector<char> &, hoNDArray<std::complex<float>> &);
+        Decompressor decompressor = nullptr;
+
+        if (header.isFlagSet(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1)) { //Is this ZFP compressed data
+            decompressor = decompress_zfp;
+        } else if (header.isFlagSet(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2)) { //NHLBI Compression
+            decompressor = decompress_nhlbi;
+        }
+
+        if (!decompressor) {
+            //Uncompressed data
+            auto data = hoNDArray<std::complex<float>>(header.number_of_samples,
+                                                       header.active_channels);
+            IO::read_payload(stream, data);
+            return Core::Message(std::move(header),std::move(data),std::move(trajectory));
         }
 
-        return Core::Message(std::move(header),std::move(data),std::move(trajectory));
+        // Only the compressed bytes are read here; decompression may happen on another thread.
+        uint32_t comp_size = IO::read<uint32_t>(stream);
+
+        std::vector<char> comp_buffer(comp_size);
+        stream.read(comp_buffer.data(), comp_size);
 
+        return std::packaged_task<Core::Message()>(
+                [=, comp_buffer = std::move(comp_buffer), trajectory = std::move(trajectory)]() mutable {
+                    auto data = hoNDArray<std::complex<float>>(header.number_of_samples,
+                                                               header.active_channels);
+                    decompressor(header, comp_buffer, data);
+                    return Core::Message(std::move(header), std::move(data), std::move(trajectory));
+                }
+        );
     }
 
     uint16_t GadgetIsmrmrdAcquisitionMessageReader::slot() {
@@ -141,7 +162,7 @@ namespace Gadgetron {
 
         auto data = hoNDArray<uint32_t>(header.number_of_samples, header.channels);
 
-        IO::read(stream, data.data(),data.size());
+        IO::read_payload(stream, data);
 
         return Message(std::move(header), std::move(data));
     }
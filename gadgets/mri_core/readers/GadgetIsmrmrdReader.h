@@ -23,6 +23,8 @@ class EXPORTGADGETSMRICORE GadgetIsmrmrdAcquisitionMessageReader : public Core::
 
         Core::Message read(std::istream& stream) final;
 
+        /// Compressed acquisitions are decompressed by the returned task.
+        PendingMessage read_pending(std::istream& stream) final;
 
         uint16_t slot() final;
         ~GadgetIsmrmrdAcquisitionMessageReader() final = default;
@@ -17,7 +17,7 @@ namespace Gadgetron {
                                                         header.matrix_size[2], header.channels);
 
 
-            IO::read(stream, array.data(),array.size());
+            IO::read_payload(stream, array);
 
             return Core::Message(std::move(header), std::move(array), std::move(meta));
 
@@ -0,0 +1,124 @@
+"""
+Array payloads in shared memory, for external modules running on the same host as the Gadgetron.
+
+Modules started from an <execute type="python" ... shared_memory="true"/> node run with GADGETRON_SHARED_MEMORY=1
+set. On their connection, the payload of every array is then preceded by a byte: 0 means the payload follows inline,
+1 means it is in a named shared memory segment, whose name follows as a string with a uint16 length. See
+core/io/shared_memory.h. This covers the data and trajectory of acquisitions, the data of images and waveforms, and
+the arrays of buffers and image arrays; the payload comes after the message header, or after the dimensions for
+arrays that carry their own. Compressed acquisition data is always sent inline.
+
+Arrays received in shared memory are returned as NumPy views of the segment, with no copy. The segment is removed
+from /dev/shm as soon as it is mapped; its memory is released when the last view of it goes away.
+"""
+
+import atexit
+import itertools
+import mmap
+import os
+import struct
+
+import numpy as np
+
+INLINE = 0
+SHARED_MEMORY = 1
+
+# Arrays of at least this many bytes are placed in shared memory; matches default_shared_memory_threshold.
+THRESHOLD = 64 * 1024
+
+_segment_directory = '/dev/shm'
+_segment_counter = itertools.count()
+
+# Segments written by this module; the Gadgetron removes them as it reads them, the rest are removed on exit.
+_written_segments = []
+_prune_at = 64
+
+
+def enabled():
+    return os.environ.get('GADGETRON_SHARED_MEMORY') == '1'
+
+
+def _read_exactly(stream, size):
+    data = stream.read(size)
+    if len(data) != size:
+        raise EOFError("Connection closed while reading an array payload")
+    return data
+
+
+def read_payload(stream, dimensions, dtype):
+    """Reads the payload of an array with Gadgetron dimensions (fastest varying first) as a Fortran ordered array."""
+    dtype = np.dtype(dtype)
+    size = int(np.prod(dimensions)) * dtype.itemsize
+
+    location, = struct.unpack('<B', _read_exactly(stream, 1))
+
+    if location == INLINE:
+        buffer = bytearray(_read_exactly(stream, size))
+        return np.ndarray(dimensions, dtype=dtype, buffer=buffer, order='F')
+
+    if location != SHARED_MEMORY:
+        raise ValueError("Unknown array payload location: {}".format(location))
+
+    length, = struct.unpack('<H', _read_exactly(stream, 2))
+    path = os.path.join(_segment_directory, _read_exactly(stream, length).decode())
+
+    descriptor = os.open(path, os.O_RDWR)
+    try:
+        # A shared, writable mapping; nobody else has the segment once it is unlinked, so the view may be modified.
+        segment = mmap.mmap(descriptor, size, access=mmap.ACCESS_WRITE)
+    finally:
+        os.close(descriptor)
+        os.unlink(path)
+
+    return np.ndarray(dimensions, dtype=dtype, buffer=segment, order='F')
+
+
+def write_payload(stream, array):
+    """Writes the payload of an array, in Fortran order; the dimensions are written by the caller."""
+    array = np.asfortranarray(array)
+
+    if array.nbytes < THRESHOLD or array.nbytes == 0:
+        stream.write(struct.pack('<B', INLINE))
+        stream.write(array.tobytes(order='F'))
+        return
+
+    name = 'gadgetron-python-{}-{}'.format(os.getpid(), next(_segment_counter))
+    path = os.path.join(_segment_directory, name)
+
+    descriptor = os.open(path, os.O_RDWR | os.O_CREAT | os.O_EXCL, 0o600)
+    try:
+        os.ftruncate(descriptor, array.nbytes)
+        with mmap.mmap(descriptor, array.nbytes, access=mmap.ACCESS_WRITE) as segment:
+            np.ndarray(array.shape, dtype=array.dtype, buffer=segment, order='F')[...] = array
+    except BaseException:
+        os.unlink(path)
+        raise
+    finally:
+        os.close(descriptor)
+
+    _remember(path)
+
+    encoded = name.encode()
+    stream.write(struct.pack('<BH', SHARED_MEMORY, len(encoded)))
+    stream.write(encoded)
+
+
+def _remember(path):
+    global _prune_at
+    _written_segments.append(path)
+
+    if len(_written_segments) < _prune_at:
+        return
+    _written_segments[:] = [p for p in _written_segments if os.path.exists(p)]
+    _prune_at = max(64, 2 * len(_written_segments))
+
+
+@atexit.register
+def cleanup():
+    """Removes the segments this module wrote that the Gadgetron never got to read."""
+    for path in _written_segments:
+        try:
+            os.unlink(path)
+        except FileNotFoundError:
+            pass
+    _written_segments.clear()
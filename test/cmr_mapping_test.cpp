@@ -3,6 +3,7 @@
 #include "hoNDArray_reductions.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNFFT.h"
+#include "cmr_t1_mapping.h"
 #include "cmr_t2_mapping.h"
 #include "ImageIOAnalyze.h"
 #include "GadgetronTimer.h"
@@ -122,3 +123,88 @@ TYPED_TEST(cmr_mapping_test, T2Mapping)
     norm_ref = Gadgetron::nrm2(ref);
     EXPECT_LE(v / norm_ref, 0.002);
 }
+
+TYPED_TEST(cmr_mapping_test, LevenbergMarquardtBatchFit)
+{
+    typedef float T;
+
+    const size_t L = cmr_fitting_lanes;
+
+    std::vector<T> ti = { 100, 300, 600, 1000, 1500, 2500, 10000 };
+    std::vector<T> te = { 0, 25, 55 };
+
+    std::vector<T> y1(ti.size()*L), y2(te.size()*L);
+    std::vector<T> p1(2 * L), p2(2 * L);
+
+    for (size_t l = 0; l < L; l++)
+    {
+        T A = 500 + 20 * l;
+        T T1 = 800 + 50 * l;
+        T T2 = 30 + 3 * l;
+
+        for (size_t n = 0; n < ti.size(); n++) y1[n*L + l] = A * (1 - std::exp(-ti[n] / T1));
+        for (size_t n = 0; n < te.size(); n++) y2[n*L + l] = A * std::exp(-te[n] / T2);
+
+        // start well away from the solution
+        p1[l] = 400; p1[L + l] = 1200;
+        p2[l] = 400; p2[L + l] = 60;
+    }
+
+    Gadgetron::levenberg_marquardt_fit<CmrT1SRModel>(&ti[0], ti.size(), &y1[0], &p1[0], &p1[L], 150, T(1e-8));
+    Gadgetron::levenberg_marquardt_fit<CmrT2Model>(&te[0], te.size(), &y2[0], &p2[0], &p2[L], 150, T(1e-8));
+
+    for (size_t l = 0; l < L; l++)
+    {
+        EXPECT_NEAR(p1[l], 500 + 20 * l, 0.5);
+        EXPECT_NEAR(p1[L + l], 800 + 50 * l, 1.0);
+        EXPECT_NEAR(p2[l], 500 + 20 * l, 0.5);
+        EXPECT_NEAR(p2[L + l], 30 + 3 * l, 0.05);
+    }
+}
+
+TYPED_TEST(cmr_mapping_test, T2MappingLevenbergMarquardt)
+{
+    typedef float T;
+
+    size_t RO = 32, E1 = 24, N = 3;
+
+    CmrT2Mapping<T> t2mapper;
+    t2mapper.ti_ = { 0, 25, 55 };
+    t2mapper.use_levenberg_marquardt_ = true;
+    t2mapper.fill_holes_in_maps_ = false;
+
+    t2mapper.data_.create(RO, E1, N, 1, 1);
+    t2mapper.mask_for_mapping_.create(RO, E1, 1);
+    Gadgetron::clear(t2mapper.mask_for_mapping_);
+
+    for (size_t e1 = 0; e1 < E1; e1++)
+    {
+        for (size_t ro = 0; ro < RO; ro++)
+        {
+            T A = 300 + ro;
+            T T2 = 30 + e1;
+            for (size_t n = 0; n < N; n++) t2mapper.data_(ro, e1, n, 0, 0) = A * std::exp(-t2mapper.ti_[n] / T2);
+
+            // an irregular mask, so some batches are partly filled
+            if ((ro * 7 + e1 * 3) % 5 != 0) t2mapper.mask_for_mapping_(ro, e1, 0) = 1;
+        }
+    }
+
+    t2mapper.perform_parametric_mapping();
+
+    for (size_t e1 = 0; e1 < E1; e1++)
+    {
+        for (size_t ro = 0; ro < RO; ro++)
+        {
+            if (t2mapper.mask_for_mapping_(ro, e1, 0) > 0)
+            {
+                EXPECT_NEAR(t2mapper.map_(ro, e1, 0, 0), 30 + e1, 0.1);
+                EXPECT_NEAR(t2mapper.para_(ro, e1, 0, 0, 0), 300 + ro, 0.5);
+            }
+            else
+            {
+                EXPECT_EQ(t2mapper.map_(ro, e1, 0, 0), 0);
+            }
+        }
+    }
+}
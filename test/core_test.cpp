@@ -3,6 +3,7 @@
 #include "Message.h"
 #include "Channel.h"
 #include "Types.h"
+#include "mri_core_data.h"
 
 TEST(TypeTests, multitype) {
     using namespace Gadgetron::Core;
@@ -227,3 +228,48 @@ TEST(TypeTests, tupletype3) {
 }
 
 
+
+TEST(TypeTests, trypopbeforebypass) {
+    using namespace Gadgetron::Core;
+    auto channel = make_channel<MessageChannel>();
+    auto bypass  = make_channel<MessageChannel>();
+
+    channel.output.push(int(1));
+    channel.output.push(std::string("other"));
+    channel.output.push(int(2));
+
+    InputChannel<int> input(channel.input, bypass.output);
+    std::vector<int> held;
+
+    auto first = input.try_pop([&]() { bypass.output.push(int(held.size())); });
+    ASSERT_TRUE(first);
+    held.push_back(*first);
+
+    auto second = input.try_pop([&]() { bypass.output.push(int(held.size())); });
+    ASSERT_TRUE(second);
+    EXPECT_EQ(*second, 2);
+
+    EXPECT_EQ(force_unpack<int>(bypass.input.pop()), 1);
+    EXPECT_EQ(force_unpack<std::string>(bypass.input.pop()), "other");
+}
+
+TEST(TypeTests, payloadbytesofbuffers) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    IsmrmrdReconData recon_data;
+    recon_data.rbit_.resize(2);
+    recon_data.rbit_[0].data_.data_ = hoNDArray<std::complex<float>>(64, 32);
+    recon_data.rbit_[1].data_.data_ = hoNDArray<std::complex<float>>(64, 16);
+    recon_data.rbit_[1].ref_        = IsmrmrdDataBuffered();
+    recon_data.rbit_[1].ref_->data_ = hoNDArray<std::complex<float>>(64, 8);
+
+    auto buffered = sizeof(SamplingDescription);
+    EXPECT_EQ(Message(recon_data).bytes(), (64 * 56) * sizeof(std::complex<float>) + 3 * buffered);
+
+    IsmrmrdImageArray image_array;
+    image_array.data_    = hoNDArray<std::complex<float>>(128, 128);
+    image_array.headers_ = hoNDArray<ISMRMRD::ImageHeader>(1);
+
+    EXPECT_EQ(payload_bytes(image_array), 128 * 128 * sizeof(std::complex<float>) + sizeof(ISMRMRD::ImageHeader));
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+
+#include "hoNDArray.h"
+#include "hoNDArray_allocator.h"
+
+using namespace Gadgetron;
+
+namespace {
+    bool is_aligned(const void* data) {
+        return reinterpret_cast<uintptr_t>(data) % hoNDArrayAllocator::alignment == 0;
+    }
+}
+
+TEST(hoNDArrayAllocatorTest, Alignment) {
+    for (auto allocator : { &hoNDArrayAllocator::system(), &hoNDArrayAllocator::pool() }) {
+        for (size_t bytes : { 1, 17, 1000, 4096, 1 << 20, 100 << 20 }) {
+            auto data = allocator->allocate(bytes);
+            ASSERT_NE(data, nullptr);
+            EXPECT_TRUE(is_aligned(data));
+            memset(data, 0xFF, bytes);
+            hoNDArrayAllocator::release(data);
+        }
+    }
+}
+
+TEST(hoNDArrayAllocatorTest, PoolReusesMemory) {
+    auto& pool = hoNDArrayAllocator::pool();
+    auto before = pool.statistics();
+
+    auto first = pool.allocate(128 * 32 * 8);
+    hoNDArrayAllocator::release(first);
+    auto second = pool.allocate(128 * 32 * 8);
+    EXPECT_EQ(first, second);
+    hoNDArrayAllocator::release(second);
+
+    auto after = pool.statistics();
+    EXPECT_GE(after.hits, before.hits + 1);
+    EXPECT_EQ(after.bytes_live, before.bytes_live);
+    EXPECT_GE(after.high_water_mark, 128u * 32u * 8u);
+}
+
+TEST(hoNDArrayAllocatorTest, ReleasesAcrossThreads) {
+    auto& pool = hoNDArrayAllocator::pool();
+    auto before = pool.statistics().bytes_live;
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 100; i++) blocks.push_back(pool.allocate(1024 * (i + 1)));
+
+    std::thread releaser([&]() { for (auto block : blocks) hoNDArrayAllocator::release(block); });
+    releaser.join();
+
+    EXPECT_EQ(pool.statistics().bytes_live, before);
+}
+
+TEST(hoNDArrayAllocatorTest, OwnershipTransfer) {
+    auto data = static_cast<float*>(hoNDArrayAllocator::current().allocate(100 * sizeof(float)));
+    hoNDArray<float> array(100, data, true);
+    array.fill(1.0f);
+}
+
+TEST(hoNDArrayAllocatorTest, ArraysUseSelectedAllocator) {
+    auto& previous = hoNDArrayAllocator::current();
+    hoNDArrayAllocator::select(hoNDArrayAllocator::pool());
+    auto live = hoNDArrayAllocator::pool().statistics().bytes_live;
+    {
+        hoNDArray<std::complex<float>> array(128, 32);
+        EXPECT_TRUE(is_aligned(array.data()));
+        EXPECT_GT(hoNDArrayAllocator::pool().statistics().bytes_live, live);
+        hoNDArrayAllocator::select(previous);
+    }
+    EXPECT_EQ(hoNDArrayAllocator::pool().statistics().bytes_live, live);
+}
+
+TEST(hoNDArrayAllocatorTest, ReleasesForeignMemory) {
+    auto live = hoNDArrayAllocator::pool().statistics().bytes_live;
+    {
+        hoNDArray<float> array(100, static_cast<float*>(malloc(100 * sizeof(float))), true);
+        array.fill(1.0f);
+    }
+    EXPECT_EQ(hoNDArrayAllocator::pool().statistics().bytes_live, live);
+}
+
+TEST(hoNDArrayAllocatorTest, ThreadCacheCountsAsRetained) {
+    auto& pool = hoNDArrayAllocator::pool();
+
+    auto data     = pool.allocate(3000);
+    auto retained = pool.statistics().bytes_retained;
+    hoNDArrayAllocator::release(data);
+    EXPECT_GT(pool.statistics().bytes_retained, retained);
+
+    EXPECT_EQ(hoNDArrayAllocator::system().statistics().bytes_retained, 0u);
+}
+
+#if !defined(_WIN32)
+TEST(hoNDArrayAllocatorTest, SystemBlocksArePlainMemory) {
+    auto& system = hoNDArrayAllocator::system();
+    auto live    = system.statistics().bytes_live;
+
+    auto data = system.allocate(1000);
+    ASSERT_NE(data, nullptr);
+    EXPECT_TRUE(is_aligned(data));
+    EXPECT_EQ(system.statistics().bytes_live, live);
+    free(data);
+}
+#endif
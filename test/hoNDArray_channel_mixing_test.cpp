@@ -0,0 +1,129 @@
+#include "hoNDArray_channel_mixing.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    hoNDArray<std::complex<float>> random_array(size_t rows, size_t columns, std::mt19937& generator) {
+        std::normal_distribution<float> distribution;
+        hoNDArray<std::complex<float>> array(rows, columns);
+        for (auto& value : array)
+            value = std::complex<float>(distribution(generator), distribution(generator));
+        return array;
+    }
+
+    hoNDArray<std::complex<float>> reference_mix(
+        const hoNDArray<std::complex<float>>& input, const hoNDArray<std::complex<float>>& mixing) {
+        auto samples = input.get_size(0), channels_in = mixing.get_size(0), channels_out = mixing.get_size(1);
+
+        hoNDArray<std::complex<float>> output(samples, channels_out);
+        for (size_t o = 0; o < channels_out; o++) {
+            for (size_t s = 0; s < samples; s++) {
+                std::complex<double> sum = 0;
+                for (size_t c = 0; c < channels_in; c++)
+                    sum += std::complex<double>(input(s, c)) * std::complex<double>(mixing(c, o));
+                output(s, o) = std::complex<float>(sum);
+            }
+        }
+        return output;
+    }
+
+    void expect_near(const hoNDArray<std::complex<float>>& expected, const hoNDArray<std::complex<float>>& actual) {
+        ASSERT_EQ(expected.get_number_of_elements(), actual.get_number_of_elements());
+        for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+            EXPECT_LT(std::abs(expected[i] - actual[i]), 1e-4f * (1.0f + std::abs(expected[i])));
+    }
+}
+
+TEST(ChannelMixing, AllSupportedKernelsMatchReference) {
+    std::mt19937 generator(42);
+
+    // Sample counts which leave every possible remainder for the vector kernels.
+    for (size_t samples : { 1, 7, 16, 131 }) {
+        for (size_t channels_in : { 1, 5, 32 }) {
+            for (size_t channels_out : { 1, 9, 32 }) {
+                auto input    = random_array(samples, channels_in, generator);
+                auto mixing   = random_array(channels_in, channels_out, generator);
+                auto expected = reference_mix(input, mixing);
+
+                for (auto kernel :
+                    { ChannelMixingKernel::scalar, ChannelMixingKernel::avx2, ChannelMixingKernel::avx512 }) {
+                    if (!is_supported(kernel))
+                        continue;
+
+                    hoNDArray<std::complex<float>> output(samples, channels_out);
+                    mix_channels(
+                        input.data(), output.data(), samples, channels_in, channels_out, mixing.data(), kernel);
+                    expect_near(expected, output);
+                }
+            }
+        }
+    }
+}
+
+TEST(ChannelMixing, BatchMixesReadoutsInPlace) {
+    std::mt19937 generator(7);
+
+    auto mixing      = random_array(8, 8, generator);
+    auto compression = random_array(8, 3, generator);
+
+    std::vector<hoNDArray<std::complex<float>>> readouts, expected, compressed;
+    for (size_t samples : { 64, 65, 128 }) {
+        readouts.push_back(random_array(samples, 8, generator));
+        expected.push_back(reference_mix(readouts.back(), mixing));
+        compressed.push_back(reference_mix(expected.back(), compression));
+    }
+
+    std::vector<hoNDArray<std::complex<float>>*> batch;
+    for (auto& readout : readouts)
+        batch.push_back(&readout);
+
+    mix_channels(mixing, batch);
+    for (size_t i = 0; i < readouts.size(); i++)
+        expect_near(expected[i], readouts[i]);
+
+    mix_channels(compression, batch);
+    for (size_t i = 0; i < readouts.size(); i++) {
+        EXPECT_EQ(readouts[i].get_size(1), 3u);
+        expect_near(compressed[i], readouts[i]);
+    }
+}
+
+TEST(ChannelMixing, BatchRejectsMismatchedChannels) {
+    std::mt19937 generator(3);
+
+    auto mixing  = random_array(8, 8, generator);
+    auto readout = random_array(32, 4, generator);
+    EXPECT_THROW(mix_channels(mixing, { &readout }), std::runtime_error);
+}
+
+TEST(ChannelMixing, CombinationKernelsMatchReference) {
+    std::mt19937 generator(11);
+
+    // Pixel counts covering vector remainders and more than one tile.
+    for (size_t pixels : { 1, 13, 512, 1100 }) {
+        for (size_t channels : { 1, 4, 33 }) {
+            auto weights = random_array(pixels, channels, generator);
+            auto images  = random_array(pixels, channels, generator);
+
+            hoNDArray<std::complex<float>> expected(pixels);
+            for (size_t p = 0; p < pixels; p++) {
+                std::complex<double> sum = 0;
+                for (size_t c = 0; c < channels; c++)
+                    sum += std::complex<double>(weights(p, c)) * std::complex<double>(images(p, c));
+                expected[p] = std::complex<float>(0.5 * sum);
+            }
+
+            for (auto kernel : { ChannelMixingKernel::scalar, ChannelMixingKernel::avx2, ChannelMixingKernel::avx512 }) {
+                if (!is_supported(kernel))
+                    continue;
+
+                hoNDArray<std::complex<float>> output(pixels);
+                combine_channels(weights.data(), images.data(), output.data(), pixels, channels, 0.5f, kernel);
+                expect_near(expected, output);
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+#include "hoNDArray_expressions.h"
+
+using namespace Gadgetron;
+
+namespace {
+    using complex_float = std::complex<float>;
+
+    hoNDArray<complex_float> random_array(size_t x, size_t y, unsigned int seed) {
+        std::mt19937 generator(seed);
+        std::normal_distribution<float> distribution(0.0f, 1.0f);
+
+        hoNDArray<complex_float> array(x, y);
+        for (auto& value : array) value = complex_float(distribution(generator), distribution(generator));
+        return array;
+    }
+
+    void expect_near(const complex_float& a, const complex_float& b) {
+        EXPECT_NEAR(a.real(), b.real(), 1e-5f);
+        EXPECT_NEAR(a.imag(), b.imag(), 1e-5f);
+    }
+}
+
+TEST(hoNDArrayExpressionsTest, FusedMultiplyAdd) {
+    auto a = random_array(300, 500, 1), b = random_array(300, 500, 2);
+    auto c = random_array(300, 500, 3), d = random_array(300, 500, 4);
+
+    hoNDArray<complex_float> r = a * b + c * conj(d);
+
+    ASSERT_EQ(r.get_size(0), 300);
+    ASSERT_EQ(r.get_size(1), 500);
+    for (size_t i = 0; i < r.get_number_of_elements(); i++) expect_near(r[i], a[i] * b[i] + c[i] * std::conj(d[i]));
+}
+
+TEST(hoNDArrayExpressionsTest, ScalarsAndUnaryOperations) {
+    auto a = random_array(64, 3, 5), b = random_array(64, 3, 6);
+
+    hoNDArray<complex_float> r;
+    r = -(a - 2.0f * b) / complex_float(0.0f, 2.0f) + 1.0f;
+    for (size_t i = 0; i < r.get_number_of_elements(); i++)
+        expect_near(r[i], -(a[i] - 2.0f * b[i]) / complex_float(0.0f, 2.0f) + 1.0f);
+
+    hoNDArray<float> magnitude = abs(a * b);
+    hoNDArray<float> power     = abs_square(a) + real(a * 1.0f) - imag(b * 1.0f);
+    for (size_t i = 0; i < a.get_number_of_elements(); i++) {
+        EXPECT_NEAR(magnitude[i], std::abs(a[i] * b[i]), 1e-5f);
+        EXPECT_NEAR(power[i], std::norm(a[i]) + a[i].real() - b[i].imag(), 1e-5f);
+    }
+}
+
+TEST(hoNDArrayExpressionsTest, RealArraysIntoComplex) {
+    hoNDArray<float> x(100), y(100);
+    for (size_t i = 0; i < x.get_number_of_elements(); i++) {
+        x[i] = float(i);
+        y[i] = 4.0f;
+    }
+
+    hoNDArray<float> root = sqrt(x * y);
+    EXPECT_FLOAT_EQ(root[25], 10.0f);
+
+    hoNDArray<complex_float> complex = x + y;
+    EXPECT_EQ(complex[3], complex_float(7.0f, 0.0f));
+}
+
+TEST(hoNDArrayExpressionsTest, ResultAmongOperands) {
+    auto a = random_array(128, 128, 7), b = random_array(128, 128, 8);
+    auto expected = a;
+
+    a = a * b + a;
+    for (size_t i = 0; i < a.get_number_of_elements(); i++) expect_near(a[i], expected[i] * b[i] + expected[i]);
+
+    a -= conj(b) * 2.0f;
+    for (size_t i = 0; i < a.get_number_of_elements(); i++)
+        expect_near(a[i], expected[i] * b[i] + expected[i] - std::conj(b[i]) * 2.0f);
+}
+
+TEST(hoNDArrayExpressionsTest, SharedResultIsDetached) {
+    auto a = random_array(32, 32, 9);
+    a.share();
+    hoNDArray<complex_float> copy = a;
+
+    copy = copy * 2.0f;
+    EXPECT_EQ(a[10] * 2.0f, copy[10]);
+}
+
+TEST(hoNDArrayExpressionsTest, TemporariesAreKept) {
+    auto a = random_array(16, 16, 10);
+
+    auto expression = a * random_array(16, 16, 11);
+    hoNDArray<complex_float> r = expression;
+
+    auto b = random_array(16, 16, 11);
+    for (size_t i = 0; i < r.get_number_of_elements(); i++) expect_near(r[i], a[i] * b[i]);
+}
+
+TEST(hoNDArrayExpressionsTest, MismatchedSizesThrow) {
+    auto a = random_array(16, 16, 12), b = random_array(16, 15, 13);
+    hoNDArray<complex_float> r;
+    EXPECT_THROW(r = a + b, std::runtime_error);
+}
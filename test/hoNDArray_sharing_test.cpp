@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <complex>
+#include <thread>
+#include <vector>
+
+#include "hoNDArray.h"
+#include "Message.h"
+#include "Types.h"
+
+using namespace Gadgetron;
+
+namespace {
+    hoNDArray<float> ramp(size_t elements) {
+        hoNDArray<float> array(elements);
+        for (size_t i = 0; i < elements; i++) array(i) = float(i);
+        return array;
+    }
+}
+
+TEST(hoNDArraySharingTest, CopiesShareUntilWritten) {
+    auto original = ramp(1000);
+    original.share();
+
+    hoNDArray<float> copy = original;
+    const auto& const_original = original;
+    const auto& const_copy     = copy;
+
+    EXPECT_TRUE(original.is_shared());
+    EXPECT_EQ(const_original.get_data_ptr(), const_copy.get_data_ptr());
+
+    copy(3) = -1.0f;
+
+    EXPECT_FALSE(original.is_shared());
+    EXPECT_NE(const_original.get_data_ptr(), const_copy.get_data_ptr());
+    EXPECT_EQ(original(3), 3.0f);
+    EXPECT_EQ(copy(3), -1.0f);
+    EXPECT_EQ(copy(999), 999.0f);
+}
+
+TEST(hoNDArraySharingTest, LastHolderKeepsMemory) {
+    auto original = ramp(1000);
+    original.share();
+    const float* memory = static_cast<const hoNDArray<float>&>(original).get_data_ptr();
+
+    {
+        hoNDArray<float> copy = original;
+        EXPECT_TRUE(copy.is_shared());
+    }
+
+    original.make_unique();
+    EXPECT_EQ(original.get_data_ptr(), memory);
+
+    // Copies of an array which is no longer shared are full copies again.
+    hoNDArray<float> copy = original;
+    EXPECT_NE(static_cast<const hoNDArray<float>&>(copy).get_data_ptr(), memory);
+}
+
+TEST(hoNDArraySharingTest, AssignmentAndMove) {
+    auto original = ramp(64);
+    original.share();
+
+    hoNDArray<float> assigned(64);
+    assigned = original;
+    EXPECT_TRUE(original.is_shared());
+
+    hoNDArray<float> moved = std::move(assigned);
+    EXPECT_TRUE(original.is_shared());
+
+    moved.fill(7.0f);
+    EXPECT_EQ(original(10), 10.0f);
+    EXPECT_EQ(moved(10), 7.0f);
+    EXPECT_FALSE(original.is_shared());
+}
+
+TEST(hoNDArraySharingTest, ViewsAreCopiedInFull) {
+    std::vector<float> memory(32, 1.0f);
+    hoNDArray<float> view(memory.size(), memory.data());
+    view.share();
+
+    hoNDArray<float> copy = view;
+    EXPECT_FALSE(view.is_shared());
+    EXPECT_NE(static_cast<const hoNDArray<float>&>(copy).get_data_ptr(), memory.data());
+
+    // Assigning a shared array to a view still writes into the viewed memory.
+    auto shared = ramp(32);
+    shared.share();
+    view = shared;
+    EXPECT_EQ(memory[5], 5.0f);
+}
+
+TEST(hoNDArraySharingTest, WritersOnManyThreads) {
+    auto original = ramp(1 << 16);
+    original.share();
+
+    std::vector<hoNDArray<float>> copies(8, original);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < copies.size(); t++) {
+        threads.emplace_back([&copies, t]() {
+            for (auto& value : copies[t]) value += float(t);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (size_t t = 0; t < copies.size(); t++) {
+        EXPECT_EQ(copies[t](100), 100.0f + t);
+    }
+    EXPECT_EQ(original(100), 100.0f);
+}
+
+TEST(hoNDArraySharingTest, MessageCloneShares) {
+    Core::Acquisition acquisition{ ISMRMRD::AcquisitionHeader{}, hoNDArray<std::complex<float>>(128, 8),
+        hoNDArray<float>(2, 128) };
+    std::get<1>(acquisition).fill(std::complex<float>(1.0f, 2.0f));
+
+    Core::Message message(std::move(acquisition));
+    auto clone = message.clone();
+
+    auto original = Core::force_unpack<Core::Acquisition>(std::move(message));
+    auto cloned   = Core::force_unpack<Core::Acquisition>(std::move(clone));
+
+    EXPECT_TRUE(std::get<1>(original).is_shared());
+    EXPECT_TRUE(std::get<2>(original)->is_shared());
+
+    std::get<1>(cloned)(0, 0) = 0.0f;
+    EXPECT_EQ(std::get<1>(original)(0, 0), std::complex<float>(1.0f, 2.0f));
+}
+
+TEST(hoNDArraySharingTest, ConcurrentWritersToOneSharedArray) {
+    auto original = ramp(1 << 16);
+    original.share();
+    hoNDArray<float> copy = original;
+    const float* memory   = static_cast<const hoNDArray<float>&>(original).get_data_ptr();
+
+    // Many threads write through the non-const accessors of one shared array at once; one of them detaches it.
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 8; t++) {
+        threads.emplace_back([&original, t]() {
+            for (size_t i = t; i < original.get_number_of_elements(); i += 8) {
+                if (i % 3 == 0)
+                    original(i) = -1.0f;
+                else if (i % 3 == 1)
+                    original.data()[i] = -1.0f;
+                else
+                    *(original.begin() + i) = -1.0f;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_FALSE(original.is_shared());
+    EXPECT_NE(static_cast<const hoNDArray<float>&>(original).get_data_ptr(), memory);
+    for (size_t i = 0; i < original.get_number_of_elements(); i++) {
+        ASSERT_EQ(original(i), -1.0f);
+        ASSERT_EQ(copy(i), float(i));
+    }
+}
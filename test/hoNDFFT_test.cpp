@@ -44,3 +44,61 @@ TYPED_TEST(hoNDFFT_test,ifftNrm2Test){
 	EXPECT_NEAR(nrm2(&this->Array2),nrm2(&this->Array),nrm2(&this->Array)*1e-2);
 
 }
+
+template<typename REAL> class hoNDFFT_centered_test : public ::testing::Test {
+protected:
+	hoNDArray<std::complex<REAL> > random_array(std::vector<size_t> dimensions){
+		boost::random::mt19937 rng;
+		boost::random::uniform_real_distribution<REAL> uni(0,1);
+
+		hoNDArray<std::complex<REAL> > array(dimensions);
+		for (auto& value : array)
+			value = std::complex<REAL>(uni(rng),uni(rng));
+		return array;
+	}
+
+	void expect_equal(const hoNDArray<std::complex<REAL> >& expected, const hoNDArray<std::complex<REAL> >& actual){
+		ASSERT_TRUE(expected.dimensions_equal(&actual));
+		for (size_t i = 0; i < expected.get_number_of_elements(); i++)
+			EXPECT_LT(std::abs(expected[i]-actual[i]), 1e-4);
+	}
+};
+TYPED_TEST_CASE(hoNDFFT_centered_test, realImplementations);
+
+TYPED_TEST(hoNDFFT_centered_test,fft2cMatchesShiftedTransform){
+	auto fft = hoNDFFT<TypeParam>::instance();
+
+	for (auto dimensions : { std::vector<size_t>{8,6,3}, std::vector<size_t>{5,6,2} }){
+		auto data = this->random_array(dimensions);
+
+		hoNDArray<std::complex<TypeParam> > expected, centered;
+		fft->ifftshift2D(data, expected);
+		fft->fft2(expected);
+		fft->fftshift2D(expected);
+
+		fft->fft2c(data, centered);
+		this->expect_equal(expected, centered);
+
+		fft->ifft2c(centered);
+		this->expect_equal(data, centered);
+	}
+}
+
+TYPED_TEST(hoNDFFT_centered_test,fft3cMatchesShiftedTransform){
+	auto fft = hoNDFFT<TypeParam>::instance();
+
+	auto data = this->random_array({4,6,8,2});
+
+	hoNDArray<std::complex<TypeParam> > expected, centered, buffer;
+	fft->ifftshift3D(data, expected);
+	fft->ifft3(expected);
+	fft->fftshift3D(expected);
+
+	fft->ifft3c(data, centered, buffer);
+	this->expect_equal(expected, centered);
+
+	centered = data;
+	fft->fft3c(centered);
+	fft->ifft3c(centered);
+	this->expect_equal(data, centered);
+}
@@ -6,6 +6,7 @@
 #include "vector_td_utilities.h"
 #include "ImageIOAnalyze.h"
 #include "GadgetronTimer.h"
+#include <boost/random.hpp>
 
 using namespace Gadgetron;
 using testing::Types;
@@ -136,3 +137,71 @@ TYPED_TEST(hoNFFT_2D_NC2C_BACKWARDS, randomTestOne)
 
     EXPECT_LE(v/norm_ref, 0.00001);
 }
+
+TEST(hoNFFT_sparse_matrix, transposeIsAdjoint)
+{
+    boost::random::mt19937 rng;
+    boost::random::uniform_real_distribution<float> uni(0, 32);
+
+    hoNDArray<vector_td<float, 2>> trajectory(500);
+    for (auto& point : trajectory)
+        point = vector_td<float, 2>(uni(rng), uni(rng));
+
+    auto matrix = NFFT_internal::make_NFFT_matrix(trajectory, vector_td<size_t, 2>(32, 32), 5.5f,
+        vector_td<float, 2>(10.0f, 10.0f));
+    auto transposed = NFFT_internal::transpose(matrix);
+
+    const auto zero = complext<float>(0, 0);
+    std::vector<complext<float>> grid(32 * 32), samples(500, zero), serial_samples(500, zero),
+        ones(500, complext<float>(1, 0)), adjoint(32 * 32, zero);
+    for (auto& value : grid)
+        value = complext<float>(uni(rng), uni(rng));
+
+    NFFT_internal::matrix_vector_multiply(matrix, grid.data(), samples.data(), true);
+    NFFT_internal::matrix_vector_multiply(matrix, grid.data(), serial_samples.data(), false);
+    NFFT_internal::matrix_vector_multiply(transposed, ones.data(), adjoint.data(), true);
+
+    // sum(A g) must equal <g, A^T 1>, as the weights are real
+    double forward = 0, backward = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        forward += real(samples[i]);
+        EXPECT_EQ(real(samples[i]), real(serial_samples[i]));
+        EXPECT_EQ(imag(samples[i]), imag(serial_samples[i]));
+    }
+    for (size_t i = 0; i < grid.size(); i++)
+        backward += real(grid[i]) * real(adjoint[i]);
+
+    EXPECT_NEAR(forward, backward, 1e-3 * std::abs(forward));
+    EXPECT_EQ(matrix.offsets.back(), matrix.indices.size());
+}
+
+TEST(hoNFFT_cache, reusesPreprocessingForEqualTrajectories)
+{
+    hoNDArray<vector_td<float, 2>> trajectory(16);
+    for (size_t i = 0; i < trajectory.size(); i++)
+        trajectory[i] = vector_td<float, 2>(float(i), -float(i));
+
+    int created = 0;
+    auto create = [&created]() {
+        created++;
+        NFFT_internal::NFFT_Deapodization<float> filters;
+        filters.FFT = hoNDArray<std::complex<float>>(8);
+        filters.IFFT = filters.FFT;
+        return filters;
+    };
+
+    auto& cache = NFFT_internal::NFFT_Cache::instance();
+    auto key = NFFT_internal::NFFT_Key("test") << trajectory;
+    auto first = cache.get<NFFT_internal::NFFT_Deapodization<float>>(key.str(), create);
+    auto second = cache.get<NFFT_internal::NFFT_Deapodization<float>>(key.str(), create);
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(created, 1);
+
+    trajectory[3][0] = 100.0f;
+    auto changed_key = NFFT_internal::NFFT_Key("test") << trajectory;
+    auto changed = cache.get<NFFT_internal::NFFT_Deapodization<float>>(changed_key.str(), create);
+
+    EXPECT_NE(first, changed);
+    EXPECT_EQ(created, 2);
+}
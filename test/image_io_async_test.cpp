@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <complex>
+
+#include "ImageIOAsync.h"
+
+using namespace Gadgetron;
+
+namespace {
+    class ImageIOAsyncTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+            boost::filesystem::create_directories(folder);
+        }
+
+        void TearDown() override {
+            boost::filesystem::remove_all(folder);
+        }
+
+        std::string path(const std::string& name) const {
+            return (folder / name).string();
+        }
+
+        boost::filesystem::path folder;
+    };
+
+    hoNDArray<std::complex<float>> ramp(size_t x, size_t y) {
+        hoNDArray<std::complex<float>> array(x, y);
+        for (size_t i = 0; i < array.get_number_of_elements(); i++) array(i) = std::complex<float>(float(i), -float(i));
+        return array;
+    }
+}
+
+TEST_F(ImageIOAsyncTest, CompressedRoundTrip) {
+    auto array = ramp(64, 33);
+
+    hoNDArray<float> magnitude(7, 5, 3);
+    magnitude.fill(2.5f);
+
+    {
+        ImageIOAsync exporter(ImageIOAsync::default_queue_bytes, ImageIOAsync::Format::compressed);
+        exporter.export_array_complex(array, path("kspace"));
+        exporter.export_array(magnitude, path("magnitude"));
+    }
+
+    hoNDArray<std::complex<float>> kspace;
+    ImageIOAsync::import_compressed(kspace, path("kspace"));
+    ASSERT_EQ(kspace.get_size(0), 64);
+    ASSERT_EQ(kspace.get_size(1), 33);
+    for (size_t i = 0; i < array.get_number_of_elements(); i++) ASSERT_EQ(kspace(i), array(i));
+
+    hoNDArray<float> read;
+    ImageIOAsync::import_compressed(read, path("magnitude"));
+    ASSERT_EQ(read.get_number_of_dimensions(), 3);
+    EXPECT_EQ(read(6, 4, 2), 2.5f);
+
+    EXPECT_THROW(ImageIOAsync::import_compressed(read, path("kspace")), std::runtime_error);
+}
+
+TEST_F(ImageIOAsyncTest, WritesArrayAsExported) {
+    auto array = ramp(128, 16);
+
+    ImageIOAsync exporter(ImageIOAsync::default_queue_bytes, ImageIOAsync::Format::compressed);
+    exporter.export_array(array, path("before"));
+
+    // The caller may overwrite the array as soon as the export returns.
+    array.fill(0.0f);
+    exporter.flush();
+
+    hoNDArray<std::complex<float>> read;
+    ImageIOAsync::import_compressed(read, path("before"));
+    EXPECT_EQ(read(5, 3), std::complex<float>(389.0f, -389.0f));
+}
+
+TEST_F(ImageIOAsyncTest, DropsWhenQueueIsFull) {
+    auto array = ramp(128, 16);
+
+    ImageIOAsync exporter(array.get_number_of_bytes() - 1, ImageIOAsync::Format::compressed);
+    exporter.export_array(array, path("dropped"));
+    exporter.flush();
+
+    EXPECT_EQ(exporter.dropped(), 1);
+    EXPECT_FALSE(boost::filesystem::exists(path("dropped.ndz")));
+}
+
+TEST_F(ImageIOAsyncTest, WritesAnalyzeOnCallingThreadWithoutQueue) {
+    auto array = ramp(16, 16);
+
+    ImageIOAsync exporter(0);
+    exporter.export_array_complex(array, path("analyze"));
+
+    EXPECT_TRUE(boost::filesystem::exists(path("analyze_REAL.hdr")));
+    EXPECT_TRUE(boost::filesystem::exists(path("analyze_PHASE.img")));
+}
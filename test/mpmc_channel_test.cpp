@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <thread>
+
+#include "MPMCChannel.h"
+
+using namespace Gadgetron::Core;
+
+TEST(BoundedMPMCChannelTest, FIFOOrder) {
+    BoundedMPMCChannel<int> channel{ 4, 2 };
+    for (int i = 0; i < 4; i++)
+        channel.push(i);
+
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(channel.pop(), i);
+
+    EXPECT_FALSE(channel.try_pop());
+}
+
+TEST(BoundedMPMCChannelTest, DrainsAfterClose) {
+    BoundedMPMCChannel<std::unique_ptr<int>> channel{ 2, 1 };
+    channel.push(std::make_unique<int>(42));
+    channel.close();
+
+    EXPECT_EQ(*channel.pop(), 42);
+    EXPECT_THROW(channel.pop(), ChannelClosed);
+    EXPECT_THROW(channel.push(std::make_unique<int>(1)), ChannelClosed);
+}
+
+TEST(BoundedMPMCChannelTest, ProducerBlocksWhenFull) {
+    BoundedMPMCChannel<int> channel{ 2, 0 };
+    channel.push(1);
+    channel.push(2);
+
+    std::atomic<bool> pushed{ false };
+    std::thread producer([&]() {
+        channel.push(3);
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+
+    EXPECT_EQ(channel.pop(), 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed); // Still above the low watermark.
+
+    EXPECT_EQ(channel.pop(), 2);
+    producer.join();
+    EXPECT_TRUE(pushed);
+    EXPECT_EQ(channel.pop(), 3);
+}
+
+TEST(BoundedMPMCChannelTest, ManyProducersManyConsumers) {
+    BoundedMPMCChannel<long> channel{ 16, 8 };
+    constexpr long messages_per_producer = 10000;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; p++)
+        producers.emplace_back([&]() {
+            for (long i = 0; i < messages_per_producer; i++)
+                channel.push(i);
+        });
+
+    std::atomic<long> sum{ 0 };
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 4; c++)
+        consumers.emplace_back([&]() {
+            try {
+                while (true)
+                    sum += channel.pop();
+            } catch (const ChannelClosed&) {
+            }
+        });
+
+    for (auto& producer : producers)
+        producer.join();
+    channel.close();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    EXPECT_EQ(sum, 4 * messages_per_producer * (messages_per_producer - 1) / 2);
+}
@@ -0,0 +1,57 @@
+#include "NHLBICompression.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+    std::vector<float> random_samples(size_t elements) {
+        std::mt19937 generator(42);
+        std::normal_distribution<float> distribution(0.0f, 100.0f);
+
+        std::vector<float> samples(elements);
+        for (auto& sample : samples) sample = distribution(generator);
+        return samples;
+    }
+}
+
+TEST(NHLBICompression, DecompressMatchesElementwiseAccess) {
+    // Odd lengths leave partial vectors and windows at the end of the packed data.
+    for (size_t elements : { 1, 7, 33, 1000, 4099 }) {
+        auto samples = random_samples(elements);
+
+        for (float tolerance : { 0.01f, 0.1f, 1.0f, 10.0f }) {
+            CompressedBuffer<float> compressed(samples, tolerance);
+
+            auto serialized = compressed.serialize();
+            CompressedBuffer<float> deserialized;
+            deserialized.deserialize(serialized);
+
+            std::vector<float> decompressed(elements);
+            deserialized.decompress(decompressed.data());
+
+            for (size_t i = 0; i < elements; i++) {
+                ASSERT_EQ(decompressed[i], deserialized[i]) << "element " << i << " of " << elements
+                                                             << ", " << deserialized.getPrecision() << " bits";
+                ASSERT_NEAR(decompressed[i], samples[i], 1.001f * tolerance);
+            }
+        }
+    }
+}
+
+TEST(NHLBICompression, DecompressWideValues) {
+    auto samples = random_samples(513);
+
+    for (uint8_t bits : { 12, 24, 25, 26, 31 }) {
+        CompressedBuffer<float> compressed(samples, -1.0f, bits);
+
+        auto serialized = compressed.serialize();
+        CompressedBuffer<float> deserialized;
+        deserialized.deserialize(serialized);
+
+        std::vector<float> decompressed(samples.size());
+        deserialized.decompress(decompressed.data());
+
+        for (size_t i = 0; i < samples.size(); i++)
+            ASSERT_EQ(decompressed[i], deserialized[i]) << "element " << i << ", " << int(bits) << " bits";
+    }
+}
@@ -0,0 +1,117 @@
+#include "NoiseCovarianceCache.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace Gadgetron;
+
+namespace {
+    class NoiseCovarianceCacheTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("noise_cache_%%%%-%%%%");
+            boost::filesystem::create_directories(folder);
+
+            dependency = folder / "GadgetronNoiseCovarianceMatrix_test";
+            std::ofstream(dependency.string()) << "noise dependency";
+
+            covariance = hoNDArray<std::complex<float>>(4, 4);
+            for (size_t i = 0; i < covariance.size(); i++)
+                covariance[i] = std::complex<float>(float(i), 1.0f);
+        }
+
+        void TearDown() override {
+            boost::filesystem::remove_all(folder);
+        }
+
+        boost::filesystem::path folder;
+        boost::filesystem::path dependency;
+        hoNDArray<std::complex<float>> covariance;
+    };
+}
+
+TEST_F(NoiseCovarianceCacheTest, CovarianceIsParsedOnce) {
+    NoiseCovarianceCache cache(folder, "GadgetronNoiseCovarianceMatrix");
+
+    size_t parses = 0;
+    auto parse    = [&]() -> Core::optional<NoiseCovarianceCache::Covariance> {
+        parses++;
+        return NoiseCovarianceCache::Covariance{
+            std::vector<ISMRMRD::CoilLabel>{ { 1, "Body" }, { 2, "Head" } }, 2.5f, covariance };
+    };
+
+    cache.load(dependency, parse);
+    auto loaded = cache.load(dependency, parse);
+
+    EXPECT_EQ(parses, 1);
+    ASSERT_TRUE(loaded);
+    ASSERT_TRUE(loaded->coil_labels);
+    EXPECT_EQ(loaded->coil_labels->at(1).coilName, "Head");
+    EXPECT_EQ(loaded->noise_dwell_time_us, 2.5f);
+    EXPECT_TRUE(std::equal(covariance.begin(), covariance.end(), loaded->matrix.begin()));
+}
+
+TEST_F(NoiseCovarianceCacheTest, MissingDependencyIsNotLoaded) {
+    NoiseCovarianceCache cache(folder, "GadgetronNoiseCovarianceMatrix");
+
+    auto loaded = cache.load(folder / "missing", []() -> Core::optional<NoiseCovarianceCache::Covariance> {
+        return NoiseCovarianceCache::Covariance{ Core::none, 1.0f, hoNDArray<std::complex<float>>(1, 1) };
+    });
+
+    EXPECT_FALSE(loaded);
+}
+
+TEST_F(NoiseCovarianceCacheTest, PrewhitenerIsSharedAcrossCaches) {
+    size_t computations = 0;
+    auto compute        = [&](const hoNDArray<std::complex<float>>& covariance) {
+        computations++;
+        auto prewhitener = covariance;
+        for (auto& value : prewhitener)
+            value *= 2.0f;
+        return prewhitener;
+    };
+
+    NoiseCovarianceCache(folder, "GadgetronNoiseCovarianceMatrix").prewhitener(covariance, compute);
+    auto prewhitener = NoiseCovarianceCache(folder, "GadgetronNoiseCovarianceMatrix").prewhitener(covariance, compute);
+
+    EXPECT_EQ(computations, 1);
+    EXPECT_EQ(prewhitener[5], covariance[5] * 2.0f);
+
+    auto other = covariance;
+    other[0]   = 42.0f;
+    NoiseCovarianceCache(folder, "GadgetronNoiseCovarianceMatrix").prewhitener(other, compute);
+    EXPECT_EQ(computations, 2);
+}
+
+TEST_F(NoiseCovarianceCacheTest, LeastRecentlyUsedPrewhitenersAreEvicted) {
+    auto identity = [](const hoNDArray<std::complex<float>>& covariance) { return covariance; };
+    auto entries  = [&]() {
+        return std::count_if(boost::filesystem::directory_iterator(folder), boost::filesystem::directory_iterator(),
+            [](auto& entry) { return entry.path().filename().string().find("_prewhitener_") != std::string::npos; });
+    };
+
+    NoiseCovarianceCache cache(folder, "GadgetronNoiseCovarianceMatrix", 2);
+    for (int i = 0; i < 5; i++) {
+        auto other = covariance;
+        other[0]   = float(i);
+        cache.prewhitener(other, identity);
+        EXPECT_LE(entries(), 2);
+    }
+
+    size_t computations = 0;
+    auto counted        = [&](const hoNDArray<std::complex<float>>& covariance) {
+        computations++;
+        return covariance;
+    };
+
+    auto latest = covariance;
+    latest[0]   = 4.0f;
+    cache.prewhitener(latest, counted);
+    EXPECT_EQ(computations, 0);
+
+    NoiseCovarianceCache(folder, "GadgetronNoiseCovarianceMatrix", 0).prewhitener(covariance, counted);
+    EXPECT_EQ(computations, 1);
+    EXPECT_LE(entries(), 2);
+}
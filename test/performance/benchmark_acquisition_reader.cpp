@@ -0,0 +1,163 @@
+// Reads streams of acquisitions, uncompressed and NHLBI compressed, with the acquisition reader, and reports the rate
+// at which decoded samples come out: decoded on the input thread, and on the input pipeline's workers.
+
+#include "GadgetIsmrmrdReader.h"
+#include "NHLBICompression.h"
+#include "connection/InputPipeline.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+
+namespace {
+    constexpr size_t samples = 512, channels = 32, acquisitions = 2000;
+    constexpr double decoded_bytes = double(samples * channels * acquisitions * sizeof(std::complex<float>));
+
+    struct Codec {
+        std::string name;
+        bool compressed;
+        float tolerance;
+        uint8_t precision;
+    };
+
+    std::vector<float> random_readout() {
+        static std::mt19937 generator(42);
+        std::normal_distribution<float> distribution(0.0f, 100.0f);
+
+        std::vector<float> readout(2 * samples * channels);
+        for (auto& value : readout) value = distribution(generator);
+        return readout;
+    }
+
+    std::string serialized_acquisitions(const Codec& codec) {
+        std::stringstream stream;
+
+        for (size_t i = 0; i < acquisitions; i++) {
+            ISMRMRD::AcquisitionHeader header{};
+            header.scan_counter      = uint32_t(i);
+            header.number_of_samples = uint16_t(samples);
+            header.active_channels   = uint16_t(channels);
+            header.available_channels = uint16_t(channels);
+
+            auto readout = random_readout();
+
+            if (!codec.compressed) {
+                IO::write(stream, header);
+                stream.write(reinterpret_cast<const char*>(readout.data()), readout.size() * sizeof(float));
+                continue;
+            }
+
+            header.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
+            IO::write(stream, header);
+
+            CompressedBuffer<float> compressed(readout, codec.tolerance, codec.precision);
+            auto bytes = compressed.serialize();
+            IO::write(stream, uint32_t(bytes.size()));
+            stream.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+
+        return stream.str();
+    }
+
+    double seconds_to_read_inline(const std::string& serialized) {
+        GadgetIsmrmrdAcquisitionMessageReader reader;
+        std::istringstream stream(serialized);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < acquisitions; i++) reader.read(stream);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double seconds_to_read_pipelined(const std::string& serialized, unsigned int workers) {
+        GadgetIsmrmrdAcquisitionMessageReader reader;
+        std::istringstream stream(serialized);
+
+        auto channel = make_channel<MessageChannel>();
+        size_t received = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::thread consumer([&]() {
+            try {
+                for (;;) {
+                    channel.input.pop();
+                    received++;
+                }
+            } catch (const ChannelClosed&) {
+            }
+        });
+
+        {
+            Server::Connection::InputPipeline pipeline(workers);
+            for (size_t i = 0; i < acquisitions; i++) pipeline.push(reader.read_pending(stream), channel.output);
+            pipeline.flush();
+        }
+        { auto output = std::move(channel.output); }
+
+        consumer.join();
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (received != acquisitions) throw std::runtime_error("Lost acquisitions");
+        return seconds;
+    }
+
+    // Unpacking alone, element by element as the reader did before, and with the vectorised kernel.
+    void benchmark_unpacking(const Codec& codec) {
+        auto readout = random_readout();
+        CompressedBuffer<float> compressed(readout, codec.tolerance, codec.precision);
+        std::vector<float> output(readout.size());
+
+        constexpr size_t repetitions = 200;
+        auto mb_per_second = [&](auto unpack) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < repetitions; r++) unpack();
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return repetitions * output.size() * sizeof(float) / seconds / 1e6;
+        };
+
+        auto elementwise = mb_per_second([&]() {
+            for (size_t i = 0; i < output.size(); i++) output[i] = compressed[i];
+        });
+        auto kernel = mb_per_second([&]() { compressed.decompress(output.data()); });
+
+        std::cout << "  unpacking " << compressed.getPrecision() << " bit values: " << std::setw(8) << elementwise
+                  << " MB/s element-wise, " << std::setw(8) << kernel << " MB/s with decompress ("
+                  << kernel / elementwise << "x)" << std::endl;
+    }
+}
+
+int main() {
+    const std::vector<Codec> codecs{
+        { "uncompressed", false, 0.0f, 32 },
+        { "NHLBI, tolerance 1", true, 1.0f, 32 },
+        { "NHLBI, tolerance 0.01", true, 0.01f, 32 },
+        { "NHLBI, 16 bit precision", true, -1.0f, 16 },
+    };
+
+    const unsigned int workers = Server::Connection::default_input_decode_workers;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << acquisitions << " acquisitions of " << samples << " samples x " << channels << " channels"
+              << std::endl;
+
+    for (auto& codec : codecs) {
+        auto serialized = serialized_acquisitions(codec);
+
+        auto inline_seconds    = seconds_to_read_inline(serialized);
+        auto pipelined_seconds = seconds_to_read_pipelined(serialized, workers);
+
+        std::cout << codec.name << " (" << serialized.size() / 1e6 << " MB on the wire)" << std::endl;
+        std::cout << "  input thread: " << std::setw(8) << decoded_bytes / inline_seconds / 1e6 << " MB/s, "
+                  << workers << " workers: " << std::setw(8) << decoded_bytes / pipelined_seconds / 1e6
+                  << " MB/s decoded" << std::endl;
+
+        if (codec.compressed) benchmark_unpacking(codec);
+    }
+
+    return 0;
+}
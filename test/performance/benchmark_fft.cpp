@@ -0,0 +1,81 @@
+// Compares the cost of the Cartesian FFTs of a reconstruction with the plan made for every transform (as hoNDFFT
+// used to do), with cached estimated plans, and with cached measured plans.
+
+#include "hoNDFFT.h"
+
+#include <chrono>
+#include <fftw3.h>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    constexpr size_t repetitions = 20;
+
+    hoNDArray<std::complex<float>> random_kspace(std::vector<size_t> dimensions) {
+        std::mt19937 generator(42);
+        std::normal_distribution<float> distribution;
+
+        hoNDArray<std::complex<float>> kspace(dimensions);
+        for (auto& value : kspace)
+            value = std::complex<float>(distribution(generator), distribution(generator));
+        return kspace;
+    }
+
+    template <class F> double milliseconds_per_transform(F&& transform) {
+        transform();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repetitions; i++)
+            transform();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+               / repetitions;
+    }
+
+    // The previous behaviour: an estimated plan made and destroyed around every transform.
+    void fftn_planned_per_call(hoNDArray<std::complex<float>>& data, int rank) {
+        std::vector<fftw_iodim64> dimensions(rank);
+        ptrdiff_t stride = 1;
+        for (int i = 0; i < rank; i++) {
+            dimensions[i] = { ptrdiff_t(data.get_size(i)), stride, stride };
+            stride *= data.get_size(i);
+        }
+
+        auto plan = fftwf_plan_guru64_dft(rank, dimensions.data(), 0, nullptr, (fftwf_complex*)data.data(),
+            (fftwf_complex*)data.data(), FFTW_FORWARD, FFTW_ESTIMATE);
+        for (size_t offset = 0; offset < data.size(); offset += stride)
+            fftwf_execute_dft(plan, (fftwf_complex*)(data.data() + offset), (fftwf_complex*)(data.data() + offset));
+        fftwf_destroy_plan(plan);
+    }
+
+    void benchmark(const std::string& name, std::vector<size_t> dimensions, int rank) {
+        auto data = random_kspace(dimensions);
+        auto fft  = [&]() {
+            if (rank == 2)
+                hoNDFFT<float>::instance()->fft2(data);
+            else
+                hoNDFFT<float>::instance()->fft3(data);
+        };
+
+        auto per_call = milliseconds_per_transform([&]() { fftn_planned_per_call(data, rank); });
+
+        FFT::set_planning(FFT::Planning::estimate);
+        auto estimated = milliseconds_per_transform(fft);
+
+        FFT::set_planning(FFT::Planning::measure);
+        auto measured = milliseconds_per_transform(fft);
+
+        std::cout << name << ": planned per call " << per_call << " ms, cached estimate " << estimated
+                  << " ms, cached measure " << measured << " ms (speedup " << per_call / measured << "x)"
+                  << std::endl;
+    }
+}
+
+int main() {
+    benchmark("2D 256x256, 32 coils", { 256, 256, 32 }, 2);
+    benchmark("2D 192x156, 16 coils, 10 slices", { 192, 156, 16, 10 }, 2);
+    benchmark("3D 256x128x64, 8 coils", { 256, 128, 64, 8 }, 3);
+    benchmark("3D 192x192x96", { 192, 192, 96 }, 3);
+    return 0;
+}
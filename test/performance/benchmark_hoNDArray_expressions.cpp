@@ -0,0 +1,107 @@
+// Compares element-wise expressions typical of SPIRiT and GRAPPA code computed with the functions of
+// hoNDArray_elemwise.h, one pass and one temporary per operation, and with hoNDArray_expressions.h, in a single pass.
+
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_expressions.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+    using complex_float = std::complex<float>;
+
+    constexpr size_t repetitions = 20;
+
+    hoNDArray<complex_float> random_array(const std::vector<size_t>& dimensions, unsigned int seed) {
+        std::mt19937 generator(seed);
+        std::normal_distribution<float> distribution;
+
+        hoNDArray<complex_float> array(dimensions);
+        for (auto& value : array) value = complex_float(distribution(generator), distribution(generator));
+        return array;
+    }
+
+    template <class F> double milliseconds_per_evaluation(F&& evaluate) {
+        evaluate();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repetitions; i++) evaluate();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repetitions;
+    }
+
+    template <class T, class S> double largest_difference(const hoNDArray<T>& a, const hoNDArray<S>& b) {
+        double difference = 0;
+        for (size_t i = 0; i < a.get_number_of_elements(); i++)
+            difference = std::max(difference, double(std::abs(a[i] - b[i])));
+        return difference;
+    }
+
+    // Bytes is the memory a single pass reads and writes: every operand once, and the result.
+    template <class Separate, class Fused>
+    void compare(const std::string& name, double bytes, Separate&& separate, Fused&& fused) {
+        auto separate_ms = milliseconds_per_evaluation(separate);
+        auto fused_ms    = milliseconds_per_evaluation(fused);
+
+        std::cout << std::setw(28) << std::left << name << std::right << std::setw(9) << separate_ms
+                  << " ms separate, " << std::setw(9) << fused_ms << " ms fused (" << separate_ms / fused_ms
+                  << "x), fused at " << bytes / fused_ms / 1e6 << " GB/s" << std::endl;
+    }
+}
+
+int main() {
+    // A 2D slab of coil images: readout x phase encoding x channels.
+    const std::vector<size_t> dimensions{ 192, 144, 32 };
+
+    auto a = random_array(dimensions, 1), b = random_array(dimensions, 2);
+    auto c = random_array(dimensions, 3), d = random_array(dimensions, 4);
+
+    const double array_bytes = double(a.get_number_of_bytes());
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Arrays of " << a.get_number_of_elements() << " complex floats, " << array_bytes / 1e6 << " MB"
+              << std::endl;
+
+    {
+        hoNDArray<complex_float> ab, cd, separate, fused;
+        compare("a * b + c * conj(d)", 5 * array_bytes,
+            [&]() {
+                multiply(a, b, ab);
+                multiplyConj(c, d, cd);
+                add(ab, cd, separate);
+            },
+            [&]() { fused = a * b + c * conj(d); });
+
+        std::cout << "  largest difference " << largest_difference(separate, fused) << std::endl;
+    }
+
+    {
+        hoNDArray<complex_float> bc, separate, fused;
+        compare("a - 0.5 * (b + c)", 4 * array_bytes,
+            [&]() {
+                add(b, c, bc);
+                scal(0.5f, bc);
+                subtract(a, bc, separate);
+            },
+            [&]() { fused = a - 0.5f * (b + c); });
+
+        std::cout << "  largest difference " << largest_difference(separate, fused) << std::endl;
+    }
+
+    {
+        hoNDArray<complex_float> ab;
+        hoNDArray<float> separate, fused;
+        compare("abs(a * b)", 2.5 * array_bytes,
+            [&]() {
+                multiply(a, b, ab);
+                Gadgetron::abs(ab, separate);
+            },
+            [&]() { fused = abs(a * b); });
+
+        std::cout << "  largest difference " << largest_difference(separate, fused) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Measures how many small messages per second the serialization of distributed and external streams moves over a
+// local socket pair, with the dispatch tables of Serialization and with the previous per-message dispatch (a
+// handler map built for every read, and a scan over all writers for every write).
+
+#include "connection/SocketStreamBuf.h"
+#include "connection/stream/common/Serialization.h"
+
+#include "io/primitives.h"
+#include "MessageID.h"
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Stream;
+
+namespace {
+    constexpr size_t number_of_messages = 1000000;
+    constexpr size_t number_of_types = 8;
+
+    template <size_t N> struct Payload {
+        uint64_t value;
+    };
+
+    template <size_t N> uint16_t slot_of() {
+        return uint16_t(GADGET_MESSAGE_EXT_ID_MIN + 100 + N);
+    }
+
+    template <size_t N> class PayloadReader : public Reader {
+    public:
+        Message read(std::istream& stream) override {
+            return Message(IO::read<Payload<N>>(stream));
+        }
+        uint16_t slot() override {
+            return slot_of<N>();
+        }
+    };
+
+    template <size_t N> class PayloadWriter : public TypedWriter<Payload<N>> {
+    protected:
+        void serialize(std::ostream& stream, const Payload<N>& payload) override {
+            IO::write(stream, slot_of<N>());
+            IO::write(stream, payload);
+        }
+    };
+
+    template <size_t... Ns> Serialization::Readers make_readers(std::index_sequence<Ns...>) {
+        Serialization::Readers readers;
+        (readers.emplace(slot_of<Ns>(), std::make_unique<PayloadReader<Ns>>()), ...);
+        return readers;
+    }
+
+    template <size_t... Ns> Serialization::Writers make_writers(std::index_sequence<Ns...>) {
+        Serialization::Writers writers;
+        (writers.push_back(std::make_unique<PayloadWriter<Ns>>()), ...);
+        return writers;
+    }
+
+    // The dispatch Serialization did before its tables: the control message map is rebuilt for every read,
+    // and every write asks each writer in turn whether it accepts the message.
+    struct PerMessageDispatch {
+        Serialization::Readers readers = make_readers(std::make_index_sequence<number_of_types>{});
+        Serialization::Writers writers = make_writers(std::make_index_sequence<number_of_types>{});
+
+        void write(std::iostream& stream, Message message) const {
+            auto writer = std::find_if(
+                writers.begin(), writers.end(), [&](auto& writer) { return writer->accepts(message); });
+            (*writer)->write(stream, std::move(message));
+        }
+
+        Message read(std::iostream& stream, std::function<void()> on_close,
+            std::function<void(std::string message)> on_error) const {
+            auto id               = IO::read<uint16_t>(stream);
+            auto illegal_message = [&](auto&) { throw std::runtime_error("Illegal message id"); };
+
+            const std::map<uint16_t, std::function<void(std::iostream&)>> handlers{ { FILENAME, illegal_message },
+                { CONFIG, illegal_message }, { HEADER, illegal_message }, { CLOSE, [&](auto&) { on_close(); } },
+                { TEXT, illegal_message }, { QUERY, illegal_message }, { RESPONSE, illegal_message },
+                { ERROR, [&](auto& stream) { on_error(IO::read_string_from_stream<uint64_t>(stream)); } } };
+
+            for (; handlers.count(id); id = IO::read<uint16_t>(stream))
+                handlers.at(id)(stream);
+            return readers.at(id)->read(stream);
+        }
+
+        void close(std::iostream& stream) const {
+            IO::write(stream, CLOSE);
+        }
+    };
+
+    struct Closed {};
+
+    std::pair<std::unique_ptr<std::iostream>, std::unique_ptr<std::iostream>> socket_pair(
+        boost::asio::io_service& service) {
+        using boost::asio::ip::tcp;
+
+        tcp::acceptor acceptor(service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+
+        auto client = std::make_unique<tcp::socket>(service);
+        auto server = std::make_unique<tcp::socket>(service);
+
+        client->connect(acceptor.local_endpoint());
+        acceptor.accept(*server);
+
+        return { Connection::stream_from_socket(std::move(client)), Connection::stream_from_socket(std::move(server)) };
+    }
+
+    template <class Dispatch> double messages_per_second(const Dispatch& dispatch) {
+        boost::asio::io_service service;
+        auto streams = socket_pair(service);
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::thread sender([&]() {
+            for (size_t i = 0; i < number_of_messages; i++) {
+                // Only the last writer accepts the message, as for the later of many registered writers.
+                dispatch.write(*streams.first, Message(Payload<number_of_types - 1>{ i }));
+            }
+            dispatch.close(*streams.first);
+            streams.first->flush();
+        });
+
+        size_t received = 0;
+        try {
+            for (;;) {
+                dispatch.read(
+                    *streams.second, []() { throw Closed{}; }, [](auto) {});
+                received++;
+            }
+        } catch (const Closed&) {
+        }
+
+        sender.join();
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (received != number_of_messages)
+            throw std::runtime_error("Lost messages");
+        return received / seconds;
+    }
+}
+
+int main() {
+    PerMessageDispatch previous;
+    Serialization tables(make_readers(std::make_index_sequence<number_of_types>{}),
+        make_writers(std::make_index_sequence<number_of_types>{}));
+
+    auto before = messages_per_second(previous);
+    auto after  = messages_per_second(tables);
+
+    std::cout << "Per-message dispatch: " << before << " messages/s" << std::endl;
+    std::cout << "Dispatch tables:      " << after << " messages/s" << std::endl;
+    std::cout << "Speed up:             " << after / before << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Pushes readout-sized messages through a chain of lightweight pure gadgets, once with a thread and a channel per
+// gadget as a stream ran them before, and once fused onto a single thread. Reports throughput and the processor time
+// spent per message.
+
+#include "connection/stream/Fused.h"
+
+#include "PureGadget.h"
+#include "hoNDArray.h"
+
+#include <chrono>
+#include <complex>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+
+using namespace Gadgetron;
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection;
+using namespace Gadgetron::Server::Connection::Stream;
+
+namespace {
+    constexpr size_t number_of_messages = 50000;
+    constexpr size_t samples = 128, channels = 4;
+
+    struct Readout {
+        size_t index;
+        size_t hops;
+        hoNDArray<std::complex<float>> data;
+    };
+
+    class Hop : public PureGadget<Readout, Readout> {
+    public:
+        Hop() : PureGadget(GadgetProperties{}) {}
+
+        Readout process_function(Readout readout) const override {
+            readout.hops++;
+            return readout;
+        }
+
+        bool lightweight() const override { return true; }
+    };
+
+    class Reporter : public ErrorReporter {
+    public:
+        void operator()(const std::string& location, const std::string& message) override {
+            std::cerr << location << ": " << message << std::endl;
+        }
+    };
+
+    struct Result {
+        double seconds, cpu_seconds;
+    };
+
+    template <class RUN> Result measure(size_t chain_length, RUN run_chain) {
+        auto input  = make_channel<MessageChannel>();
+        auto output = make_channel<MessageChannel>();
+
+        // The input is queued up front and the output checked afterwards, so only the chain runs while the clocks do.
+        for (size_t i = 0; i < number_of_messages; i++)
+            input.output.push(Readout{ i, 0, hoNDArray<std::complex<float>>(samples, channels) });
+        { auto closed = std::move(input.output); }
+
+        auto cpu_start  = std::clock();
+        auto wall_start = std::chrono::steady_clock::now();
+
+        run_chain(std::move(input.input), std::move(output.output));
+
+        Result result{ std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count(),
+                       double(std::clock() - cpu_start) / CLOCKS_PER_SEC };
+
+        size_t received = 0;
+        for (auto message : output.input) {
+            auto readout = force_unpack<Readout>(std::move(message));
+            if (readout.index != received++ || readout.hops != chain_length)
+                throw std::runtime_error("Messages lost, reordered or not processed by every gadget");
+        }
+        if (received != number_of_messages) throw std::runtime_error("Messages lost");
+
+        return result;
+    }
+
+    Result threaded(size_t chain_length) {
+        return measure(chain_length, [=](GenericInputChannel input, OutputChannel output) {
+            std::vector<std::unique_ptr<Node>> nodes;
+            std::vector<GenericInputChannel> inputs;
+            std::vector<OutputChannel> outputs;
+
+            inputs.push_back(std::move(input));
+            for (size_t i = 0; i < chain_length; i++) {
+                nodes.push_back(std::make_unique<Hop>());
+                if (i + 1 == chain_length) break;
+                auto channel = make_channel<MessageChannel>();
+                inputs.push_back(std::move(channel.input));
+                outputs.push_back(std::move(channel.output));
+            }
+            outputs.push_back(std::move(output));
+
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < chain_length; i++) {
+                threads.emplace_back(
+                    [](Node& node, GenericInputChannel in, OutputChannel out) { node.process(in, out); },
+                    std::ref(*nodes[i]), std::move(inputs[i]), std::move(outputs[i]));
+            }
+            for (auto& thread : threads) thread.join();
+        });
+    }
+
+    Result fused(size_t chain_length) {
+        return measure(chain_length, [=](GenericInputChannel input, OutputChannel output) {
+            std::vector<Fused::Member> members;
+            for (size_t i = 0; i < chain_length; i++)
+                members.push_back(Fused::Member{ "Hop" + std::to_string(i), std::make_unique<Hop>() });
+
+            Reporter reporter;
+            ErrorHandler error_handler{ reporter, "benchmark" };
+            Fused(std::move(members)).process(std::move(input), std::move(output), error_handler);
+        });
+    }
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << number_of_messages << " messages of " << samples << " samples x " << channels << " channels"
+              << std::endl;
+
+    for (size_t chain_length : { 2, 4, 8, 15 }) {
+        auto separate = threaded(chain_length);
+        auto together = fused(chain_length);
+
+        std::cout << chain_length << " gadgets" << std::endl;
+        std::cout << "  thread per gadget: " << std::setw(10) << number_of_messages / separate.seconds / 1e3
+                  << " k messages/s, " << std::setw(6) << 1e6 * separate.cpu_seconds / number_of_messages
+                  << " us cpu per message" << std::endl;
+        std::cout << "  fused:             " << std::setw(10) << number_of_messages / together.seconds / 1e3
+                  << " k messages/s, " << std::setw(6) << 1e6 * together.cpu_seconds / number_of_messages
+                  << " us cpu per message" << std::endl;
+    }
+
+    return 0;
+}
@@ -12,6 +12,8 @@
 #include "writers/GadgetIsmrmrdWriter.h"
 #include "writers/IsmrmrdImageArrayWriter.h"
 #include "writers/ImageWriter.h"
+#include "io/shared_memory.h"
+#include <boost/filesystem.hpp>
 #include <gtest/gtest.h>
 #include <sstream>
 
@@ -81,6 +83,43 @@ TEST(ReadWriteTest, BufferTest) {
     ASSERT_EQ(rbit.data_.data_, value.rbit_.back().data_.data_);
 }
 
+TEST(ReadWriteTest, BufferSharedMemoryTest) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    IsmrmrdReconData recondata;
+    recondata.rbit_.push_back(IsmrmrdReconBit());
+
+    // Large enough to go through shared memory; the small reference array stays inline.
+    auto& rbit       = recondata.rbit_.back();
+    rbit.data_.data_ = hoNDArray<std::complex<float>>(128, 64, 4);
+    for (size_t i = 0; i < rbit.data_.data_.size(); i++) rbit.data_.data_[i] = std::complex<float>(float(i), 1.0f);
+    rbit.ref_        = IsmrmrdDataBuffered();
+    rbit.ref_->data_ = hoNDArray<std::complex<float>>(16, 16);
+    rbit.ref_->data_.fill(42.0f);
+
+    auto stream = std::stringstream();
+    Core::IO::enable_shared_memory(stream);
+
+    auto message = Core::Message(recondata);
+    auto reader  = Core::Readers::BufferReader();
+    auto writer  = Core::Writers::BufferWriter();
+
+    writer.write(stream, std::move(message));
+
+    EXPECT_LT(stream.str().size(), rbit.data_.data_.get_number_of_bytes());
+    ASSERT_EQ(Core::IO::read<uint16_t>(stream), GADGET_MESSAGE_RECONDATA);
+
+    auto unpacked = Core::unpack<IsmrmrdReconData>(reader.read(stream));
+
+    ASSERT_TRUE(bool(unpacked));
+
+    auto value = *unpacked;
+
+    ASSERT_EQ(rbit.data_.data_, value.rbit_.back().data_.data_);
+    ASSERT_EQ(rbit.ref_->data_, value.rbit_.back().ref_->data_);
+}
+
 TEST(ReadWriteTest, ImageArrayTest) {
     using namespace Gadgetron;
     using namespace Gadgetron::Core;
@@ -140,3 +179,116 @@ TEST(ReadWriteTest, ImageTest) {
 
     ASSERT_EQ(data, std::get<hoNDArray<int>>(value));
 }
+
+TEST(ReadWriteTest, AcquisitionSharedMemoryTest) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    auto stream = std::stringstream{};
+    Core::IO::enable_shared_memory(stream);
+
+    auto acquisition_header               = ISMRMRD::AcquisitionHeader();
+    acquisition_header.number_of_samples  = 1024;
+    acquisition_header.active_channels    = 32;
+    acquisition_header.available_channels = 32;
+    acquisition_header.trajectory_dimensions = 2;
+
+    auto data = hoNDArray<std::complex<float>>(1024, 32);
+    for (size_t i = 0; i < data.size(); i++) data[i] = std::complex<float>(float(i), 1.0f);
+    auto trajectory = hoNDArray<float>(2, 1024);
+    trajectory.fill(0.5f);
+
+    auto message = Core::Message(acquisition_header, Core::optional<hoNDArray<float>>(trajectory), data);
+
+    auto reader = GadgetIsmrmrdAcquisitionMessageReader();
+    auto writer = GadgetIsmrmrdAcquisitionMessageWriter();
+
+    writer.write(stream, std::move(message));
+
+    EXPECT_LT(stream.str().size(), data.get_number_of_bytes());
+    ASSERT_EQ(Core::IO::read<uint16_t>(stream), GADGET_MESSAGE_ISMRMRD_ACQUISITION);
+
+    auto unpacked = Core::unpack<Core::Acquisition>(reader.read(stream));
+
+    ASSERT_TRUE(bool(unpacked));
+
+    auto value = *unpacked;
+    ASSERT_EQ(data, std::get<hoNDArray<std::complex<float>>>(value));
+    ASSERT_EQ(trajectory, *std::get<optional<hoNDArray<float>>>(value));
+}
+
+TEST(ReadWriteTest, ImageSharedMemoryTest) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    auto header = ISMRMRD::ImageHeader{};
+    header.matrix_size[0] = 256;
+    header.matrix_size[1] = 256;
+    header.matrix_size[2] = 1;
+    header.channels = 1;
+
+    auto data = hoNDArray<float>(256,256,1,1);
+    for (size_t i = 0; i < data.size(); i++) data[i] = float(i);
+    auto meta = ISMRMRD::MetaContainer();
+
+    auto stream  = std::stringstream();
+    Core::IO::enable_shared_memory(stream);
+
+    auto message = Core::Message(header,data,meta);
+    auto reader  = Core::Readers::ImageReader();
+    auto writer  = Core::Writers::ImageWriter();
+
+    writer.write(stream, std::move(message));
+
+    EXPECT_LT(stream.str().size(), data.get_number_of_bytes());
+    ASSERT_EQ(Core::IO::read<uint16_t>(stream), GADGET_MESSAGE_ISMRMRD_IMAGE);
+
+    auto unpacked = Core::unpack<Image<float>>(reader.read(stream));
+
+    ASSERT_TRUE(bool(unpacked));
+
+    auto value = *unpacked;
+    ASSERT_EQ(data, std::get<hoNDArray<float>>(value));
+}
+
+TEST(ReadWriteTest, ReleaseSharedMemoryTest) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    auto stream = std::stringstream();
+    Core::IO::enable_shared_memory(stream);
+
+    auto data = hoNDArray<float>(128, 128);
+    data.fill(42.0f);
+    Core::IO::write(stream, data);
+
+    // Written, but never read; the segment is left to release_shared_memory.
+    Core::IO::read<std::vector<size_t>>(stream);
+    ASSERT_EQ(Core::IO::read<uint8_t>(stream), 1);
+    auto name = Core::IO::read_string_from_stream<uint16_t>(stream);
+
+    ASSERT_TRUE(boost::filesystem::exists("/dev/shm/" + name));
+    Core::IO::release_shared_memory(stream);
+    EXPECT_FALSE(boost::filesystem::exists("/dev/shm/" + name));
+}
+
+TEST(ReadWriteTest, SharedMemorySegmentsAreOwnerOnly) {
+    using namespace Gadgetron;
+    using namespace Gadgetron::Core;
+
+    auto stream = std::stringstream();
+    Core::IO::enable_shared_memory(stream);
+
+    auto data = hoNDArray<float>(128, 128);
+    data.fill(42.0f);
+    Core::IO::write(stream, data);
+
+    Core::IO::read<std::vector<size_t>>(stream);
+    ASSERT_EQ(Core::IO::read<uint8_t>(stream), 1);
+    auto name = Core::IO::read_string_from_stream<uint16_t>(stream);
+
+    auto permissions = boost::filesystem::status("/dev/shm/" + name).permissions();
+    EXPECT_EQ(permissions, boost::filesystem::owner_read | boost::filesystem::owner_write);
+
+    Core::IO::release_shared_memory(stream);
+}
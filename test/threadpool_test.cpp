@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 #include "ThreadPool.h"
 
+using namespace Gadgetron;
 using namespace Gadgetron::Core;
 TEST(ThreadPoolTest,VoidTest){
     ThreadPool pool{4};
@@ -24,3 +25,49 @@ TEST(ThreadPoolTest,moveTest){
     pool.join();
 
 }
+
+TEST(ThreadPoolTest,limitsConcurrency){
+    WorkStealingExecutor executor{4};
+    ThreadPool pool{2, executor};
+
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 32; i++) {
+        futures.push_back(pool.async([&]() {
+            int current = ++running;
+            int previous = max_running;
+            while (current > previous && !max_running.compare_exchange_weak(previous, current));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            running--;
+        }));
+    }
+    for (auto& future : futures) future.get();
+    pool.join();
+
+    EXPECT_LE(max_running, 2);
+}
+
+TEST(WorkStealingExecutorTest,parallelFor){
+    WorkStealingExecutor executor{4};
+    std::vector<size_t> values(10000, 0);
+
+    executor.parallel_for(0, values.size(), [&](size_t i) { values[i] = i; });
+
+    for (size_t i = 0; i < values.size(); i++) EXPECT_EQ(values[i], i);
+}
+
+TEST(WorkStealingExecutorTest,nestedParallelForAndExceptions){
+    WorkStealingExecutor executor{2};
+    std::atomic<size_t> count{0};
+
+    executor.parallel_for(0, 16, [&](size_t) {
+        executor.parallel_for(0, 16, [&](size_t) { count++; });
+    });
+    EXPECT_EQ(count, 256u);
+
+    EXPECT_THROW(
+        executor.parallel_for(0, 8, [](size_t i) { if (i == 3) throw std::runtime_error("Failure"); }),
+        std::runtime_error
+    );
+}
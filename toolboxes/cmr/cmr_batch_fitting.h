@@ -0,0 +1,144 @@
+/** \file   cmr_batch_fitting.h
+    \brief  Levenberg-Marquardt fitting of two parameter exponential models for many pixels at once
+            Pixels are stored along lanes, e.g. y is [N lanes], so every step of the fit is a loop over
+            lanes with no branches, which the compiler vectorises. Every lane stops updating once it converges.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+namespace Gadgetron {
+
+    /// number of pixels fitted together
+    constexpr size_t cmr_fitting_lanes = 16;
+
+    /// T1 saturation recovery, y = A * ( 1-exp(-ti/T1) ), with its derivatives along A and T1
+    struct CmrT1SRModel
+    {
+        template <typename T> static void evaluate(T ti, T A, T T1, T& y, T& dA, T& dT1)
+        {
+            T rb = T(1) / (std::abs(T1) < FLT_EPSILON ? std::copysign(T(FLT_EPSILON), T1) : T1);
+            T e = std::exp(-ti * rb);
+            y = A - A * e;
+            dA = 1 - e;
+            dT1 = -A * e * ti * rb * rb;
+        }
+    };
+
+    /// T2 decay, y = A * exp(-te/T2), with its derivatives along A and T2
+    struct CmrT2Model
+    {
+        template <typename T> static void evaluate(T te, T A, T T2, T& y, T& dA, T& dT2)
+        {
+            T rb = T(1) / (std::abs(T2) < FLT_EPSILON ? std::copysign(T(FLT_EPSILON), T2) : T2);
+            T e = std::exp(-te * rb);
+            y = A * e;
+            dA = e;
+            dT2 = A * e * te * rb * rb;
+        }
+    };
+
+    /// fit cmr_fitting_lanes pixels with the analytic Jacobian of the model
+    /// ti: [num] time points; yi: [num lanes] signal of every pixel
+    /// A, B: [lanes] the two parameters; the initial guess on input, the fit on output
+    /// a lane stops when an accepted step changes its cost by less than thres_fun relatively
+    template <typename Model, typename T>
+    void levenberg_marquardt_fit(const T* ti, size_t num, const T* yi, T* A, T* B, size_t max_iter, T thres_fun)
+    {
+        const size_t L = cmr_fitting_lanes;
+
+        T cost[L], cost_new[L], lambda[L], active[L];
+        T A_new[L], B_new[L];
+        T haa[L], hab[L], hbb[L], ga[L], gb[L];
+
+        auto compute_cost = [&](const T* a, const T* b, T* c)
+        {
+            for (size_t l = 0; l < L; l++) c[l] = 0;
+
+            for (size_t n = 0; n < num; n++)
+            {
+#pragma omp simd
+                for (size_t l = 0; l < L; l++)
+                {
+                    T y, da, db;
+                    Model::evaluate(ti[n], a[l], b[l], y, da, db);
+                    T r = yi[n*L + l] - y;
+                    c[l] += r*r;
+                }
+            }
+        };
+
+        compute_cost(A, B, cost);
+
+        for (size_t l = 0; l < L; l++)
+        {
+            lambda[l] = T(1e-3);
+            active[l] = 1;
+        }
+
+        for (size_t iter = 0; iter < max_iter; iter++)
+        {
+            for (size_t l = 0; l < L; l++)
+            {
+                haa[l] = hab[l] = hbb[l] = ga[l] = gb[l] = 0;
+            }
+
+            // J'J and J'r, accumulated over the time points
+            for (size_t n = 0; n < num; n++)
+            {
+#pragma omp simd
+                for (size_t l = 0; l < L; l++)
+                {
+                    T y, da, db;
+                    Model::evaluate(ti[n], A[l], B[l], y, da, db);
+                    T r = yi[n*L + l] - y;
+
+                    haa[l] += da*da;
+                    hab[l] += da*db;
+                    hbb[l] += db*db;
+                    ga[l] += da*r;
+                    gb[l] += db*r;
+                }
+            }
+
+            // damped 2x2 normal equations, solved directly
+#pragma omp simd
+            for (size_t l = 0; l < L; l++)
+            {
+                T daa = haa[l] * (1 + lambda[l]);
+                T dbb = hbb[l] * (1 + lambda[l]);
+                T det = daa*dbb - hab[l] * hab[l];
+                T scale = (std::abs(det) > FLT_MIN) ? active[l] / det : T(0);
+
+                A_new[l] = A[l] + scale * (dbb*ga[l] - hab[l] * gb[l]);
+                B_new[l] = B[l] + scale * (daa*gb[l] - hab[l] * ga[l]);
+            }
+
+            compute_cost(A_new, B_new, cost_new);
+
+            T still_active = 0;
+
+#pragma omp simd reduction(+:still_active)
+            for (size_t l = 0; l < L; l++)
+            {
+                bool accept = active[l] > 0 && cost_new[l] < cost[l];
+                bool converged = accept && (cost[l] - cost_new[l]) <= thres_fun * cost[l];
+
+                A[l] = accept ? A_new[l] : A[l];
+                B[l] = accept ? B_new[l] : B[l];
+                cost[l] = accept ? cost_new[l] : cost[l];
+                lambda[l] = accept ? lambda[l] * T(0.1) : lambda[l] * T(10);
+
+                // a lane whose damping keeps growing cannot improve any further
+                active[l] = (converged || lambda[l] > T(1e10)) ? T(0) : active[l];
+                still_active += active[l];
+            }
+
+            if (still_active == 0) break;
+        }
+    }
+}
@@ -189,6 +189,8 @@ CmrParametricMapping<T>::CmrParametricMapping()
     max_fun_eval_ = 100;
     thres_fun_ = 1e-5;
 
+    use_levenberg_marquardt_ = false;
+
     max_map_value_ = -1;
     min_map_value_ = 0;
 
@@ -260,99 +262,140 @@ void CmrParametricMapping<T>::perform_parametric_mapping()
 
         if (this->perform_timing_) { gt_timer_.start("perform pixel-wise mapping ... "); }
 
-        long long ro, e1;
+        // only pixels inside the mask are fitted; listing them first keeps masked pixels out of the thread schedule
+        // a pixel is recorded as its offset into [RO E1 S SLC]
+        size_t plane = RO*E1;
+
+        std::vector<size_t> pixels;
+        pixels.reserve(plane*S*SLC);
 
         for (slc = 0; slc < SLC; slc++)
         {
             for (s = 0; s < S; s++)
             {
-                T* pData = &data_(0, 0, 0, s, slc);
+                T* pMaskCurr = NULL;
+                if (pMask != NULL)
+                {
+                    pMaskCurr = pMask + s*RO*E1 + slc*S*RO*E1;
+                }
 
-                T* pMap = &map_(0, 0, s, slc);
-                T* pPara = &para_(0, 0, 0, s, slc);
+                for (size_t offset = 0; offset < plane; offset++)
+                {
+                    if (pMaskCurr != NULL && pMaskCurr[offset] <= 0) continue;
+                    pixels.push_back(offset + (s + slc*S)*plane);
+                }
+            }
+        }
+
+        const size_t L = cmr_fitting_lanes;
+        const bool batched = this->has_batch_fitting();
+
+        // fitting time varies a lot between pixels, so batches of pixels are handed out dynamically
+        long long num_batches = (long long)((pixels.size() + L - 1) / L);
+        long long batch;
+
+#pragma omp parallel private(batch, n) shared(pixels, plane, num_batches, num_ti, NUM)
+        {
+            std::vector<T> yi(num_ti, 0);
+            std::vector<T> guess(NUM + 1, 0);
+            std::vector<T> bi(NUM + 1, 0);
+            std::vector<T> sd(NUM + 1, 0);
 
-                T* pMapSD = NULL;
-                T* pParaSD = NULL;
-                if (this->compute_SD_maps_)
+            std::vector<T> yi_lanes(num_ti*L, 0);
+            std::vector<T> guess_lanes(NUM*L, 0);
+            std::vector<T> bi_lanes(NUM*L, 0);
+            std::vector<T> map_lanes(L, 0);
+
+            T map_v(0), map_sd(0);
+
+            auto load_pixel = [&](size_t p)
+            {
+                const T* pData = data_.begin() + (p / plane)*plane*N + p%plane;
+                for (n = 0; n < num_ti; n++)
                 {
-                    pMapSD = &sd_map_(0, 0, s, slc);
-                    pParaSD = &sd_para_(0, 0, 0, s, slc);
+                    yi[n] = pData[n*plane];
                 }
+            };
 
-                T* pMaskCurr = NULL;
-                if (pMask != NULL)
+#pragma omp for schedule(dynamic)
+            for (batch = 0; batch < num_batches; batch++)
+            {
+                size_t first = batch*L;
+                size_t count = std::min(L, pixels.size() - first);
+
+                if (batched)
                 {
-                    pMaskCurr = pMask + s*RO*E1 + slc*S*RO*E1;
+                    // a partial batch repeats its last pixel in the spare lanes, whose results are dropped
+                    for (size_t l = 0; l < L; l++)
+                    {
+                        load_pixel(pixels[first + std::min(l, count - 1)]);
+                        this->get_initial_guess(ti_, yi, guess);
+
+                        for (n = 0; n < num_ti; n++) yi_lanes[n*L + l] = yi[n];
+                        for (n = 0; n < NUM; n++) guess_lanes[n*L + l] = guess[n];
+                    }
+
+                    this->compute_map_batch(ti_, &yi_lanes[0], &guess_lanes[0], &bi_lanes[0], &map_lanes[0]);
                 }
 
-#pragma omp parallel private(e1, ro, n) shared(RO, E1, pMask, pMaskCurr, pData, pMap, pMapSD, pPara, pParaSD, num_ti, NUM)
+                for (size_t l = 0; l < count; l++)
                 {
-                    std::vector<T> yi(num_ti, 0);
-                    std::vector<T> guess(NUM + 1, 0);
-                    std::vector<T> bi(NUM + 1, 0);
-                    std::vector<T> sd(NUM + 1, 0);
+                    size_t p = pixels[first + l];
+                    size_t offset = p % plane;
+                    size_t index = p / plane;
 
-                    T map_v(0), map_sd(0);
+                    load_pixel(p);
 
-#pragma omp for 
-                    for (e1 = 0; e1 < E1; e1++)
+                    if (batched)
                     {
-                        for (ro = 0; ro < RO; ro++)
-                        {
-                            long long offset = ro + e1*RO;
-
-                            if (pMask != NULL)
-                            {
-                                if (pMaskCurr[offset] <= 0)
-                                    continue;
-                            }
+                        for (n = 0; n < NUM; n++) bi[n] = bi_lanes[n*L + l];
+                        map_v = map_lanes[l];
+                    }
+                    else
+                    {
+                        // estimate initial para
+                        this->get_initial_guess(ti_, yi, guess);
 
-                            // get data vector
-                            for (n = 0; n < num_ti; n++)
-                            {
-                                yi[n] = pData[offset + n*RO*E1];
-                            }
+                        // perform mapping
+                        this->compute_map(ti_, yi, guess, bi, map_v);
+                    }
 
-                            // estimate initial para
-                            this->get_initial_guess(ti_, yi, guess);
+                    map_.begin()[p] = map_v;
 
-                            // perform mapping
-                            this->compute_map(ti_, yi, guess, bi, map_v);
+                    T* pPara = para_.begin() + index*plane*NUM + offset;
+                    for (n = 0; n < NUM; n++)
+                    {
+                        pPara[n*plane] = bi[n];
+                    }
 
-                            pMap[offset] = map_v;
+                    // compute SD if needed
+                    if (this->compute_SD_maps_)
+                    {
+                        try
+                        {
+                            this->compute_sd(ti_, yi, bi, sd, map_sd);
+                        }
+                        catch(...)
+                        {
                             for (n = 0; n < NUM; n++)
                             {
-                                pPara[offset + n*RO*E1] = bi[n];
+                                sd[n] = 0;
                             }
 
-                            // compute SD if needed
-                            if (this->compute_SD_maps_)
-                            {
-                                try
-                                {
-                                    this->compute_sd(ti_, yi, bi, sd, map_sd);
-                                }
-                                catch(...)
-                                {
-                                    for (n = 0; n < NUM; n++)
-                                    {
-                                        sd[n] = 0;
-                                    }
-
-                                    map_sd = 0;
-                                }
-
-                                pMapSD[offset] = map_sd;
-                                for (n = 0; n < NUM; n++)
-                                {
-                                    pParaSD[offset + n*RO*E1] = sd[n];
-                                }
-                            }
+                            map_sd = 0;
+                        }
+
+                        sd_map_.begin()[p] = map_sd;
+
+                        T* pParaSD = sd_para_.begin() + index*plane*NUM + offset;
+                        for (n = 0; n < NUM; n++)
+                        {
+                            pParaSD[n*plane] = sd[n];
                         }
                     }
-                } // openmp
+                }
             }
-        }
+        } // openmp
 
         if (this->perform_timing_) { gt_timer_.stop(); }
 
@@ -435,6 +478,18 @@ void CmrParametricMapping<T>::compute_map(const std::vector<T>& ti, const std::v
     map_v = 0;
 }
 
+template <typename T>
+bool CmrParametricMapping<T>::has_batch_fitting() const
+{
+    return false;
+}
+
+template <typename T>
+void CmrParametricMapping<T>::compute_map_batch(const VectorType& ti, const T* yi, const T* guess, T* bi, T* map_v)
+{
+    GADGET_THROW("CmrParametricMapping<T>::compute_map_batch(...) is not implemented for this mapping ... ");
+}
+
 template <typename T>
 void CmrParametricMapping<T>::compute_sd(const std::vector<T>& ti, const std::vector<T>& yi, const std::vector<T>& bi, std::vector<T>& sd, T& map_sd)
 {
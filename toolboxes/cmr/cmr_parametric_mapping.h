@@ -8,6 +8,7 @@
 #pragma once
 
 #include "cmr_export.h"
+#include "cmr_batch_fitting.h"
 
 #include "GadgetronTimer.h"
 
@@ -102,6 +103,10 @@ namespace Gadgetron {
         /// threshold for minimal function value change
         T thres_fun_;
 
+        /// whether to fit with Levenberg-Marquardt, many pixels at once, instead of the per-pixel simplex search
+        /// only used by mappings with a batched fitting, see has_batch_fitting()
+        bool use_levenberg_marquardt_;
+
         /// maximal valid value of map
         T max_map_value_;
         T min_map_value_;
@@ -137,6 +142,13 @@ namespace Gadgetron {
         /// compute SD values for every parameters in bi
         virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
+        /// whether compute_map_batch is used instead of compute_map
+        virtual bool has_batch_fitting() const;
+
+        /// compute map values for cmr_fitting_lanes pixels at once
+        /// yi: [num_ti lanes], guess and bi: [NUM lanes], map_v: [lanes]
+        virtual void compute_map_batch(const VectorType& ti, const T* yi, const T* guess, T* bi, T* map_v);
+
         /// compute SD values from gradient vector
         virtual void compute_sd_impl(const VectorType& ti, const VectorType& yi, const VectorType& bi, const VectorType& res, const hoNDArray<T>& grad, VectorType& sd);
 
@@ -97,6 +97,40 @@ void CmrT1SRMapping<T>::compute_map(const VectorType& ti, const VectorType& yi,
     }
 }
 
+template <typename T>
+bool CmrT1SRMapping<T>::has_batch_fitting() const
+{
+    return use_levenberg_marquardt_;
+}
+
+template <typename T>
+void CmrT1SRMapping<T>::compute_map_batch(const VectorType& ti, const T* yi, const T* guess, T* bi, T* map_v)
+{
+    try
+    {
+        const size_t L = cmr_fitting_lanes;
+
+        std::copy(guess, guess + 2*L, bi);
+        Gadgetron::levenberg_marquardt_fit<CmrT1SRModel>(&ti[0], ti.size(), yi, bi, bi + L, max_iter_, thres_fun_);
+
+        for (size_t l = 0; l < L; l++)
+        {
+            map_v[l] = 0;
+
+            if (bi[l] > 0 && bi[L + l] > 0)
+            {
+                map_v[l] = bi[L + l];
+                if (map_v[l] >= max_map_value_) map_v[l] = hole_marking_value_;
+                if (map_v[l] <= min_map_value_) map_v[l] = hole_marking_value_;
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrT1SRMapping<T>::compute_map_batch(...) ... ");
+    }
+}
+
 template <typename T>
 void CmrT1SRMapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd)
 {
@@ -9,7 +9,6 @@
 #include "hoNDArray_reductions.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
-#include "hoNDArray_linalg.h"
 
 #include "simplexLagariaSolver.h"
 #include "twoParaExpDecayOperator.h"
@@ -62,16 +61,23 @@ void CmrT2Mapping<T>::get_initial_guess(const VectorType& ti, const VectorType&
             }
         }
 
-        hoNDArray<T> log_yi(numpts), bi_est(2);
-        hoNDArray<T> xi(numpts);
-        for (size_t i = 0; i < numpts; i++)
+        // least square line through (ti, log(yi)), in closed form to avoid allocating for every pixel
+        double sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (i = 0; i < numpts; i++)
         {
-            xi[i] = ti[i];
-            log_yi[i] = std::log(yi[i]);
+            double x = ti[i];
+            double y = std::log(yi[i]);
+            sx += x;
+            sy += y;
+            sxx += x*x;
+            sxy += x*y;
         }
 
-        T a, b;
-        Gadgetron::linFit(xi, log_yi, a, b);
+        double det = numpts*sxx - sx*sx;
+        GADGET_CHECK_THROW(std::abs(det) > 0);
+
+        T a = (T)((numpts*sxy - sx*sy) / det);
+        T b = (T)((sy - a*sx) / numpts);
 
         guess[0] = std::exp(b);
         guess[1] = -1.0 / a;
@@ -134,6 +140,40 @@ void CmrT2Mapping<T>::compute_map(const VectorType& ti, const VectorType& yi, co
     }
 }
 
+template <typename T>
+bool CmrT2Mapping<T>::has_batch_fitting() const
+{
+    return use_levenberg_marquardt_;
+}
+
+template <typename T>
+void CmrT2Mapping<T>::compute_map_batch(const VectorType& ti, const T* yi, const T* guess, T* bi, T* map_v)
+{
+    try
+    {
+        const size_t L = cmr_fitting_lanes;
+
+        std::copy(guess, guess + 2*L, bi);
+        Gadgetron::levenberg_marquardt_fit<CmrT2Model>(&ti[0], ti.size(), yi, bi, bi + L, max_iter_, thres_fun_);
+
+        for (size_t l = 0; l < L; l++)
+        {
+            map_v[l] = 0;
+
+            if (bi[l] > 0 && bi[L + l] > 0)
+            {
+                map_v[l] = bi[L + l];
+                if (map_v[l] >= max_map_value_) map_v[l] = hole_marking_value_;
+                if (map_v[l] <= min_map_value_) map_v[l] = hole_marking_value_;
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in CmrT2Mapping<T>::compute_map_batch(...) ... ");
+    }
+}
+
 template <typename T>
 void CmrT2Mapping<T>::compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd)
 {
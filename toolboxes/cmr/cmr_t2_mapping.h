@@ -49,6 +49,10 @@ public:
     /// compute SD values for every parameters in bi
     virtual void compute_sd(const VectorType& ti, const VectorType& yi, const VectorType& bi, VectorType& sd, T& map_sd);
 
+    /// Levenberg-Marquardt fitting of many pixels at once, if use_levenberg_marquardt_ is set
+    virtual bool has_batch_fitting() const;
+    virtual void compute_map_batch(const VectorType& ti, const T* yi, const T* guess, T* bi, T* map_v);
+
     /// two parameters, A, T1
     virtual size_t get_num_of_paras() const;
 
@@ -70,6 +74,7 @@ public:
     using BaseClass::max_iter_;
     using BaseClass::max_fun_eval_;
     using BaseClass::thres_fun_;
+    using BaseClass::use_levenberg_marquardt_;
     using BaseClass::max_map_value_;
     using BaseClass::min_map_value_;
 
@@ -8,6 +8,8 @@
 #include "log.h"
 
 #include <new>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
@@ -119,6 +121,10 @@ namespace Gadgetron{
 
         void clear();
 
+        /// Gives the array memory of its own, if it shares its memory with copies of itself (see hoNDArray::share).
+        /// Non-const access to the data does this implicitly.
+        virtual void make_unique() {}
+
     
 
         /// whether a point is within the array range
@@ -145,6 +151,26 @@ namespace Gadgetron{
         T* data_;
         size_t elements_;
         bool delete_data_on_destruct_;
+
+        // Set while data_ may be shared with copies of the array; these hold the same storage.
+        std::shared_ptr<T> shared_storage_;
+
+        // Whether shared_storage_ is set, for the non-const accessors to check while another thread may be
+        // detaching the array. Copies like a bool.
+        struct SharingFlag {
+            std::atomic<bool> value{ false };
+            SharingFlag() = default;
+            SharingFlag(const SharingFlag& other) : value(other.value.load(std::memory_order_relaxed)) {}
+            SharingFlag& operator=(const SharingFlag& other) {
+                value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                return *this;
+            }
+        } sharing_;
+
+        void set_shared_storage(std::shared_ptr<T> storage) {
+            shared_storage_ = std::move(storage);
+            sharing_.value.store(bool(shared_storage_), std::memory_order_release);
+        }
     };
 
     template <typename T> 
@@ -306,6 +332,7 @@ namespace Gadgetron{
     template <typename T>
     inline T* NDArray<T>::get_data_ptr()
     {
+        if (sharing_.value.load(std::memory_order_acquire)) make_unique();
         return data_;
     }
 
@@ -318,6 +345,7 @@ namespace Gadgetron{
     template <typename T>
     T* NDArray<T>::data()
     {
+        if (sharing_.value.load(std::memory_order_acquire)) make_unique();
         return data_;
     }
 
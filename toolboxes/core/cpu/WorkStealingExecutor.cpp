@@ -0,0 +1,183 @@
+#include "WorkStealingExecutor.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "log.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    thread_local const Gadgetron::WorkStealingExecutor* current_executor = nullptr;
+    thread_local size_t current_worker = 0;
+
+    // Parses a sysfs cpulist such as "0-3,8-11".
+    std::vector<int> parse_cpu_list(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last  = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++)
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    // Cores ordered NUMA node by node, so consecutive workers share a memory controller.
+    std::vector<int> numa_ordered_cpus() {
+        std::vector<int> cpus;
+        for (int node = 0;; node++) {
+            std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!cpulist)
+                break;
+            std::string list;
+            std::getline(cpulist, list);
+            if (list.empty())
+                continue;
+            auto node_cpus = parse_cpu_list(list);
+            cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+        }
+
+        if (cpus.empty())
+            for (int cpu = 0; cpu < int(std::thread::hardware_concurrency()); cpu++)
+                cpus.push_back(cpu);
+        return cpus;
+    }
+
+    unsigned int default_worker_count() {
+        if (auto threads = std::getenv("GADGETRON_EXECUTOR_THREADS")) {
+            auto count = std::strtoul(threads, nullptr, 10);
+            if (count)
+                return count;
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    bool default_pinning() {
+        auto pin = std::getenv("GADGETRON_EXECUTOR_PIN_THREADS");
+        return pin && std::string(pin) != "0";
+    }
+}
+
+namespace Gadgetron {
+
+    WorkStealingExecutor::WorkStealingExecutor(unsigned int worker_count, bool pin_threads) {
+        worker_count = std::max(1u, worker_count);
+        for (auto i = 0u; i < worker_count; i++)
+            workers.emplace_back(std::make_unique<Worker>());
+
+        for (auto i = 0u; i < worker_count; i++) {
+            threads.emplace_back([this, i]() { this->run_worker(i); });
+            if (pin_threads)
+                pin_to_core(threads.back(), i);
+        }
+    }
+
+    WorkStealingExecutor::~WorkStealingExecutor() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    WorkStealingExecutor& WorkStealingExecutor::global() {
+        static WorkStealingExecutor executor(default_worker_count(), default_pinning());
+        return executor;
+    }
+
+    void WorkStealingExecutor::submit(std::unique_ptr<Task> task) {
+        auto index = is_worker_thread() ? current_worker : next_worker++ % workers.size();
+        pending++;
+        {
+            std::lock_guard<std::mutex> guard(workers[index]->m);
+            workers[index]->tasks.push_back(std::move(task));
+        }
+        if (sleepers.load()) {
+            std::lock_guard<std::mutex> guard(sleep_mutex);
+            wakeup.notify_one();
+        }
+    }
+
+    bool WorkStealingExecutor::is_worker_thread() const {
+        return current_executor == this;
+    }
+
+    unsigned int WorkStealingExecutor::size() const {
+        return static_cast<unsigned int>(workers.size());
+    }
+
+    WorkStealingExecutor::Statistics WorkStealingExecutor::statistics() const {
+        return Statistics{ workers.size(), pending.load(), executed.load(), stolen.load() };
+    }
+
+    std::unique_ptr<WorkStealingExecutor::Task> WorkStealingExecutor::pop_local(size_t index) {
+        auto& worker = *workers[index];
+        std::lock_guard<std::mutex> guard(worker.m);
+        if (worker.tasks.empty())
+            return nullptr;
+        auto task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return task;
+    }
+
+    std::unique_ptr<WorkStealingExecutor::Task> WorkStealingExecutor::steal(size_t thief) {
+        for (size_t offset = 1; offset < workers.size(); offset++) {
+            auto& victim = *workers[(thief + offset) % workers.size()];
+            std::unique_lock<std::mutex> lock(victim.m, std::try_to_lock);
+            if (!lock || victim.tasks.empty())
+                continue;
+            auto task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen++;
+            return task;
+        }
+        return nullptr;
+    }
+
+    void WorkStealingExecutor::run_worker(size_t index) {
+        current_executor = this;
+        current_worker   = index;
+
+        while (true) {
+            auto task = pop_local(index);
+            if (!task)
+                task = steal(index);
+
+            if (task) {
+                pending--;
+                task->execute();
+                executed++;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleepers++;
+            wakeup.wait(lock, [this]() { return stopping.load() || pending.load() > 0; });
+            sleepers--;
+            if (stopping && !pending)
+                return;
+        }
+    }
+
+    void WorkStealingExecutor::pin_to_core(std::thread& thread, size_t index) {
+#if defined(__linux__)
+        static const auto cpus = numa_ordered_cpus();
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpus[index % cpus.size()], &cpuset);
+        if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset))
+            GWARN_STREAM("Unable to pin executor worker " << index << " to core " << cpus[index % cpus.size()]);
+#endif
+    }
+}
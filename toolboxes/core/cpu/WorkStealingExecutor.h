@@ -0,0 +1,156 @@
+/** \file WorkStealingExecutor.h
+    \brief Process wide work-stealing executor shared by thread pools, parallel streams and toolbox loops.
+
+    Every worker owns a deque of tasks. Tasks submitted from a worker are pushed to (and popped from) the back
+    of its own deque, keeping recently produced data in cache. Idle workers steal from the front of the deques of
+    other workers. Workers can optionally be pinned to cores, filling one NUMA node at a time.
+
+    The number of workers and pinning of the global executor is taken from the environment variables
+    GADGETRON_EXECUTOR_THREADS and GADGETRON_EXECUTOR_PIN_THREADS.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cpucore_export.h"
+
+namespace Gadgetron {
+
+    class EXPORTCPUCORE WorkStealingExecutor {
+    public:
+        class Task {
+        public:
+            virtual void execute() = 0;
+            virtual ~Task()        = default;
+        };
+
+        struct Statistics {
+            size_t workers;
+            size_t queue_depth;
+            size_t executed;
+            size_t stolen;
+
+            /// Fraction of executed tasks which were stolen from another worker
+            double steal_rate() const { return executed ? double(stolen) / double(executed) : 0.0; }
+        };
+
+        explicit WorkStealingExecutor(unsigned int workers, bool pin_threads = false);
+        ~WorkStealingExecutor();
+
+        WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+        WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+        /// The executor shared by everything in this process. Created on first use.
+        static WorkStealingExecutor& global();
+
+        void submit(std::unique_ptr<Task> task);
+
+        template <class F> void submit(F&& f) {
+            submit(std::unique_ptr<Task>(new FunctionTask<std::decay_t<F>>(std::forward<F>(f))));
+        }
+
+        /**
+         * Calls f(i) for every i in [begin, end), split into chunks over the workers. The calling thread processes
+         * chunks as well, so it is safe to call from inside a task. Rethrows the first exception raised by f.
+         */
+        template <class F> void parallel_for(size_t begin, size_t end, F&& f, size_t grain_size = 0);
+
+        /// True if the calling thread is one of the workers of this executor.
+        bool is_worker_thread() const;
+
+        unsigned int size() const;
+        Statistics statistics() const;
+
+    private:
+        template <class F> class FunctionTask : public Task {
+        public:
+            explicit FunctionTask(F f) : f(std::move(f)) {}
+            void execute() override { f(); }
+
+        private:
+            F f;
+        };
+
+        struct alignas(64) Worker {
+            std::mutex m;
+            std::deque<std::unique_ptr<Task>> tasks;
+        };
+
+        std::unique_ptr<Task> pop_local(size_t index);
+        std::unique_ptr<Task> steal(size_t thief);
+        void run_worker(size_t index);
+        void pin_to_core(std::thread& thread, size_t index);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+
+        std::atomic<size_t> next_worker{ 0 };
+        std::atomic<size_t> pending{ 0 };
+        std::atomic<size_t> executed{ 0 };
+        std::atomic<size_t> stolen{ 0 };
+
+        std::atomic<size_t> sleepers{ 0 };
+        std::atomic<bool> stopping{ false };
+        std::mutex sleep_mutex;
+        std::condition_variable wakeup;
+    };
+
+    template <class F>
+    void WorkStealingExecutor::parallel_for(size_t begin, size_t end, F&& f, size_t grain_size) {
+        if (end <= begin)
+            return;
+
+        const size_t total = end - begin;
+        if (!grain_size)
+            grain_size = std::max<size_t>(1, total / (4 * size()));
+        const size_t chunks = (total + grain_size - 1) / grain_size;
+
+        struct State {
+            std::atomic<size_t> next{ 0 };
+            std::mutex m;
+            std::condition_variable done;
+            size_t completed = 0;
+            std::exception_ptr error;
+        };
+        auto state = std::make_shared<State>();
+
+        auto process_chunks = [state, begin, end, chunks, grain_size, &f]() {
+            size_t chunk;
+            while ((chunk = state->next++) < chunks) {
+                try {
+                    auto chunk_end = std::min(end, begin + (chunk + 1) * grain_size);
+                    for (size_t i = begin + chunk * grain_size; i < chunk_end; i++)
+                        f(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(state->m);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                }
+                std::lock_guard<std::mutex> guard(state->m);
+                if (++state->completed == chunks)
+                    state->done.notify_all();
+            }
+        };
+
+        // Helpers that start after all chunks are claimed exit without touching f.
+        auto helpers = std::min<size_t>(size(), chunks) - 1;
+        for (size_t i = 0; i < helpers; i++)
+            submit(process_chunks);
+
+        process_chunks();
+
+        std::unique_lock<std::mutex> lock(state->m);
+        state->done.wait(lock, [&]() { return state->completed == chunks; });
+        if (state->error)
+            std::rethrow_exception(state->error);
+    }
+}
@@ -9,11 +9,16 @@
 #include "vector_td.h"
 
 #include "cpucore_export.h"
+#include "hoNDArray_allocator.h"
 
 #include <string.h>
 #include <float.h>
 #include <boost/shared_ptr.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <typeinfo>
 #include "TypeTraits.h"
 
 namespace Gadgetron{
@@ -32,6 +37,8 @@ namespace Gadgetron{
 
    template<class T> class hoNDArray;
 
+   template<class F, class... Operands> class hoNDArrayExpression;
+
 
    template<class T, size_t D>
    class hoNDArrayView {
@@ -114,6 +121,10 @@ namespace Gadgetron{
     // Assignment operator
     hoNDArray& operator=(const hoNDArray& rhs);
 
+    /// Evaluates an element-wise expression in a single pass; see hoNDArray_expressions.h
+    template<class F, class... Operands> hoNDArray(const hoNDArrayExpression<F, Operands...>& expression);
+    template<class F, class... Operands> hoNDArray& operator=(const hoNDArrayExpression<F, Operands...>& expression);
+
     bool operator==(const hoNDArray& rhs) const;
     virtual void create(const std::vector<size_t>& dimensions);
     virtual void create(const std::vector<size_t> *dimensions);
@@ -187,6 +198,17 @@ namespace Gadgetron{
 
     void fill(T value);
 
+    /// Lets copies of the array share its memory, until the array or a copy is written to. Any non-const access
+    /// to the data of a sharing array first gives it memory of its own, also with several threads accessing it at
+    /// once; make_unique does so explicitly, for code about to write through pointers it obtained earlier. Arrays
+    /// viewing memory they do not own, and arrays of derived types, are copied in full as before.
+    virtual void share();
+
+    /// Whether other arrays currently share the memory of this one.
+    bool is_shared() const;
+
+    void make_unique() override;
+
     T* begin();
     const T* begin() const;
 
@@ -214,6 +236,8 @@ namespace Gadgetron{
                 this->create(aArray.get_dimensions());
             }
 
+            this->make_unique();
+
             long long i;
 #pragma omp parallel for default(none) private(i) shared(aArray)
             for (i = 0; i < (long long)elements_; i++)
@@ -250,6 +274,15 @@ namespace Gadgetron{
     virtual void allocate_memory();
     virtual void deallocate_memory();
 
+    // Deleter of shared memory; frees it unless the last array holding it has taken it back.
+    struct SharedStorageRelease {
+        bool released = false;
+        void operator()(T* data) const;
+    };
+
+    // Serializes detaching an array that several threads write to at once.
+    static std::mutex& detach_mutex(const hoNDArray<T>* array);
+
     // Generic allocator / deallocator
     //
 
@@ -286,12 +319,12 @@ namespace Gadgetron{
 
     template<class TYPE, unsigned int D> void _allocate_memory( size_t size, vector_td<TYPE,D>** data )
     {
-      *data = (vector_td<TYPE,D>*) malloc( size*sizeof(vector_td<TYPE,D>) );
+      *data = (vector_td<TYPE,D>*) hoNDArrayAllocator::current().allocate( size*sizeof(vector_td<TYPE,D>) );
     }
 
     template<class TYPE, unsigned int D>  void _deallocate_memory( vector_td<TYPE,D>* data )
     {
-      free( data );
+      hoNDArrayAllocator::release( data );
     }
   };
 
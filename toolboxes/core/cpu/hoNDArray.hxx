@@ -234,7 +234,11 @@ namespace Gadgetron {
         this->dimensions_    = a->dimensions_;
         this->offsetFactors_ = a->offsetFactors_;
 
-        if (!this->dimensions_.empty()) {
+        if (a->shared_storage_) {
+            this->set_shared_storage(a->shared_storage_);
+            this->data_           = a->data_;
+            this->elements_       = a->elements_;
+        } else if (!this->dimensions_.empty()) {
             allocate_memory();
             memcpy(this->data_, a->data_, this->elements_ * sizeof(T));
         } else {
@@ -247,7 +251,11 @@ namespace Gadgetron {
         this->dimensions_ = a.dimensions_;
         offsetFactors_    = a.offsetFactors_;
 
-        if (!this->dimensions_.empty()) {
+        if (a.shared_storage_) {
+            this->set_shared_storage(a.shared_storage_);
+            this->data_           = a.data_;
+            this->elements_       = a.elements_;
+        } else if (!this->dimensions_.empty()) {
             allocate_memory();
             memcpy(this->data_, a.data_, this->elements_ * sizeof(T));
         } else {
@@ -263,6 +271,8 @@ namespace Gadgetron {
         a.data_                        = nullptr;
         this->offsetFactors_           = a.offsetFactors_;
         this->delete_data_on_destruct_ = a.delete_data_on_destruct_;
+        this->set_shared_storage(std::move(a.shared_storage_));
+        a.set_shared_storage(nullptr);
     }
 #endif
 
@@ -275,8 +285,22 @@ namespace Gadgetron {
             return *this;
         }
 
+        // Shared memory is shared further, unless this array views memory it does not own
+        if (rhs.shared_storage_ && this->delete_data_on_destruct_) {
+            if (this->shared_storage_ != rhs.shared_storage_) {
+                deallocate_memory();
+                this->set_shared_storage(rhs.shared_storage_);
+                this->data_           = rhs.data_;
+            }
+            this->dimensions_    = rhs.dimensions_;
+            this->offsetFactors_ = rhs.offsetFactors_;
+            this->elements_      = rhs.elements_;
+            return *this;
+        }
+
         // Are the dimensions the same? Then we can just memcpy
         if (this->dimensions_equal(&rhs)) {
+            this->make_unique();
             memcpy(this->data_, rhs.data_, this->elements_ * sizeof(T));
         } else {
             deallocate_memory();
@@ -300,6 +324,8 @@ namespace Gadgetron {
         data_                          = rhs.data_;
         rhs.data_                      = nullptr;
         this->delete_data_on_destruct_ = rhs.delete_data_on_destruct_;
+        this->set_shared_storage(std::move(rhs.shared_storage_));
+        rhs.set_shared_storage(nullptr);
         return *this;
     }
 #endif
@@ -597,7 +623,7 @@ namespace Gadgetron {
     }
 
     template <typename T> inline T* hoNDArray<T>::begin() {
-        return this->data_;
+        return this->data();
     }
 
     template <typename T> inline const T* hoNDArray<T>::begin() const {
@@ -605,7 +631,7 @@ namespace Gadgetron {
     }
 
     template <typename T> inline T* hoNDArray<T>::end() {
-        return (this->data_ + this->elements_);
+        return (this->data() + this->elements_);
     }
 
     template <typename T> inline const T* hoNDArray<T>::end() const {
@@ -744,7 +770,7 @@ namespace Gadgetron {
             }
 
             // now, copy size[0] elements:
-            memcpy(&out.data_[ind1D], &((*this)(ind)), size[0] * sizeof(T));
+            memcpy(&out.data()[ind1D], &((*this)(ind)), size[0] * sizeof(T));
         }
     }
 
@@ -824,58 +850,120 @@ namespace Gadgetron {
             throw std::runtime_error("You don't own this data.  You cannot deallocate its memory.");
         }
 
+        if (this->shared_storage_) {
+            this->set_shared_storage(nullptr);
+            this->data_ = 0x0;
+            return;
+        }
+
         if (this->data_) {
             this->_deallocate_memory(this->data_);
             this->data_ = 0x0;
         }
     }
 
+    template <typename T> void hoNDArray<T>::share() {
+        if (this->shared_storage_ || !this->data_ || !this->delete_data_on_destruct_)
+            return;
+
+        // Derived arrays write their memory directly, or allocate it differently; their copies stay deep.
+        if (typeid(*this) != typeid(hoNDArray<T>))
+            return;
+
+        this->set_shared_storage(std::shared_ptr<T>(this->data_, SharedStorageRelease{}));
+    }
+
+    template <typename T> bool hoNDArray<T>::is_shared() const {
+        return this->shared_storage_ && this->shared_storage_.use_count() > 1;
+    }
+
+    template <typename T> void hoNDArray<T>::make_unique() {
+        if (!this->sharing_.value.load(std::memory_order_acquire))
+            return;
+
+        // Threads writing to one array at once all get here; one of them detaches it, the others find it done.
+        std::lock_guard<std::mutex> guard(detach_mutex(this));
+        if (!this->shared_storage_)
+            return;
+
+        if (this->shared_storage_.use_count() == 1) {
+            // No copy is left; the memory is ours again. The fence orders our writes after the reads of the
+            // copies, which released their references.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::get_deleter<SharedStorageRelease>(this->shared_storage_)->released = true;
+            this->set_shared_storage(nullptr);
+            return;
+        }
+
+        T* data = 0x0;
+        this->_allocate_memory(this->elements_, &data);
+        if (data == 0x0) {
+            BOOST_THROW_EXCEPTION(bad_alloc("hoNDArray<>::make_unique failed to allocate memory"));
+        }
+        memcpy(data, this->data_, this->elements_ * sizeof(T));
+
+        this->data_ = data;
+        this->set_shared_storage(nullptr);
+    }
+
+    template <typename T> std::mutex& hoNDArray<T>::detach_mutex(const hoNDArray<T>* array) {
+        static std::mutex mutexes[64];
+        return mutexes[(reinterpret_cast<uintptr_t>(array) / sizeof(hoNDArray<T>)) % 64];
+    }
+
+    template <typename T> void hoNDArray<T>::SharedStorageRelease::operator()(T* data) const {
+        if (released)
+            return;
+        hoNDArray<T> owner;
+        owner._deallocate_memory(data);
+    }
+
     template <typename T> inline void hoNDArray<T>::_allocate_memory(size_t size, float** data) {
-        *data = (float*)malloc(size * sizeof(float));
+        *data = (float*)hoNDArrayAllocator::current().allocate(size * sizeof(float));
     }
 
     template <typename T> inline void hoNDArray<T>::_deallocate_memory(float* data) {
-        free(data);
+        hoNDArrayAllocator::release(data);
     }
 
     template <typename T> inline void hoNDArray<T>::_allocate_memory(size_t size, double** data) {
-        *data = (double*)malloc(size * sizeof(double));
+        *data = (double*)hoNDArrayAllocator::current().allocate(size * sizeof(double));
     }
 
     template <typename T> inline void hoNDArray<T>::_deallocate_memory(double* data) {
-        free(data);
+        hoNDArrayAllocator::release(data);
     }
 
     template <typename T> inline void hoNDArray<T>::_allocate_memory(size_t size, std::complex<float>** data) {
-        *data = (std::complex<float>*)malloc(size * sizeof(std::complex<float>));
+        *data = (std::complex<float>*)hoNDArrayAllocator::current().allocate(size * sizeof(std::complex<float>));
     }
 
     template <typename T> inline void hoNDArray<T>::_deallocate_memory(std::complex<float>* data) {
-        free(data);
+        hoNDArrayAllocator::release(data);
     }
 
     template <typename T> inline void hoNDArray<T>::_allocate_memory(size_t size, std::complex<double>** data) {
-        *data = (std::complex<double>*)malloc(size * sizeof(std::complex<double>));
+        *data = (std::complex<double>*)hoNDArrayAllocator::current().allocate(size * sizeof(std::complex<double>));
     }
 
     template <typename T> inline void hoNDArray<T>::_deallocate_memory(std::complex<double>* data) {
-        free(data);
+        hoNDArrayAllocator::release(data);
     }
 
     template <typename T> inline void hoNDArray<T>::_allocate_memory(size_t size, float_complext** data) {
-        *data = (float_complext*)malloc(size * sizeof(float_complext));
+        *data = (float_complext*)hoNDArrayAllocator::current().allocate(size * sizeof(float_complext));
     }
 
     template <typename T> inline void hoNDArray<T>::_deallocate_memory(float_complext* data) {
-        free(data);
+        hoNDArrayAllocator::release(data);
     }
 
     template <typename T> inline void hoNDArray<T>::_allocate_memory(size_t size, double_complext** data) {
-        *data = (double_complext*)malloc(size * sizeof(double_complext));
+        *data = (double_complext*)hoNDArrayAllocator::current().allocate(size * sizeof(double_complext));
     }
 
     template <typename T> inline void hoNDArray<T>::_deallocate_memory(double_complext* data) {
-        free(data);
+        hoNDArrayAllocator::release(data);
     }
 
     template <typename T> bool hoNDArray<T>::serialize(char*& buf, size_t& len) const {
@@ -910,7 +998,7 @@ namespace Gadgetron {
             this->create(&dimensions);
 
             // copy the content
-            memcpy(this->data_, buf + sizeof(size_t) + sizeof(size_t) * NDim, sizeof(T) * elements_);
+            memcpy(this->data(), buf + sizeof(size_t) + sizeof(size_t) * NDim, sizeof(T) * elements_);
         } else {
             this->clear();
         }
@@ -931,7 +1019,7 @@ namespace Gadgetron {
     template <typename T> inline T& hoNDArray<T>::operator()(const std::vector<size_t>& ind) {
         size_t idx = this->calculate_offset(ind);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T> inline const T& hoNDArray<T>::operator()(const std::vector<size_t>& ind) const {
@@ -942,7 +1030,7 @@ namespace Gadgetron {
 
     template <typename T> inline T& hoNDArray<T>::operator()(size_t x) {
         GADGET_DEBUG_CHECK_THROW(x < this->get_number_of_elements());
-        return this->data_[x];
+        return this->data()[x];
     }
 
     template <typename T> inline const T& hoNDArray<T>::operator()(size_t x) const {
@@ -953,7 +1041,7 @@ namespace Gadgetron {
     template <typename T> inline T& hoNDArray<T>::operator()(size_t x, size_t y) {
         size_t idx = this->calculate_offset(x, y);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T> inline const T& hoNDArray<T>::operator()(size_t x, size_t y) const {
@@ -965,7 +1053,7 @@ namespace Gadgetron {
     template <typename T> inline T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z) {
         size_t idx = this->calculate_offset(x, y, z);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T> inline const T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z) const {
@@ -977,7 +1065,7 @@ namespace Gadgetron {
     template <typename T> inline T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z, size_t s) {
         size_t idx = this->calculate_offset(x, y, z, s);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T> inline const T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z, size_t s) const {
@@ -989,7 +1077,7 @@ namespace Gadgetron {
     template <typename T> inline T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z, size_t s, size_t p) {
         size_t idx = this->calculate_offset(x, y, z, s, p);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T>
@@ -1003,7 +1091,7 @@ namespace Gadgetron {
     inline T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z, size_t s, size_t p, size_t r) {
         size_t idx = this->calculate_offset(x, y, z, s, p, r);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T>
@@ -1017,7 +1105,7 @@ namespace Gadgetron {
     inline T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z, size_t s, size_t p, size_t r, size_t a) {
         size_t idx = this->calculate_offset(x, y, z, s, p, r, a);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T>
@@ -1032,7 +1120,7 @@ namespace Gadgetron {
     inline T& hoNDArray<T>::operator()(size_t x, size_t y, size_t z, size_t s, size_t p, size_t r, size_t a, size_t q) {
         size_t idx = this->calculate_offset(x, y, z, s, p, r, a, q);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T>
@@ -1048,7 +1136,7 @@ namespace Gadgetron {
         size_t x, size_t y, size_t z, size_t s, size_t p, size_t r, size_t a, size_t q, size_t u) {
         size_t idx = this->calculate_offset(x, y, z, s, p, r, a, q, u);
         GADGET_DEBUG_CHECK_THROW(idx < this->get_number_of_elements());
-        return this->data_[idx];
+        return this->data()[idx];
     }
 
     template <typename T>
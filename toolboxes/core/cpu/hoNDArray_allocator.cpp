@@ -0,0 +1,379 @@
+#include "hoNDArray_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "log.h"
+
+namespace {
+    using namespace Gadgetron;
+
+    // Sits directly in front of the data.
+    struct alignas(hoNDArrayAllocator::alignment) BlockHeader {
+        hoNDArrayAllocator* owner;
+        size_t bytes;
+    };
+    static_assert(sizeof(BlockHeader) == hoNDArrayAllocator::alignment, "Block header must preserve alignment");
+
+    BlockHeader* header_of(void* data) {
+        return reinterpret_cast<BlockHeader*>(data) - 1;
+    }
+
+    /**
+     * The data pointers handed out by all hoNDArrayAllocators, so release can tell them from memory allocated
+     * elsewhere without reading in front of it. Pointers are spread over shards, each an open addressed hash
+     * set, which keeps the lock taken per allocation short and mostly uncontended. Until a block has been
+     * inserted, release skips the lookup altogether.
+     */
+    class LiveBlocks {
+    public:
+        void insert(void* data) {
+            if (!in_use.load(std::memory_order_relaxed))
+                in_use.store(true, std::memory_order_relaxed);
+
+            auto& shard = shard_of(data);
+            std::lock_guard<std::mutex> guard(shard.m);
+            if ((shard.used + 1) * 4 > shard.slots.size() * 3)
+                shard.rehash();
+            shard.place(key_of(data));
+            shard.used++;
+        }
+
+        /// Removes data, returning whether it was there.
+        bool erase(void* data) {
+            // Inserting a block happens before releasing it, so a tracked block always sees in_use set.
+            if (!in_use.load(std::memory_order_relaxed))
+                return false;
+
+            auto& shard = shard_of(data);
+            auto key    = key_of(data);
+            std::lock_guard<std::mutex> guard(shard.m);
+            if (shard.slots.empty())
+                return false;
+
+            auto mask = shard.slots.size() - 1;
+            for (auto slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+                if (shard.slots[slot] == key) {
+                    shard.slots[slot] = deleted;
+                    return true;
+                }
+                if (shard.slots[slot] == empty)
+                    return false;
+            }
+        }
+
+    private:
+        static constexpr uintptr_t empty   = 0;
+        static constexpr uintptr_t deleted = 1;
+        static constexpr size_t number_of_shards = 64;
+
+        // Data pointers are aligned, so neither key collides with the markers above.
+        static uintptr_t key_of(void* data) {
+            return reinterpret_cast<uintptr_t>(data);
+        }
+
+        static size_t hash(uintptr_t key) {
+            return size_t((key / hoNDArrayAllocator::alignment) * 0x9e3779b97f4a7c15ull >> 16);
+        }
+
+        struct Shard {
+            std::mutex m;
+            std::vector<uintptr_t> slots;
+            size_t used = 0; // Live keys and deleted markers
+
+            void place(uintptr_t key) {
+                auto mask = slots.size() - 1;
+                auto slot = hash(key) & mask;
+                while (slots[slot] > deleted)
+                    slot = (slot + 1) & mask;
+                slots[slot] = key;
+            }
+
+            void rehash() {
+                auto previous = std::move(slots);
+                used          = std::count_if(previous.begin(), previous.end(), [](auto key) { return key > deleted; });
+                size_t size   = 64;
+                while (size < 2 * (used + 1))
+                    size *= 2;
+                slots.assign(size, empty);
+                for (auto key : previous)
+                    if (key > deleted)
+                        place(key);
+            }
+        };
+
+        Shard& shard_of(void* data) {
+            return shards[(key_of(data) / hoNDArrayAllocator::alignment) % number_of_shards];
+        }
+
+        std::atomic<bool> in_use{ false };
+        std::array<Shard, number_of_shards> shards;
+    };
+
+    // Never destroyed, as arrays in static storage may be released after it otherwise.
+    LiveBlocks& live_blocks() {
+        static auto blocks = new LiveBlocks();
+        return *blocks;
+    }
+
+    void* aligned_alloc_from_system(size_t bytes) {
+#if defined(_WIN32)
+        return _aligned_malloc(bytes, hoNDArrayAllocator::alignment);
+#else
+        void* block = nullptr;
+        if (posix_memalign(&block, hoNDArrayAllocator::alignment, bytes))
+            return nullptr;
+        return block;
+#endif
+    }
+
+    void aligned_free_to_system(void* block) {
+#if defined(_WIN32)
+        _aligned_free(block);
+#else
+        free(block);
+#endif
+    }
+
+    class SystemAllocator : public hoNDArrayAllocator {
+    protected:
+        void* allocate_block(size_t& bytes) override {
+            misses++;
+            return aligned_alloc_from_system(bytes);
+        }
+
+        void deallocate_block(void* block, size_t) override {
+            aligned_free_to_system(block);
+        }
+
+        // Aligned blocks from the system heap may be passed to free, except on Windows.
+        bool releases_with_free() const override {
+#if defined(_WIN32)
+            return false;
+#else
+            return true;
+#endif
+        }
+    };
+
+    /**
+     * Size classes are spaced four per power of two, from 256 bytes to 64 MB. Freed blocks go to a small cache
+     * owned by the freeing thread, spilling over to shared per-class free lists. Blocks in either count against
+     * the limit; beyond it, freed blocks go back to the system.
+     */
+    class PoolAllocator : public hoNDArrayAllocator {
+    public:
+        static constexpr size_t smallest_class = 256;
+        static constexpr size_t number_of_classes = 73;
+        static constexpr size_t thread_cache_bytes = 4 * 1024 * 1024;
+        static constexpr size_t max_thread_cache_blocks = 32;
+
+        explicit PoolAllocator(size_t limit) : limit{ limit } {}
+
+        static size_t class_index(size_t bytes) {
+            if (bytes <= smallest_class)
+                return 0;
+            size_t exponent = 0;
+            while ((smallest_class << (exponent + 1)) < bytes)
+                exponent++;
+            size_t base = smallest_class << exponent;
+            size_t step = base / 4;
+            return exponent * 4 + (bytes - base + step - 1) / step;
+        }
+
+        static size_t class_size(size_t index) {
+            if (index == 0)
+                return smallest_class;
+            size_t base = smallest_class << ((index - 1) / 4);
+            return base + ((index - 1) % 4 + 1) * (base / 4);
+        }
+
+    protected:
+        void* allocate_block(size_t& bytes) override {
+            auto index = class_index(bytes);
+            if (index >= number_of_classes) {
+                misses++;
+                return aligned_alloc_from_system(bytes);
+            }
+            bytes = class_size(index);
+
+            auto& cached = cache().blocks[index];
+            if (!cached.empty()) {
+                hits++;
+                auto block = cached.back();
+                cached.pop_back();
+                retained_bytes -= bytes;
+                return block;
+            }
+
+            {
+                auto& shared = free_lists[index];
+                std::lock_guard<std::mutex> guard(shared.m);
+                if (!shared.blocks.empty()) {
+                    hits++;
+                    auto block = shared.blocks.back();
+                    shared.blocks.pop_back();
+                    retained_bytes -= bytes;
+                    return block;
+                }
+            }
+
+            misses++;
+            return aligned_alloc_from_system(bytes);
+        }
+
+        void deallocate_block(void* block, size_t bytes) override {
+            auto index = class_index(bytes);
+            if (index >= number_of_classes) {
+                aligned_free_to_system(block);
+                return;
+            }
+
+            if (retained_bytes.fetch_add(bytes) + bytes > limit) {
+                retained_bytes -= bytes;
+                aligned_free_to_system(block);
+                return;
+            }
+
+            auto& cached = cache().blocks[index];
+            if (cached.size() < thread_cache_limit(index)) {
+                cached.push_back(block);
+                return;
+            }
+            return_to_shared(block, index);
+        }
+
+        size_t bytes_retained() const override {
+            return retained_bytes.load();
+        }
+
+    private:
+        struct FreeList {
+            std::mutex m;
+            std::vector<void*> blocks;
+        };
+
+        struct ThreadCache {
+            explicit ThreadCache(PoolAllocator& pool) : pool{ pool } {}
+            ~ThreadCache() {
+                for (size_t index = 0; index < blocks.size(); index++)
+                    for (auto block : blocks[index])
+                        pool.return_to_shared(block, index);
+            }
+
+            PoolAllocator& pool;
+            std::array<std::vector<void*>, number_of_classes> blocks;
+        };
+
+        static size_t thread_cache_limit(size_t index) {
+            auto blocks = thread_cache_bytes / class_size(index);
+            return std::max<size_t>(1, std::min(blocks, max_thread_cache_blocks));
+        }
+
+        ThreadCache& cache() {
+            thread_local ThreadCache thread_cache(*this);
+            return thread_cache;
+        }
+
+        void return_to_shared(void* block, size_t index) {
+            auto& shared = free_lists[index];
+            std::lock_guard<std::mutex> guard(shared.m);
+            shared.blocks.push_back(block);
+        }
+
+        const size_t limit;
+        std::atomic<size_t> retained_bytes{ 0 };
+        std::array<FreeList, number_of_classes> free_lists;
+    };
+
+    size_t pool_limit() {
+        if (auto limit = std::getenv("GADGETRON_ARRAY_POOL_LIMIT_MB"))
+            return std::strtoull(limit, nullptr, 10) * 1024 * 1024;
+        return size_t(1024) * 1024 * 1024;
+    }
+
+    hoNDArrayAllocator* default_allocator() {
+        auto selection = std::getenv("GADGETRON_ARRAY_ALLOCATOR");
+        if (!selection || std::string(selection) == "system")
+            return &hoNDArrayAllocator::system();
+        if (std::string(selection) == "pool")
+            return &hoNDArrayAllocator::pool();
+
+        GWARN_STREAM("Unknown GADGETRON_ARRAY_ALLOCATOR " << selection << "; using the system allocator.");
+        return &hoNDArrayAllocator::system();
+    }
+
+    std::atomic<hoNDArrayAllocator*>& selected_allocator() {
+        static std::atomic<hoNDArrayAllocator*> selected{ default_allocator() };
+        return selected;
+    }
+}
+
+namespace Gadgetron {
+
+    void* hoNDArrayAllocator::allocate(size_t bytes) {
+        if (releases_with_free())
+            return allocate_block(bytes);
+
+        size_t block_bytes = bytes + sizeof(BlockHeader);
+        auto block         = allocate_block(block_bytes);
+        if (!block)
+            return nullptr;
+
+        auto header   = static_cast<BlockHeader*>(block);
+        void* data    = header + 1;
+        header->owner = this;
+        header->bytes = block_bytes;
+        live_blocks().insert(data);
+
+        auto live     = bytes_live += block_bytes;
+        auto previous = high_water_mark.load();
+        while (live > previous && !high_water_mark.compare_exchange_weak(previous, live))
+            ;
+
+        return data;
+    }
+
+    void hoNDArrayAllocator::release(void* data) {
+        if (!data)
+            return;
+
+        if (!live_blocks().erase(data)) {
+            free(data);
+            return;
+        }
+
+        auto header = header_of(data);
+        auto owner  = header->owner;
+        owner->bytes_live -= header->bytes;
+        owner->deallocate_block(header, header->bytes);
+    }
+
+    hoNDArrayAllocator::Statistics hoNDArrayAllocator::statistics() const {
+        return Statistics{ bytes_live.load(), high_water_mark.load(), this->bytes_retained(), hits.load(), misses.load() };
+    }
+
+    hoNDArrayAllocator& hoNDArrayAllocator::current() {
+        return *selected_allocator().load(std::memory_order_relaxed);
+    }
+
+    void hoNDArrayAllocator::select(hoNDArrayAllocator& allocator) {
+        selected_allocator().store(&allocator);
+    }
+
+    // The built in allocators are never destroyed; arrays in static storage may outlive them otherwise.
+    hoNDArrayAllocator& hoNDArrayAllocator::system() {
+        static auto allocator = new SystemAllocator();
+        return *allocator;
+    }
+
+    hoNDArrayAllocator& hoNDArrayAllocator::pool() {
+        static auto allocator = new PoolAllocator(pool_limit());
+        return *allocator;
+    }
+}
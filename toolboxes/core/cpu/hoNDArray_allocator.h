@@ -0,0 +1,76 @@
+/** \file hoNDArray_allocator.h
+    \brief Pluggable memory allocators for hoNDArray storage.
+
+    All memory handed out by an hoNDArrayAllocator is aligned to hoNDArrayAllocator::alignment bytes, so
+    vectorised kernels may assume aligned loads on the first element of an array.
+
+    Except from the system allocator, each block carries a small header in front of the data, recording which
+    allocator produced it, so memory is released correctly regardless of which allocator is selected at the time.
+    These allocators keep track of the blocks they hand out; any other memory, including the plain blocks of the
+    system allocator, is passed to free. As the system allocator does not track its blocks, its statistics do not
+    include live bytes or a high water mark.
+
+    The process wide allocator is chosen with hoNDArrayAllocator::select, or through the environment variable
+    GADGETRON_ARRAY_ALLOCATOR ("system" or "pool"). The pool retains at most GADGETRON_ARRAY_POOL_LIMIT_MB
+    megabytes of free memory (default 1024), including the blocks cached by each thread.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "cpucore_export.h"
+
+namespace Gadgetron {
+
+    class EXPORTCPUCORE hoNDArrayAllocator {
+    public:
+        static constexpr size_t alignment = 64;
+
+        struct Statistics {
+            size_t bytes_live;
+            size_t high_water_mark;
+            size_t bytes_retained; ///< Freed memory kept for reuse
+            size_t hits;
+            size_t misses;
+        };
+
+        virtual ~hoNDArrayAllocator() = default;
+
+        /// Allocates aligned memory for at least bytes bytes. Returns nullptr on failure.
+        void* allocate(size_t bytes);
+
+        /// Releases memory obtained from any hoNDArrayAllocator.
+        static void release(void* data);
+
+        Statistics statistics() const;
+
+        /// The allocator used by hoNDArray in this process.
+        static hoNDArrayAllocator& current();
+
+        /// Selects the allocator used by hoNDArray. The allocator must outlive all memory allocated through it.
+        static void select(hoNDArrayAllocator& allocator);
+
+        /// Plain aligned allocations from the system heap.
+        static hoNDArrayAllocator& system();
+
+        /// Thread caching allocator, recycling memory in size classes.
+        static hoNDArrayAllocator& pool();
+
+    protected:
+        /// Allocates a block of bytes bytes, aligned to alignment. May round bytes up.
+        virtual void* allocate_block(size_t& bytes) = 0;
+        virtual void deallocate_block(void* block, size_t bytes) = 0;
+        virtual size_t bytes_retained() const { return 0; }
+        /// Whether blocks are plain memory that free releases, needing neither header nor tracking.
+        virtual bool releases_with_free() const { return false; }
+
+        std::atomic<size_t> hits{ 0 };
+        std::atomic<size_t> misses{ 0 };
+
+    private:
+        std::atomic<size_t> bytes_live{ 0 };
+        std::atomic<size_t> high_water_mark{ 0 };
+    };
+}
@@ -276,6 +276,9 @@ namespace Gadgetron
     template <typename T, unsigned int D> 
     hoNDImage<T, D>::hoNDImage(const hoNDArray<T>& a) : BaseClass(a)
     {
+         // images write their memory directly, so they never share it
+         this->make_unique();
+
          boost::shared_ptr< std::vector<size_t> > dim = a.get_dimensions();
          this->create(*dim);
          memcpy(this->data_, a.begin(), this->get_number_of_bytes());
@@ -0,0 +1,348 @@
+#include "hoNDArray_channel_mixing.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define GADGETRON_CHANNEL_MIXING_X86
+#include <immintrin.h>
+#endif
+
+namespace Gadgetron {
+    namespace {
+
+        using complex_float = std::complex<float>;
+
+        // Mixes samples [begin, end) of the outputs [first_output, first_output + outputs).
+        void mix_samples_scalar(const complex_float* input, complex_float* output, size_t samples, size_t begin,
+            size_t end, size_t channels_in, size_t first_output, size_t outputs, const complex_float* mixing) {
+
+            for (size_t o = first_output; o < first_output + outputs; o++) {
+                auto destination = reinterpret_cast<float*>(output + o * samples);
+                std::fill(destination + 2 * begin, destination + 2 * end, 0.0f);
+
+                for (size_t c = 0; c < channels_in; c++) {
+                    const float mr = mixing[c + o * channels_in].real();
+                    const float mi = mixing[c + o * channels_in].imag();
+                    auto source    = reinterpret_cast<const float*>(input + c * samples);
+
+                    for (size_t s = begin; s < end; s++) {
+                        const float re = source[2 * s], im = source[2 * s + 1];
+                        destination[2 * s] += re * mr - im * mi;
+                        destination[2 * s + 1] += re * mi + im * mr;
+                    }
+                }
+            }
+        }
+
+        void mix_scalar(const complex_float* input, complex_float* output, size_t samples, size_t channels_in,
+            size_t channels_out, const complex_float* mixing) {
+            mix_samples_scalar(input, output, samples, 0, samples, channels_in, 0, channels_out, mixing);
+        }
+
+        // Pixels combined at a time; the output tile stays in L1 while every channel is added to it.
+        constexpr size_t combination_tile = 512;
+
+        // Combines pixels [begin, end).
+        void combine_pixels_scalar(const complex_float* weights, const complex_float* images, complex_float* output,
+            size_t pixels, size_t begin, size_t end, size_t channels, float scale) {
+
+            auto destination = reinterpret_cast<float*>(output);
+            std::fill(destination + 2 * begin, destination + 2 * end, 0.0f);
+
+            for (size_t c = 0; c < channels; c++) {
+                auto w = reinterpret_cast<const float*>(weights + c * pixels);
+                auto x = reinterpret_cast<const float*>(images + c * pixels);
+
+                for (size_t p = begin; p < end; p++) {
+                    destination[2 * p] += w[2 * p] * x[2 * p] - w[2 * p + 1] * x[2 * p + 1];
+                    destination[2 * p + 1] += w[2 * p] * x[2 * p + 1] + w[2 * p + 1] * x[2 * p];
+                }
+            }
+
+            for (size_t i = 2 * begin; i < 2 * end; i++)
+                destination[i] *= scale;
+        }
+
+        template <class TILE>
+        void combine_tiled(const complex_float* weights, const complex_float* images, complex_float* output,
+            size_t pixels, size_t channels, float scale, TILE tile) {
+            for (size_t begin = 0; begin < pixels; begin += combination_tile)
+                tile(weights, images, output, pixels, begin, std::min(begin + combination_tile, pixels), channels, scale);
+        }
+
+#ifdef GADGETRON_CHANNEL_MIXING_X86
+
+        /*
+         * The vector kernels hold a block of samples for OUTPUTS output channels in registers, and run through the
+         * input channels once per block. Products with a complex coefficient m are accumulated as two real parts:
+         * v * re(m), and v with real and imaginary parts swapped * im(m). Subtracting these in the even (real)
+         * lanes and adding them in the odd (imaginary) lanes gives the complex product.
+         */
+        template <size_t OUTPUTS>
+        __attribute__((target("avx2,fma"))) void mix_block_avx2(const complex_float* input, complex_float* output,
+            size_t samples, size_t vector_samples, size_t channels_in, size_t first_output,
+            const complex_float* mixing) {
+
+            for (size_t s = 0; s < vector_samples; s += 4) {
+                __m256 real_parts[OUTPUTS], imaginary_parts[OUTPUTS];
+                for (size_t k = 0; k < OUTPUTS; k++) {
+                    real_parts[k]      = _mm256_setzero_ps();
+                    imaginary_parts[k] = _mm256_setzero_ps();
+                }
+
+                for (size_t c = 0; c < channels_in; c++) {
+                    const __m256 v       = _mm256_loadu_ps(reinterpret_cast<const float*>(input + c * samples + s));
+                    const __m256 swapped = _mm256_permute_ps(v, 0xB1);
+
+                    for (size_t k = 0; k < OUTPUTS; k++) {
+                        auto m             = reinterpret_cast<const float*>(mixing + c + (first_output + k) * channels_in);
+                        real_parts[k]      = _mm256_fmadd_ps(v, _mm256_broadcast_ss(m), real_parts[k]);
+                        imaginary_parts[k] = _mm256_fmadd_ps(swapped, _mm256_broadcast_ss(m + 1), imaginary_parts[k]);
+                    }
+                }
+
+                for (size_t k = 0; k < OUTPUTS; k++) {
+                    _mm256_storeu_ps(reinterpret_cast<float*>(output + (first_output + k) * samples + s),
+                        _mm256_addsub_ps(real_parts[k], imaginary_parts[k]));
+                }
+            }
+        }
+
+        __attribute__((target("avx2,fma"))) void mix_avx2(const complex_float* input, complex_float* output,
+            size_t samples, size_t channels_in, size_t channels_out, const complex_float* mixing) {
+
+            const size_t vector_samples = samples - samples % 4;
+
+            size_t o = 0;
+            for (; o + 4 <= channels_out; o += 4)
+                mix_block_avx2<4>(input, output, samples, vector_samples, channels_in, o, mixing);
+            for (; o < channels_out; o++)
+                mix_block_avx2<1>(input, output, samples, vector_samples, channels_in, o, mixing);
+
+            mix_samples_scalar(
+                input, output, samples, vector_samples, samples, channels_in, 0, channels_out, mixing);
+        }
+
+        template <size_t OUTPUTS>
+        __attribute__((target("avx512f"))) void mix_block_avx512(const complex_float* input, complex_float* output,
+            size_t samples, size_t vector_samples, size_t channels_in, size_t first_output,
+            const complex_float* mixing) {
+
+            const __m512 ones = _mm512_set1_ps(1.0f);
+
+            for (size_t s = 0; s < vector_samples; s += 8) {
+                __m512 real_parts[OUTPUTS], imaginary_parts[OUTPUTS];
+                for (size_t k = 0; k < OUTPUTS; k++) {
+                    real_parts[k]      = _mm512_setzero_ps();
+                    imaginary_parts[k] = _mm512_setzero_ps();
+                }
+
+                for (size_t c = 0; c < channels_in; c++) {
+                    const __m512 v       = _mm512_loadu_ps(reinterpret_cast<const float*>(input + c * samples + s));
+                    const __m512 swapped = _mm512_permute_ps(v, 0xB1);
+
+                    for (size_t k = 0; k < OUTPUTS; k++) {
+                        auto m             = reinterpret_cast<const float*>(mixing + c + (first_output + k) * channels_in);
+                        real_parts[k]      = _mm512_fmadd_ps(v, _mm512_set1_ps(m[0]), real_parts[k]);
+                        imaginary_parts[k] = _mm512_fmadd_ps(swapped, _mm512_set1_ps(m[1]), imaginary_parts[k]);
+                    }
+                }
+
+                // AVX-512 has no addsub; multiplying by one and using fmaddsub does the same.
+                for (size_t k = 0; k < OUTPUTS; k++) {
+                    _mm512_storeu_ps(reinterpret_cast<float*>(output + (first_output + k) * samples + s),
+                        _mm512_fmaddsub_ps(real_parts[k], ones, imaginary_parts[k]));
+                }
+            }
+        }
+
+        __attribute__((target("avx512f"))) void mix_avx512(const complex_float* input, complex_float* output,
+            size_t samples, size_t channels_in, size_t channels_out, const complex_float* mixing) {
+
+            const size_t vector_samples = samples - samples % 8;
+
+            size_t o = 0;
+            for (; o + 8 <= channels_out; o += 8)
+                mix_block_avx512<8>(input, output, samples, vector_samples, channels_in, o, mixing);
+            for (; o < channels_out; o++)
+                mix_block_avx512<1>(input, output, samples, vector_samples, channels_in, o, mixing);
+
+            mix_samples_scalar(
+                input, output, samples, vector_samples, samples, channels_in, 0, channels_out, mixing);
+        }
+
+        /*
+         * Complex products w * x in the combination kernels: with the real and imaginary parts of w duplicated
+         * into both lanes, re(w) * x minus / plus im(w) * swapped x in the even / odd lanes is the product.
+         */
+        __attribute__((target("avx2,fma"))) void combine_pixels_avx2(const complex_float* weights,
+            const complex_float* images, complex_float* output, size_t pixels, size_t begin, size_t end,
+            size_t channels, float scale) {
+
+            const size_t vector_end = begin + (end - begin) / 4 * 4;
+            auto destination        = reinterpret_cast<float*>(output);
+
+            for (size_t p = begin; p < vector_end; p += 4)
+                _mm256_storeu_ps(destination + 2 * p, _mm256_setzero_ps());
+
+            for (size_t c = 0; c < channels; c++) {
+                auto w = reinterpret_cast<const float*>(weights + c * pixels);
+                auto x = reinterpret_cast<const float*>(images + c * pixels);
+
+                for (size_t p = begin; p < vector_end; p += 4) {
+                    const __m256 wv = _mm256_loadu_ps(w + 2 * p);
+                    const __m256 xv = _mm256_loadu_ps(x + 2 * p);
+                    const __m256 product = _mm256_fmaddsub_ps(_mm256_moveldup_ps(wv), xv,
+                        _mm256_mul_ps(_mm256_movehdup_ps(wv), _mm256_permute_ps(xv, 0xB1)));
+                    _mm256_storeu_ps(destination + 2 * p, _mm256_add_ps(_mm256_loadu_ps(destination + 2 * p), product));
+                }
+            }
+
+            const __m256 scales = _mm256_set1_ps(scale);
+            for (size_t p = begin; p < vector_end; p += 4)
+                _mm256_storeu_ps(destination + 2 * p, _mm256_mul_ps(_mm256_loadu_ps(destination + 2 * p), scales));
+
+            combine_pixels_scalar(weights, images, output, pixels, vector_end, end, channels, scale);
+        }
+
+        __attribute__((target("avx512f"))) void combine_pixels_avx512(const complex_float* weights,
+            const complex_float* images, complex_float* output, size_t pixels, size_t begin, size_t end,
+            size_t channels, float scale) {
+
+            const size_t vector_end = begin + (end - begin) / 8 * 8;
+            auto destination        = reinterpret_cast<float*>(output);
+
+            for (size_t p = begin; p < vector_end; p += 8)
+                _mm512_storeu_ps(destination + 2 * p, _mm512_setzero_ps());
+
+            for (size_t c = 0; c < channels; c++) {
+                auto w = reinterpret_cast<const float*>(weights + c * pixels);
+                auto x = reinterpret_cast<const float*>(images + c * pixels);
+
+                for (size_t p = begin; p < vector_end; p += 8) {
+                    const __m512 wv = _mm512_loadu_ps(w + 2 * p);
+                    const __m512 xv = _mm512_loadu_ps(x + 2 * p);
+                    const __m512 product = _mm512_fmaddsub_ps(_mm512_moveldup_ps(wv), xv,
+                        _mm512_mul_ps(_mm512_movehdup_ps(wv), _mm512_permute_ps(xv, 0xB1)));
+                    _mm512_storeu_ps(destination + 2 * p, _mm512_add_ps(_mm512_loadu_ps(destination + 2 * p), product));
+                }
+            }
+
+            const __m512 scales = _mm512_set1_ps(scale);
+            for (size_t p = begin; p < vector_end; p += 8)
+                _mm512_storeu_ps(destination + 2 * p, _mm512_mul_ps(_mm512_loadu_ps(destination + 2 * p), scales));
+
+            combine_pixels_scalar(weights, images, output, pixels, vector_end, end, channels, scale);
+        }
+
+#endif // GADGETRON_CHANNEL_MIXING_X86
+
+        ChannelMixingKernel kernel_from_environment(ChannelMixingKernel best) {
+            auto selection = std::getenv("GADGETRON_CHANNEL_MIXING_KERNEL");
+            if (!selection)
+                return best;
+
+            auto name = std::string(selection);
+            for (auto kernel : { ChannelMixingKernel::scalar, ChannelMixingKernel::avx2, ChannelMixingKernel::avx512 }) {
+                static const char* names[] = { "scalar", "avx2", "avx512" };
+                if (name == names[int(kernel)])
+                    return std::min(kernel, best);
+            }
+
+            GWARN_STREAM("Unknown GADGETRON_CHANNEL_MIXING_KERNEL " << selection << "; ignoring it.");
+            return best;
+        }
+    }
+
+    bool is_supported(ChannelMixingKernel kernel) {
+        switch (kernel) {
+        case ChannelMixingKernel::scalar: return true;
+#ifdef GADGETRON_CHANNEL_MIXING_X86
+        case ChannelMixingKernel::avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case ChannelMixingKernel::avx512: return __builtin_cpu_supports("avx512f");
+#endif
+        default: return false;
+        }
+    }
+
+    ChannelMixingKernel best_channel_mixing_kernel() {
+        static const ChannelMixingKernel best = []() {
+            auto kernel = ChannelMixingKernel::scalar;
+            if (is_supported(ChannelMixingKernel::avx2))
+                kernel = ChannelMixingKernel::avx2;
+            if (is_supported(ChannelMixingKernel::avx512))
+                kernel = ChannelMixingKernel::avx512;
+            return kernel_from_environment(kernel);
+        }();
+        return best;
+    }
+
+    void mix_channels(const std::complex<float>* input, std::complex<float>* output, size_t samples,
+        size_t channels_in, size_t channels_out, const std::complex<float>* mixing, ChannelMixingKernel kernel) {
+
+        if (!is_supported(kernel))
+            throw std::runtime_error("Channel mixing kernel is not supported on this processor");
+
+        switch (kernel) {
+#ifdef GADGETRON_CHANNEL_MIXING_X86
+        case ChannelMixingKernel::avx512:
+            mix_avx512(input, output, samples, channels_in, channels_out, mixing);
+            break;
+        case ChannelMixingKernel::avx2: mix_avx2(input, output, samples, channels_in, channels_out, mixing); break;
+#endif
+        default: mix_scalar(input, output, samples, channels_in, channels_out, mixing);
+        }
+    }
+
+    void mix_channels(
+        const hoNDArray<std::complex<float>>& mixing, const std::vector<hoNDArray<std::complex<float>>*>& readouts) {
+
+        const auto kernel       = best_channel_mixing_kernel();
+        const auto channels_in  = mixing.get_size(0);
+        const auto channels_out = mixing.get_size(1);
+
+        // Mixed into scratch memory, so each thread allocates once rather than once per readout.
+        thread_local std::vector<std::complex<float>> scratch;
+
+        for (auto readout : readouts) {
+            const auto samples = readout->get_size(0);
+            if (readout->get_number_of_elements() != samples * channels_in)
+                throw std::runtime_error("Readout does not have the number of channels expected by the mixing matrix");
+
+            if (channels_in != channels_out) {
+                hoNDArray<std::complex<float>> mixed(samples, channels_out);
+                mix_channels(readout->data(), mixed.data(), samples, channels_in, channels_out, mixing.data(), kernel);
+                *readout = std::move(mixed);
+                continue;
+            }
+
+            scratch.resize(samples * channels_out);
+            mix_channels(readout->data(), scratch.data(), samples, channels_in, channels_out, mixing.data(), kernel);
+            std::memcpy(readout->data(), scratch.data(), scratch.size() * sizeof(std::complex<float>));
+        }
+    }
+
+    void combine_channels(const std::complex<float>* weights, const std::complex<float>* images,
+        std::complex<float>* output, size_t pixels, size_t channels, float scale, ChannelMixingKernel kernel) {
+
+        if (!is_supported(kernel))
+            throw std::runtime_error("Channel mixing kernel is not supported on this processor");
+
+        switch (kernel) {
+#ifdef GADGETRON_CHANNEL_MIXING_X86
+        case ChannelMixingKernel::avx512:
+            combine_tiled(weights, images, output, pixels, channels, scale, combine_pixels_avx512);
+            break;
+        case ChannelMixingKernel::avx2:
+            combine_tiled(weights, images, output, pixels, channels, scale, combine_pixels_avx2);
+            break;
+#endif
+        default: combine_tiled(weights, images, output, pixels, channels, scale, combine_pixels_scalar);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+/** \file hoNDArray_channel_mixing.h
+    \brief Channel mixing of streaming readouts, such as prewhitening and coil compression.
+
+    A readout is a samples x channels array, and mixing it with a channels_in x channels_out matrix M gives
+    out(s, o) = sum_c in(s, c) * M(c, o). These matrices are small (tens of channels), and the readouts arrive one
+    by one, a poor fit for a general gemm. The kernels here are written for that shape, with AVX2 and AVX-512
+    versions selected at runtime on processors supporting them.
+
+    Combining images with pixel-wise coefficients, as in GRAPPA unmixing, is the same sum with a different
+    coefficient for every pixel, and uses the same kernel selection.
+*/
+
+#pragma once
+
+#include "cpucore_math_export.h"
+#include "hoNDArray.h"
+
+#include <complex>
+#include <vector>
+
+namespace Gadgetron {
+
+    enum class ChannelMixingKernel { scalar, avx2, avx512 };
+
+    /// The fastest kernel supported by this processor. Can be limited with GADGETRON_CHANNEL_MIXING_KERNEL.
+    EXPORTCPUCOREMATH ChannelMixingKernel best_channel_mixing_kernel();
+
+    EXPORTCPUCOREMATH bool is_supported(ChannelMixingKernel kernel);
+
+    /// Writes input * mixing to output, which must not overlap input.
+    EXPORTCPUCOREMATH void mix_channels(const std::complex<float>* input, std::complex<float>* output, size_t samples,
+        size_t channels_in, size_t channels_out, const std::complex<float>* mixing,
+        ChannelMixingKernel kernel = best_channel_mixing_kernel());
+
+    /// Replaces every readout in the batch with readout * mixing. All readouts must have mixing.get_size(0) channels.
+    EXPORTCPUCOREMATH void mix_channels(
+        const hoNDArray<std::complex<float>>& mixing, const std::vector<hoNDArray<std::complex<float>>*>& readouts);
+
+    /// Writes output(p) = scale * sum_c weights(p, c) * images(p, c), where p runs over the pixels of each channel.
+    EXPORTCPUCOREMATH void combine_channels(const std::complex<float>* weights, const std::complex<float>* images,
+        std::complex<float>* output, size_t pixels, size_t channels, float scale,
+        ChannelMixingKernel kernel = best_channel_mixing_kernel());
+}
@@ -0,0 +1,391 @@
+/** \file hoNDArray_expressions.h
+    \brief Lazy element-wise expressions over hoNDArrays, evaluated in a single pass when assigned.
+
+    Arithmetic on hoNDArrays builds an expression rather than computing anything:
+
+        hoNDArray<std::complex<float>> r = a * b + c * conj(d);
+
+    reads a, b, c and d once and writes r once, in a single threaded and vectorised loop, where calling multiply,
+    multiplyConj and add takes three passes and two temporary arrays. Expressions are evaluated when assigned to or
+    used to construct an hoNDArray, or with evaluate, and support +, -, *, / and unary -, between arrays and
+    expressions and with scalars, and conj, abs, abs_square, real, imag and sqrt. abs, real and imag of a bare array
+    remain the functions of hoNDArray_elemwise.h, which return an array.
+
+    All arrays in an expression must have the same number of elements; the result gets the dimensions of the first
+    array unless it already has that number of elements. The result may be one of the arrays of the expression, but
+    must not otherwise overlap any of them. Complex arrays are computed as complext, like the functions of
+    hoNDArray_elemwise.h, so the compiler can vectorise them. Scalars take part with their own type; use 0.5f rather
+    than 0.5 with float arrays.
+
+    An expression refers to the arrays it was built from, which must outlive it. Temporary arrays are moved into
+    the expression, so expressions are best not kept beyond the statement building them.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+#include "complext.h"
+
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron {
+
+    /// Expressions moving more than this many bytes through memory are evaluated on several threads.
+    constexpr size_t expression_threading_bytes = size_t(1) << 20;
+
+    namespace expression_detail {
+
+        // Complex values are computed as complext; see mathInternalType in hoNDArray_elemwise.cpp
+        template <class T> struct internal { using type = T; };
+        template <class T> struct internal<std::complex<T>> { using type = complext<T>; };
+        template <class T> using internal_t = typename internal<T>::type;
+
+        template <class T> std::true_type array_test(const hoNDArray<T>*);
+        std::false_type array_test(...);
+
+        template <class F, class... Operands> std::true_type expression_test(const hoNDArrayExpression<F, Operands...>*);
+        std::false_type expression_test(...);
+
+        template <class A> constexpr bool is_array_v = decltype(array_test(std::declval<std::decay_t<A>*>()))::value;
+        template <class A> constexpr bool is_expression_v = decltype(expression_test(std::declval<std::decay_t<A>*>()))::value;
+
+        template <class A> struct is_scalar : std::is_arithmetic<A> {};
+        template <class T> struct is_scalar<std::complex<T>> : std::true_type {};
+        template <class A> constexpr bool is_scalar_v = is_scalar<std::decay_t<A>>::value;
+
+        template <class A> constexpr bool is_operand_v = is_array_v<A> || is_expression_v<A>;
+
+        // At least one side must be an array or expression, so arithmetic on other types is left alone
+        template <class A, class B>
+        constexpr bool are_operands_v = (is_operand_v<A> && (is_operand_v<B> || is_scalar_v<B>)) || (is_scalar_v<A> && is_operand_v<B>);
+
+        template <class T> class ArrayOperand
+        {
+        public:
+            using value_type = internal_t<T>;
+
+            explicit ArrayOperand(const hoNDArray<T>& array) : array_(&array) {}
+
+            explicit ArrayOperand(hoNDArray<T>&& array)
+                : owned_(std::make_shared<const hoNDArray<T>>(std::move(array))), array_(owned_.get()) {}
+
+            void check(std::vector<size_t>& dimensions, size_t& elements, bool& found) const
+            {
+                if (!found)
+                {
+                    array_->get_dimensions(dimensions);
+                    elements = array_->get_number_of_elements();
+                    found = true;
+                }
+                else if (array_->get_number_of_elements() != elements)
+                {
+                    throw std::runtime_error("hoNDArray expression: the arrays have different numbers of elements");
+                }
+            }
+
+            size_t bytes_per_element() const { return sizeof(T); }
+
+            struct Evaluator
+            {
+                const value_type* data;
+                value_type operator()(size_t i) const { return data[i]; }
+            };
+
+            Evaluator evaluator() const { return Evaluator{ reinterpret_cast<const value_type*>(array_->get_data_ptr()) }; }
+
+        private:
+            std::shared_ptr<const hoNDArray<T>> owned_;
+            const hoNDArray<T>* array_;
+        };
+
+        template <class T> class ScalarOperand
+        {
+        public:
+            using value_type = T;
+
+            explicit ScalarOperand(T value) : value_(value) {}
+
+            void check(std::vector<size_t>&, size_t&, bool&) const {}
+
+            size_t bytes_per_element() const { return 0; }
+
+            struct Evaluator
+            {
+                value_type value;
+                value_type operator()(size_t) const { return value; }
+            };
+
+            Evaluator evaluator() const { return Evaluator{ value_ }; }
+
+        private:
+            T value_;
+        };
+
+        template <class F, class... Evaluators> struct NodeEvaluator
+        {
+            F f;
+            std::tuple<Evaluators...> operands;
+
+            auto operator()(size_t i) const
+            {
+                return std::apply([&](const Evaluators&... operand) { return f(operand(i)...); }, operands);
+            }
+        };
+
+        template <class A> auto operand(A&& a)
+        {
+            using D = std::decay_t<A>;
+
+            if constexpr (is_expression_v<A>)
+            {
+                return D(std::forward<A>(a));
+            }
+            else if constexpr (is_array_v<A>)
+            {
+                using T = typename D::value_type;
+                if constexpr (std::is_lvalue_reference<A>::value)
+                    return ArrayOperand<T>(static_cast<const hoNDArray<T>&>(a));
+                else
+                    return ArrayOperand<T>(hoNDArray<T>(std::move(a)));
+            }
+            else
+            {
+                return ScalarOperand<internal_t<D>>(internal_t<D>(a));
+            }
+        }
+
+        template <class F, class... A> auto make_expression(F f, A&&... a)
+        {
+            return hoNDArrayExpression<F, decltype(operand(std::forward<A>(a)))...>(f, operand(std::forward<A>(a))...);
+        }
+
+        // The operations. Arguments are taken by value, as some operators of complext are not const.
+
+        struct Plus { template <class A, class B> auto operator()(A a, B b) const { return a + b; } };
+        struct Minus { template <class A, class B> auto operator()(A a, B b) const { return a - b; } };
+        struct Multiplies { template <class A, class B> auto operator()(A a, B b) const { return a * b; } };
+        struct Divides { template <class A, class B> auto operator()(A a, B b) const { return a / b; } };
+        struct Negate { template <class A> auto operator()(A a) const { return -a; } };
+
+        struct Conj { template <class A> auto operator()(A a) const { return conj(a); } };
+
+        struct Abs
+        {
+            template <class A> auto operator()(A a) const
+            {
+                using std::abs;
+                return abs(a);
+            }
+        };
+
+        struct AbsSquare
+        {
+            template <class A> auto operator()(A a) const
+            {
+                if constexpr (is_complex_type_v<A>) return a.real() * a.real() + a.imag() * a.imag();
+                else return a * a;
+            }
+        };
+
+        struct Real
+        {
+            template <class A> auto operator()(A a) const
+            {
+                if constexpr (is_complex_type_v<A>) return a.real();
+                else return a;
+            }
+        };
+
+        struct Imag
+        {
+            template <class A> auto operator()(A a) const
+            {
+                if constexpr (is_complex_type_v<A>) return a.imag();
+                else return A(0);
+            }
+        };
+
+        struct Sqrt
+        {
+            template <class A> auto operator()(A a) const
+            {
+                using std::sqrt;
+                return sqrt(a);
+            }
+        };
+    }
+
+    /// An element-wise operation F on the elements of its operands: arrays, scalars and other expressions.
+    template <class F, class... Operands> class hoNDArrayExpression
+    {
+    public:
+        using value_type = decltype(std::declval<F>()(std::declval<typename Operands::value_type>()...));
+
+        explicit hoNDArrayExpression(F f, Operands... operands) : f_(f), operands_(std::move(operands)...) {}
+
+        /// Takes the dimensions of the first array, and checks all arrays have as many elements.
+        void check(std::vector<size_t>& dimensions, size_t& elements, bool& found) const
+        {
+            std::apply([&](const Operands&... operand) { (operand.check(dimensions, elements, found), ...); }, operands_);
+        }
+
+        /// Bytes read from arrays per element of the result
+        size_t bytes_per_element() const
+        {
+            return std::apply([](const Operands&... operand) { return (size_t(0) + ... + operand.bytes_per_element()); }, operands_);
+        }
+
+        auto evaluator() const
+        {
+            return std::apply([this](const Operands&... operand) {
+                return expression_detail::NodeEvaluator<F, decltype(operand.evaluator())...>{ f_, { operand.evaluator()... } };
+            }, operands_);
+        }
+
+    private:
+        F f_;
+        std::tuple<Operands...> operands_;
+    };
+
+    /// Writes the elements of expression to result, in a single pass.
+    template <class T, class F, class... Operands>
+    void evaluate(const hoNDArrayExpression<F, Operands...>& expression, hoNDArray<T>& result)
+    {
+        using R = expression_detail::internal_t<T>;
+
+        std::vector<size_t> dimensions;
+        size_t elements = 0;
+        bool found = false;
+        expression.check(dimensions, elements, found);
+
+        if (result.get_number_of_elements() != elements) result.create(dimensions);
+
+        // Before the operands are bound, as the result may be one of them
+        result.make_unique();
+        R* out = reinterpret_cast<R*>(result.begin());
+        const auto evaluator = expression.evaluator();
+
+        const long long n = (long long)elements;
+        const bool threaded = elements * (expression.bytes_per_element() + sizeof(T)) > expression_threading_bytes;
+        (void)threaded;
+
+        // Not "parallel for simd": gcc then keeps the temporaries of each element in arrays, and the loop is not vectorized
+#ifdef USE_OMP
+#pragma omp parallel for if (threaded)
+#endif
+        for (long long i = 0; i < n; i++)
+        {
+            out[i] = R(evaluator(size_t(i)));
+        }
+    }
+
+    template <class T> template <class F, class... Operands>
+    hoNDArray<T>::hoNDArray(const hoNDArrayExpression<F, Operands...>& expression) : hoNDArray()
+    {
+        evaluate(expression, *this);
+    }
+
+    template <class T> template <class F, class... Operands>
+    hoNDArray<T>& hoNDArray<T>::operator=(const hoNDArrayExpression<F, Operands...>& expression)
+    {
+        evaluate(expression, *this);
+        return *this;
+    }
+
+    template <class A, class B, class = std::enable_if_t<expression_detail::are_operands_v<A, B>>>
+    auto operator+(A&& a, B&& b)
+    {
+        return expression_detail::make_expression(expression_detail::Plus(), std::forward<A>(a), std::forward<B>(b));
+    }
+
+    template <class A, class B, class = std::enable_if_t<expression_detail::are_operands_v<A, B>>>
+    auto operator-(A&& a, B&& b)
+    {
+        return expression_detail::make_expression(expression_detail::Minus(), std::forward<A>(a), std::forward<B>(b));
+    }
+
+    template <class A, class B, class = std::enable_if_t<expression_detail::are_operands_v<A, B>>>
+    auto operator*(A&& a, B&& b)
+    {
+        return expression_detail::make_expression(expression_detail::Multiplies(), std::forward<A>(a), std::forward<B>(b));
+    }
+
+    template <class A, class B, class = std::enable_if_t<expression_detail::are_operands_v<A, B>>>
+    auto operator/(A&& a, B&& b)
+    {
+        return expression_detail::make_expression(expression_detail::Divides(), std::forward<A>(a), std::forward<B>(b));
+    }
+
+    template <class A, class = std::enable_if_t<expression_detail::is_operand_v<A>>>
+    auto operator-(A&& a)
+    {
+        return expression_detail::make_expression(expression_detail::Negate(), std::forward<A>(a));
+    }
+
+    template <class A, class = std::enable_if_t<expression_detail::is_operand_v<A>>>
+    auto conj(A&& a)
+    {
+        return expression_detail::make_expression(expression_detail::Conj(), std::forward<A>(a));
+    }
+
+    template <class A, class = std::enable_if_t<expression_detail::is_operand_v<A>>>
+    auto abs_square(A&& a)
+    {
+        return expression_detail::make_expression(expression_detail::AbsSquare(), std::forward<A>(a));
+    }
+
+    template <class A, class = std::enable_if_t<expression_detail::is_operand_v<A>>>
+    auto sqrt(A&& a)
+    {
+        return expression_detail::make_expression(expression_detail::Sqrt(), std::forward<A>(a));
+    }
+
+    template <class A, class = std::enable_if_t<expression_detail::is_expression_v<A>>>
+    auto abs(A&& a)
+    {
+        return expression_detail::make_expression(expression_detail::Abs(), std::forward<A>(a));
+    }
+
+    template <class A, class = std::enable_if_t<expression_detail::is_expression_v<A>>>
+    auto real(A&& a)
+    {
+        return expression_detail::make_expression(expression_detail::Real(), std::forward<A>(a));
+    }
+
+    template <class A, class = std::enable_if_t<expression_detail::is_expression_v<A>>>
+    auto imag(A&& a)
+    {
+        return expression_detail::make_expression(expression_detail::Imag(), std::forward<A>(a));
+    }
+
+    template <class T, class F, class... Operands>
+    hoNDArray<T>& operator+=(hoNDArray<T>& x, const hoNDArrayExpression<F, Operands...>& expression)
+    {
+        evaluate(x + expression, x);
+        return x;
+    }
+
+    template <class T, class F, class... Operands>
+    hoNDArray<T>& operator-=(hoNDArray<T>& x, const hoNDArrayExpression<F, Operands...>& expression)
+    {
+        evaluate(x - expression, x);
+        return x;
+    }
+
+    template <class T, class F, class... Operands>
+    hoNDArray<T>& operator*=(hoNDArray<T>& x, const hoNDArrayExpression<F, Operands...>& expression)
+    {
+        evaluate(x * expression, x);
+        return x;
+    }
+}
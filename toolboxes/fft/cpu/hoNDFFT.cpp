@@ -9,7 +9,14 @@
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_math.h"
 #include "hoNDFFT.h"
+#include "log.h"
+#include <atomic>
 #include <boost/container/flat_set.hpp>
+#include <boost/filesystem.hpp>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <tuple>
 
 namespace Gadgetron {
 
@@ -26,49 +33,114 @@ namespace Gadgetron {
         template <class T> struct fftw_types {};
 
         template <> struct fftw_types<float> {
-            using complex                      = fftwf_complex;
-            using plan                         = fftwf_plan_s;
-            static constexpr auto plan_guru    = fftwf_plan_guru64_dft;
-            static constexpr auto execute_dft  = fftwf_execute_dft;
-            static constexpr auto destroy_plan = fftwf_destroy_plan;
+            using complex                         = fftwf_complex;
+            using plan                            = fftwf_plan_s;
+            static constexpr auto plan_guru       = fftwf_plan_guru64_dft;
+            static constexpr auto execute_dft     = fftwf_execute_dft;
+            static constexpr auto destroy_plan    = fftwf_destroy_plan;
+            static constexpr auto malloc          = fftwf_malloc;
+            static constexpr auto free            = fftwf_free;
+            static constexpr auto alignment_of    = fftwf_alignment_of;
+            static constexpr auto import_wisdom   = fftwf_import_wisdom_from_filename;
+            static constexpr auto export_wisdom   = fftwf_export_wisdom_to_filename;
+            static constexpr const char* wisdom   = "fftwf_wisdom";
         };
 
         template <> struct fftw_types<double> {
-            using complex                      = fftw_complex;
-            using plan                         = fftw_plan_s;
-            static constexpr auto plan_guru    = fftw_plan_guru64_dft;
-            static constexpr auto execute_dft  = fftw_execute_dft;
-            static constexpr auto destroy_plan = fftw_destroy_plan;
+            using complex                         = fftw_complex;
+            using plan                            = fftw_plan_s;
+            static constexpr auto plan_guru       = fftw_plan_guru64_dft;
+            static constexpr auto execute_dft     = fftw_execute_dft;
+            static constexpr auto destroy_plan    = fftw_destroy_plan;
+            static constexpr auto malloc          = fftw_malloc;
+            static constexpr auto free            = fftw_free;
+            static constexpr auto alignment_of    = fftw_alignment_of;
+            static constexpr auto import_wisdom   = fftw_import_wisdom_from_filename;
+            static constexpr auto export_wisdom   = fftw_export_wisdom_to_filename;
+            static constexpr const char* wisdom   = "fftw_wisdom";
         };
+
+        // The FFTW planner, including wisdom, is not thread safe. Executing plans is.
         class FFTLock {
         protected:
             static std::mutex lock;
         };
         std::mutex FFTLock::lock;
-        template <class T> class SingleFFTPlan : FFTLock {
+
+        FFT::Planning planning_from_environment() {
+            auto selection = std::getenv("GADGETRON_FFT_PLANNING");
+            if (!selection)
+                return FFT::Planning::estimate;
+
+            auto name = std::string(selection);
+            if (name == "estimate")
+                return FFT::Planning::estimate;
+            if (name == "measure")
+                return FFT::Planning::measure;
+            if (name == "patient")
+                return FFT::Planning::patient;
+
+            GWARN_STREAM("Unknown GADGETRON_FFT_PLANNING " << selection << "; estimating plans.");
+            return FFT::Planning::estimate;
+        }
+
+        std::atomic<FFT::Planning>& current_planning() {
+            static std::atomic<FFT::Planning> planning{ planning_from_environment() };
+            return planning;
+        }
+
+        unsigned planner_flags(FFT::Planning planning) {
+            switch (planning) {
+            case FFT::Planning::measure: return FFTW_MEASURE;
+            case FFT::Planning::patient: return FFTW_PATIENT;
+            default: return FFTW_ESTIMATE;
+            }
+        }
+
+        boost::filesystem::path wisdom_folder() {
+            auto folder = std::getenv("GADGETRON_FFT_WISDOM_FOLDER");
+            return folder ? boost::filesystem::path(folder) : boost::filesystem::temp_directory_path() / "gadgetron";
+        }
+
+        /**
+         * A plan for one transform (or one batch of contiguous dimensions) of a given layout. Plans are
+         * created on scratch memory, as measuring overwrites the arrays, and executed on the actual data with the
+         * new-array interface. This requires the data to have the alignment the plan was made for; plans for
+         * unaligned data are made with FFTW_UNALIGNED.
+         */
+        template <class T> class FFTPlan : FFTLock {
         public:
             using FFTWComplex = typename fftw_types<T>::complex;
 
-            SingleFFTPlan(int dimension, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output,
-                bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
+            FFTPlan(const std::vector<fftw_iodim64>& dimensions, bool forward, bool in_place, bool aligned,
+                unsigned flags) {
 
-                const auto& dimensions = input.dimensions();
-                size_t stride
-                    = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
+                size_t elements = 1;
+                for (auto& dimension : dimensions)
+                    elements += (dimension.n - 1) * dimension.is;
 
-                auto fftw_dimensions = fftw_iodim64{ static_cast<ptrdiff_t>(dimensions[dimension]), static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) };
+                auto input  = (FFTWComplex*)fftw_types<T>::malloc(elements * sizeof(FFTWComplex));
+                auto output = in_place ? input : (FFTWComplex*)fftw_types<T>::malloc(elements * sizeof(FFTWComplex));
 
-                plan = fftw_types<T>::plan_guru(1, &fftw_dimensions, 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                plan = fftw_types<T>::plan_guru(int(dimensions.size()), dimensions.data(), 0, nullptr, input, output,
+                    forward ? FFTW_FORWARD : FFTW_BACKWARD, flags | (aligned ? 0 : FFTW_UNALIGNED));
+
+                if (!in_place)
+                    fftw_types<T>::free(output);
+                fftw_types<T>::free(input);
+
+                if (!plan)
+                    throw std::runtime_error("FFTW failed to create a plan");
             }
 
-            ~SingleFFTPlan() {
+            FFTPlan(const FFTPlan&) = delete;
+
+            ~FFTPlan() {
                 std::lock_guard<std::mutex> guard(lock);
                 fftw_types<T>::destroy_plan(plan);
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
+            void execute(const std::complex<T>* input, std::complex<T>* output) const {
                 fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
             }
 
@@ -76,40 +148,155 @@ namespace Gadgetron {
             typename fftw_types<T>::plan* plan;
         };
 
-        template <class T> class ContigousFFTPlan : FFTLock {
+        /**
+         * Plans are kept for the lifetime of the process, keyed by layout, direction, placement, alignment and
+         * planner flags. Wisdom is loaded when the cache is first used, and saved whenever a plan has been measured,
+         * so measuring is done once per machine rather than once per process.
+         */
+        template <class T> class PlanCache : FFTLock {
         public:
-            using FFTWComplex = typename fftw_types<T>::complex;
-            ContigousFFTPlan(
-                int rank, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, bool forward) {
-                std::lock_guard<std::mutex> guard(lock);
+            static PlanCache& instance() {
+                static PlanCache cache;
+                return cache;
+            }
+
+            std::shared_ptr<const FFTPlan<T>> plan(
+                const std::vector<fftw_iodim64>& dimensions, bool forward, bool in_place, bool aligned) {
+
+                auto key = Key{ layout_of(dimensions), forward, in_place, aligned,
+                    planner_flags(current_planning().load()) };
+
+                {
+                    std::lock_guard<std::mutex> guard(plans_lock);
+                    auto cached = plans.find(key);
+                    if (cached != plans.end())
+                        return cached->second;
+                }
 
-                const auto& dimensions = input.dimensions();
+                std::lock_guard<std::mutex> guard(lock);
+                {
+                    // Another thread may have made the plan while we were waiting for the planner.
+                    std::lock_guard<std::mutex> plans_guard(plans_lock);
+                    auto cached = plans.find(key);
+                    if (cached != plans.end())
+                        return cached->second;
+                }
 
-                auto strides = std::vector<size_t>(rank + 1, 1);
-                std::partial_sum(
-                    dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+                auto plan = std::make_shared<const FFTPlan<T>>(dimensions, forward, in_place, aligned, key.flags);
+                if (key.flags != FFTW_ESTIMATE)
+                    save_wisdom();
 
-                auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+                std::lock_guard<std::mutex> plans_guard(plans_lock);
+                plans.emplace(std::move(key), plan);
+                return plan;
+            }
 
-                for (int i = 0; i < rank; i++) {
-                    fftw_dimensions[i] = { (int64_t)dimensions[i], (int64_t)strides[i], (int64_t)strides[i] };
+        private:
+            using Layout = std::vector<std::tuple<ptrdiff_t, ptrdiff_t, ptrdiff_t>>;
+
+            struct Key {
+                Layout layout;
+                bool forward;
+                bool in_place;
+                bool aligned;
+                unsigned flags;
+
+                bool operator<(const Key& other) const {
+                    return std::tie(layout, forward, in_place, aligned, flags)
+                           < std::tie(other.layout, other.forward, other.in_place, other.aligned, other.flags);
                 }
-                plan = fftw_types<T>::plan_guru(rank, fftw_dimensions.data(), 0, nullptr, (FFTWComplex*)input.data(),
-                    (FFTWComplex*)output.data(), forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+            };
+
+            static Layout layout_of(const std::vector<fftw_iodim64>& dimensions) {
+                Layout layout;
+                for (auto& dimension : dimensions)
+                    layout.emplace_back(dimension.n, dimension.is, dimension.os);
+                return layout;
             }
-            ~ContigousFFTPlan() {
+
+            PlanCache() : wisdom(wisdom_folder() / fftw_types<T>::wisdom) {
                 std::lock_guard<std::mutex> guard(lock);
-                fftw_types<T>::destroy_plan(plan);
+                boost::system::error_code error;
+                if (boost::filesystem::exists(wisdom, error) && !fftw_types<T>::import_wisdom(wisdom.string().c_str()))
+                    GWARN_STREAM("Failed to import FFTW wisdom from " << wisdom);
             }
 
-            void execute(const std::complex<T>* input, std::complex<T>* output) {
-                fftw_types<T>::execute_dft(plan, (FFTWComplex*)input, (FFTWComplex*)output);
+            // Called with the planner lock held. Written next to the file and renamed, so other processes never
+            // import partial wisdom.
+            void save_wisdom() const {
+                boost::system::error_code error;
+                boost::filesystem::create_directories(wisdom.parent_path(), error);
+
+                auto temporary = wisdom;
+                temporary += boost::filesystem::unique_path(".%%%%-%%%%-%%%%-%%%%.tmp");
+                if (!fftw_types<T>::export_wisdom(temporary.string().c_str())) {
+                    GDEBUG_STREAM("Failed to export FFTW wisdom to " << temporary);
+                    return;
+                }
+
+                boost::filesystem::rename(temporary, wisdom, error);
+                if (error) {
+                    GDEBUG_STREAM("Failed to move FFTW wisdom into place at " << wisdom);
+                    boost::filesystem::remove(temporary, error);
+                }
             }
 
-        private:
-            typename fftw_types<T>::plan* plan;
+            const boost::filesystem::path wisdom;
+            std::mutex plans_lock;
+            std::map<Key, std::shared_ptr<const FFTPlan<T>>> plans;
         };
 
+        // FFTW requires data executed on an aligned plan to be SIMD aligned; 64 bytes suffices for every instruction set.
+        template <class T> bool is_aligned(const std::complex<T>* data) {
+            return fftw_types<T>::alignment_of((T*)data) == 0;
+        }
+
+        template <class T> bool batches_aligned(const std::complex<T>* data, size_t batch_size, size_t batches) {
+            return is_aligned(data) && (batches == 1 || (batch_size * sizeof(std::complex<T>)) % 64 == 0);
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> contigous_plan(
+            int rank, const hoNDArray<std::complex<T>>& input, hoNDArray<std::complex<T>>& output, bool forward) {
+
+            const auto& dimensions = input.dimensions();
+
+            auto strides = std::vector<size_t>(rank + 1, 1);
+            std::partial_sum(dimensions.begin(), dimensions.begin() + rank, strides.begin() + 1, std::multiplies<>());
+
+            auto fftw_dimensions = std::vector<fftw_iodim64>(rank);
+            for (int i = 0; i < rank; i++) {
+                fftw_dimensions[i] = { (ptrdiff_t)dimensions[i], (ptrdiff_t)strides[i], (ptrdiff_t)strides[i] };
+            }
+
+            size_t batch_size = strides[rank];
+            size_t batches    = input.size() / batch_size;
+            bool aligned
+                = batches_aligned(input.data(), batch_size, batches) && batches_aligned(output.data(), batch_size, batches);
+
+            return PlanCache<T>::instance().plan(fftw_dimensions, forward, input.data() == output.data(), aligned);
+        }
+
+        template <class T>
+        std::shared_ptr<const FFTPlan<T>> single_plan(int dimension, const hoNDArray<std::complex<T>>& input,
+            hoNDArray<std::complex<T>>& output, bool forward) {
+
+            const auto& dimensions = input.dimensions();
+            size_t stride
+                = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, size_t(1), std::multiplies<>());
+
+            auto fftw_dimensions = std::vector<fftw_iodim64>{ { static_cast<ptrdiff_t>(dimensions[dimension]),
+                static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride) } };
+
+            // Transforms along inner strides start at every element, so only the outermost dimension can be aligned.
+            size_t batch_size = stride * dimensions[dimension];
+            size_t batches    = input.size() / batch_size;
+            bool aligned      = stride == 1 && batches_aligned(input.data(), batch_size, batches)
+                           && batches_aligned(output.data(), batch_size, batches);
+
+            return PlanCache<T>::instance().plan(fftw_dimensions, forward, input.data() == output.data(), aligned);
+        }
+
         const int num_max_threads = omp_get_max_threads();
 
         int contigous_rank(const boost::container::flat_set<int>& dimensions) {
@@ -126,7 +313,7 @@ namespace Gadgetron {
         static void contigous_fftn(const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r, int rank,
             bool forward, bool normalize) {
 
-            auto plan = ContigousFFTPlan<T>(rank, a, r, forward);
+            auto plan = contigous_plan(rank, a, r, forward);
             size_t batch_size
                 = std::accumulate(a.dimensions().begin(), a.dimensions().begin() + rank, 1, std::multiplies<>());
             size_t batches = a.size() / batch_size;
@@ -134,18 +321,86 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan,  a, r, batches, batch_size)
             for (long long i = 0; i < batches; i++) {
 
-                plan.execute(a.data() + i * batch_size, r.data() + i * batch_size);
+                plan->execute(a.data() + i * batch_size, r.data() + i * batch_size);
             }
 
             if (normalize)
                 r *= T(1) / std::sqrt<T>(batch_size);
         }
 
+        // Multiplies every batch element by scale * (-1)^(sum of its indices). Requires an even first dimension.
+        template <typename T>
+        static void checkerboard(const std::complex<T>* input, std::complex<T>* output,
+            const std::vector<size_t>& dimensions, int rank, T scale) {
+
+            size_t line  = dimensions[0];
+            size_t lines = std::accumulate(
+                dimensions.begin() + 1, dimensions.begin() + rank, size_t(1), std::multiplies<>());
+
+            for (size_t l = 0; l < lines; l++) {
+                size_t parity = 0;
+                size_t index  = l;
+                for (int d = 1; d < rank; d++) {
+                    parity += index % dimensions[d];
+                    index /= dimensions[d];
+                }
+
+                const T sign = (parity & 1) ? -scale : scale;
+                auto in      = reinterpret_cast<const T*>(input + l * line);
+                auto out     = reinterpret_cast<T*>(output + l * line);
+                for (size_t x = 0; x < 2 * line; x += 4) {
+                    out[x]     = sign * in[x];
+                    out[x + 1] = sign * in[x + 1];
+                    out[x + 2] = -sign * in[x + 2];
+                    out[x + 3] = -sign * in[x + 3];
+                }
+            }
+        }
+
+        /**
+         * Centred transform, fftshift(fft(ifftshift(a))), over the first rank dimensions. For even sizes the shifts
+         * are equivalent to multiplying by (-1)^n before the transform and by (-1)^(k + N/2) after it, so each batch
+         * is modulated into r, transformed in place and modulated again while still in cache, rather than shifted
+         * through memory twice. Returns false for odd sizes, which need the shifts.
+         */
+        template <typename T>
+        static bool centered_fftn(
+            const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r, int rank, bool forward) {
+
+            const auto& dimensions = a.dimensions();
+            if (dimensions.size() < size_t(rank))
+                return false;
+
+            size_t half_sizes = 0;
+            for (int d = 0; d < rank; d++) {
+                if (dimensions[d] % 2)
+                    return false;
+                half_sizes += dimensions[d] / 2;
+            }
+
+            size_t batch_size
+                = std::accumulate(dimensions.begin(), dimensions.begin() + rank, size_t(1), std::multiplies<>());
+            size_t batches = a.size() / batch_size;
+            T scale        = ((half_sizes & 1) ? T(-1) : T(1)) / std::sqrt(T(batch_size));
+
+            auto plan = contigous_plan(rank, r, r, forward);
+
+#pragma omp parallel for default(none) shared(plan, a, r, dimensions, rank, batches, batch_size, scale)
+            for (long long i = 0; i < batches; i++) {
+                auto output = r.data() + i * batch_size;
+                checkerboard(a.data() + i * batch_size, output, dimensions, rank, T(1));
+                plan->execute(output, output);
+                checkerboard(output, output, dimensions, rank, scale);
+            }
+
+            return true;
+        }
+
         template <typename T>
         static void single_fft(int dimension, const hoNDArray<std::complex<T>>& a, hoNDArray<std::complex<T>>& r,
             bool forward, bool normalize) {
             assert(dimension >= 0);
-            auto plan              = SingleFFTPlan<T>(dimension, a, r, forward);
+            auto plan              = single_plan(dimension, a, r, forward);
             const auto& dimensions = a.dimensions();
             size_t inner_batches
                 = std::accumulate(dimensions.begin(), dimensions.begin() + dimension, 1, std::multiplies<>());
@@ -156,7 +411,7 @@ namespace Gadgetron {
 #pragma omp parallel for default(none) shared(plan, a, r , outer_batches, inner_batches, outer_batchsize ) collapse(2)
             for (long long outer = 0; outer < outer_batches; outer++) {
                 for (long long inner = 0; inner < inner_batches; inner++) {
-                    plan.execute(
+                    plan->execute(
                         a.data() + inner + outer * outer_batchsize, r.data() + inner + outer * outer_batchsize);
                 }
             }
@@ -501,24 +756,38 @@ namespace Gadgetron {
     }
 
     template <typename T> inline void hoNDFFT<T>::fft1c(hoNDArray<ComplexType>& a) {
+        if (centered_fftn(a, a, 1, true))
+            return;
         ifftshift1D(a);
         fft1(a);
         fftshift1D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft1c(hoNDArray<ComplexType>& a) {
+        if (centered_fftn(a, a, 1, false))
+            return;
         ifftshift1D(a);
         ifft1(a);
         fftshift1D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::fft1c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 1, true))
+            return;
         ifftshift1D(a, r);
         fft1(r);
         fftshift1D(r);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft1c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 1, false))
+            return;
         ifftshift1D(a, r);
         ifft1(r);
         fftshift1D(r);
@@ -527,6 +796,11 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::fft1c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 1, true))
+            return;
         ifftshift1D(a, r);
         fft1(r, buf);
         fftshift1D(buf, r);
@@ -535,6 +809,11 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::ifft1c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 1, false))
+            return;
         ifftshift1D(a, r);
         ifft1(r, buf);
         fftshift1D(buf, r);
@@ -567,24 +846,38 @@ namespace Gadgetron {
     }
 
     template <typename T> inline void hoNDFFT<T>::fft2c(hoNDArray<ComplexType>& a) {
+        if (centered_fftn(a, a, 2, true))
+            return;
         ifftshift2D(a);
         fft2(a);
         fftshift2D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft2c(hoNDArray<ComplexType>& a) {
+        if (centered_fftn(a, a, 2, false))
+            return;
         ifftshift2D(a);
         ifft2(a);
         fftshift2D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::fft2c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 2, true))
+            return;
         ifftshift2D(a, r);
         fft2(r);
         fftshift2D(r);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft2c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 2, false))
+            return;
         ifftshift2D(a, r);
         ifft2(r);
         fftshift2D(r);
@@ -593,6 +886,11 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::fft2c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 2, true))
+            return;
         ifftshift2D(a, r);
         fft2(r, buf);
         fftshift2D(buf, r);
@@ -601,6 +899,11 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::ifft2c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 2, false))
+            return;
         ifftshift2D(a, r);
         ifft2(r, buf);
         fftshift2D(buf, r);
@@ -637,24 +940,38 @@ namespace Gadgetron {
     }
 
     template <typename T> inline void hoNDFFT<T>::fft3c(hoNDArray<ComplexType>& a) {
+        if (centered_fftn(a, a, 3, true))
+            return;
         ifftshift3D(a);
         fft3(a);
         fftshift3D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft3c(hoNDArray<ComplexType>& a) {
+        if (centered_fftn(a, a, 3, false))
+            return;
         ifftshift3D(a);
         ifft3(a);
         fftshift3D(a);
     }
 
     template <typename T> inline void hoNDFFT<T>::fft3c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 3, true))
+            return;
         ifftshift3D(a, r);
         fft3(r);
         fftshift3D(r);
     }
 
     template <typename T> inline void hoNDFFT<T>::ifft3c(const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 3, false))
+            return;
         ifftshift3D(a, r);
         ifft3(r);
         fftshift3D(r);
@@ -663,6 +980,11 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::fft3c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 3, true))
+            return;
         ifftshift3D(a, r);
         fft3(r, buf);
         fftshift3D(buf, r);
@@ -671,6 +993,11 @@ namespace Gadgetron {
     template <typename T>
     inline void hoNDFFT<T>::ifft3c(
         const hoNDArray<ComplexType>& a, hoNDArray<ComplexType>& r, hoNDArray<ComplexType>& buf) {
+        if (!r.dimensions_equal(&a)) {
+            r.create(a.get_dimensions());
+        }
+        if (centered_fftn(a, r, 3, false))
+            return;
         ifftshift3D(a, r);
         ifft3(r, buf);
         fftshift3D(buf, r);
@@ -810,6 +1137,14 @@ namespace Gadgetron {
     }
 
 
+    void FFT::set_planning(Planning planning) {
+        current_planning() = planning;
+    }
+
+    FFT::Planning FFT::planning() {
+        return current_planning();
+    }
+
     template <class ComplexType, class ENABLER>
     void FFT::fft(hoNDArray<ComplexType>& data, std::vector<size_t> dimensions) {
         std::sort(dimensions.begin(), dimensions.end());
@@ -22,6 +22,18 @@ namespace Gadgetron {
 
     namespace FFT {
 
+        /**
+         * How FFTW plans are made. Plans are cached and reused for every transform with the same layout, so
+         * measuring (or patiently measuring) is done once per layout, and later once per machine through the FFTW
+         * wisdom kept in GADGETRON_FFT_WISDOM_FOLDER (default: <temp>/gadgetron).
+         *
+         * The default is read from GADGETRON_FFT_PLANNING ("estimate", "measure" or "patient"), and is estimate.
+         */
+        enum class Planning { estimate, measure, patient };
+
+        EXPORTCPUFFT void set_planning(Planning planning);
+        EXPORTCPUFFT Planning planning();
+
         /**
          * Performs a standard in-place FFT over the specified dimensions
          * @tparam ComplexType Complex type, such as std::complex<float> or complex<double>
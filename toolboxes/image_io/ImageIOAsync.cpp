@@ -0,0 +1,285 @@
+/** \file       ImageIOAsync.cpp
+    \brief      Export arrays and images for debugging on a background thread
+*/
+
+#include "ImageIOAsync.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef GADGETRON_IMAGE_IO_ZLIB
+#include <zlib.h>
+#endif
+
+namespace Gadgetron {
+
+namespace
+{
+    const char compressed_magic[4] = { 'G', 'T', 'N', 'D' };
+    const uint32_t compressed_version = 1;
+
+    // Arrays are compressed in blocks, so no single call to zlib sees more than its 32 bit lengths can express.
+    const size_t compressed_block_bytes = size_t(16) * 1024 * 1024;
+
+    template <typename T> void write_value(std::ostream& stream, T value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T> T read_value(std::istream& stream)
+    {
+        T value;
+        stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!stream) throw std::runtime_error("Unexpected end of compressed array file");
+        return value;
+    }
+}
+
+struct ImageIOAsync::CompressedReader
+{
+    std::ifstream file;
+    uint32_t compression;
+};
+
+ImageIOAsync::ImageIOAsync(size_t queue_bytes, Format format)
+    : queue_bytes_(queue_bytes), format_(format), queued_bytes_(0), writing_(false), closed_(false), dropped_(0)
+{
+}
+
+ImageIOAsync::~ImageIOAsync()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        closed_ = true;
+    }
+    changed_.notify_all();
+
+    if (writer_.joinable()) writer_.join();
+}
+
+void ImageIOAsync::configure(size_t queue_bytes, Format format)
+{
+    this->flush();
+
+    queue_bytes_ = queue_bytes;
+    format_ = format;
+
+#ifndef GADGETRON_IMAGE_IO_ZLIB
+    if (format_ == Format::compressed)
+    {
+        GWARN_STREAM("Gadgetron was built without zlib; arrays in the compressed format will be written uncompressed");
+    }
+#endif // GADGETRON_IMAGE_IO_ZLIB
+}
+
+ImageIOAsync::Format ImageIOAsync::format_from_string(const std::string& format)
+{
+    if (format == "analyze") return Format::analyze;
+    if (format == "compressed") return Format::compressed;
+
+    GADGET_THROW("Unknown debug output format: " + format);
+}
+
+void ImageIOAsync::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() { return queue_.empty() && !writing_; });
+}
+
+bool ImageIOAsync::reserve(size_t bytes, const std::string& filename)
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (queued_bytes_ + bytes <= queue_bytes_)
+        {
+            queued_bytes_ += bytes;
+            return true;
+        }
+    }
+
+    dropped_++;
+    GWARN_STREAM("Dropped debug output " << filename << " (" << bytes << " bytes); the queue of arrays waiting to be written is full");
+    return false;
+}
+
+void ImageIOAsync::release(size_t bytes)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    queued_bytes_ -= bytes;
+}
+
+void ImageIOAsync::enqueue(Job job)
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        queue_.push_back(std::move(job));
+
+        // The writer is only started once there is something to write
+        if (!writer_.joinable()) writer_ = std::thread([this]() { this->write_queued(); });
+    }
+    changed_.notify_all();
+}
+
+void ImageIOAsync::write_queued()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+        changed_.wait(lock, [this]() { return !queue_.empty() || closed_; });
+        if (queue_.empty()) return;
+
+        Job job = std::move(queue_.front());
+        queue_.pop_front();
+        writing_ = true;
+
+        lock.unlock();
+        try
+        {
+            job.write();
+        }
+        catch (const std::exception& e)
+        {
+            GERROR_STREAM("Failed to write debug output " << job.filename << ": " << e.what());
+        }
+        catch (...)
+        {
+            GERROR_STREAM("Failed to write debug output " << job.filename);
+        }
+
+        // The array is released before its memory stops counting against the queue
+        job.write = nullptr;
+        lock.lock();
+
+        queued_bytes_ -= job.bytes;
+        writing_ = false;
+        changed_.notify_all();
+    }
+}
+
+void ImageIOAsync::write_compressed(const std::string& filename, ImageIODataType type, const std::vector<size_t>& dims, const char* data, size_t bytes)
+{
+    std::string filenameData = filename;
+    filenameData.append(".ndz");
+
+    std::ofstream file(filenameData, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) GADGET_THROW("Unable to open " + filenameData);
+
+#ifdef GADGETRON_IMAGE_IO_ZLIB
+    const uint32_t compression = 1;
+    std::vector<Bytef> buffer;
+#else
+    const uint32_t compression = 0;
+#endif // GADGETRON_IMAGE_IO_ZLIB
+
+    file.write(compressed_magic, sizeof(compressed_magic));
+    write_value<uint32_t>(file, compressed_version);
+    write_value<uint32_t>(file, uint32_t(type));
+    write_value<uint32_t>(file, compression);
+
+    write_value<uint64_t>(file, dims.size());
+    for (auto d : dims) write_value<uint64_t>(file, d);
+
+    for (size_t offset = 0; offset < bytes; offset += compressed_block_bytes)
+    {
+        size_t raw = std::min(compressed_block_bytes, bytes - offset);
+
+#ifdef GADGETRON_IMAGE_IO_ZLIB
+        uLongf stored = compressBound(uLong(raw));
+        buffer.resize(stored);
+        if (compress2(buffer.data(), &stored, reinterpret_cast<const Bytef*>(data + offset), uLong(raw), Z_BEST_SPEED) != Z_OK)
+        {
+            GADGET_THROW("Failed to compress " + filenameData);
+        }
+
+        write_value<uint64_t>(file, raw);
+        write_value<uint64_t>(file, stored);
+        file.write(reinterpret_cast<const char*>(buffer.data()), stored);
+#else
+        write_value<uint64_t>(file, raw);
+        write_value<uint64_t>(file, raw);
+        file.write(data + offset, raw);
+#endif // GADGETRON_IMAGE_IO_ZLIB
+    }
+
+    file.close();
+    if (!file) GADGET_THROW("Failed to write " + filenameData);
+}
+
+std::shared_ptr<ImageIOAsync::CompressedReader> ImageIOAsync::open_compressed(const std::string& filename, ImageIODataType type, std::vector<size_t>& dims)
+{
+    std::string filenameData = filename;
+    filenameData.append(".ndz");
+
+    auto reader = std::make_shared<CompressedReader>();
+    reader->file.open(filenameData, std::ios::in | std::ios::binary);
+    if (!reader->file) GADGET_THROW("Unable to open " + filenameData);
+
+    char magic[sizeof(compressed_magic)];
+    reader->file.read(magic, sizeof(magic));
+    if (!reader->file || std::memcmp(magic, compressed_magic, sizeof(magic)) != 0)
+    {
+        GADGET_THROW(filenameData + " is not a compressed array file");
+    }
+
+    if (read_value<uint32_t>(reader->file) != compressed_version)
+    {
+        GADGET_THROW("Unsupported version of compressed array file " + filenameData);
+    }
+
+    if (read_value<uint32_t>(reader->file) != uint32_t(type))
+    {
+        GADGET_THROW("Data type of " + filenameData + " does not match the array read into");
+    }
+
+    reader->compression = read_value<uint32_t>(reader->file);
+#ifdef GADGETRON_IMAGE_IO_ZLIB
+    if (reader->compression > 1)
+#else
+    if (reader->compression != 0)
+#endif // GADGETRON_IMAGE_IO_ZLIB
+    {
+        GADGET_THROW("Unsupported compression in " + filenameData);
+    }
+
+    dims.resize(read_value<uint64_t>(reader->file));
+    for (auto& d : dims) d = read_value<uint64_t>(reader->file);
+
+    return reader;
+}
+
+void ImageIOAsync::read_compressed(CompressedReader& reader, char* data, size_t bytes)
+{
+    std::vector<char> buffer;
+
+    size_t offset = 0;
+    while (offset < bytes)
+    {
+        auto raw = read_value<uint64_t>(reader.file);
+        auto stored = read_value<uint64_t>(reader.file);
+        if (raw > bytes - offset) throw std::runtime_error("Compressed array file holds more data than its dimensions");
+
+        if (reader.compression == 0)
+        {
+            reader.file.read(data + offset, raw);
+        }
+        else
+        {
+#ifdef GADGETRON_IMAGE_IO_ZLIB
+            buffer.resize(stored);
+            reader.file.read(buffer.data(), stored);
+
+            uLongf length = uLongf(raw);
+            if (uncompress(reinterpret_cast<Bytef*>(data + offset), &length, reinterpret_cast<const Bytef*>(buffer.data()), uLong(stored)) != Z_OK || length != raw)
+            {
+                throw std::runtime_error("Failed to decompress array file");
+            }
+#endif // GADGETRON_IMAGE_IO_ZLIB
+        }
+
+        if (!reader.file) throw std::runtime_error("Unexpected end of compressed array file");
+        offset += raw;
+    }
+}
+
+}
@@ -0,0 +1,202 @@
+/** \file       ImageIOAsync.h
+    \brief      Export arrays and images for debugging on a background thread
+
+    Arrays handed to the exporter are written by a single writer thread, so the caller does not wait for the disk.
+    Arrays which share their memory (see hoNDArray::share) are handed over without a copy; others are copied once,
+    as the caller is free to overwrite them as soon as the export call returns. The arrays waiting to be written may
+    hold at most queue_bytes of memory; arrays arriving while the queue is full are dropped, not waited for.
+
+    Two formats are written. The Analyze format is that of ImageIOAnalyze, with complex arrays split into _REAL,
+    _IMAG, _MAG and _PHASE files. The compressed format writes each array, complex or not, to a single file
+    "<filename>.ndz":
+
+        char     magic[4]       "GTND"
+        uint32   version        1
+        uint32   data type      ImageIODataType of the elements
+        uint32   compression    0 for none, 1 for zlib
+        uint64   ndims
+        uint64   dims[ndims]
+        blocks, each of
+            uint64   raw bytes
+            uint64   stored bytes
+            char     data[stored bytes]
+
+    Without zlib, the compressed format is written uncompressed.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "ImageIOAnalyze.h"
+
+namespace Gadgetron {
+
+class EXPORTIMAGEIO ImageIOAsync
+{
+public:
+
+    enum class Format { analyze, compressed };
+
+    static constexpr size_t default_queue_bytes = size_t(1024) * 1024 * 1024;
+
+    /// queue_bytes: memory the arrays waiting to be written may hold; 0 writes on the calling thread
+    explicit ImageIOAsync(size_t queue_bytes = default_queue_bytes, Format format = Format::analyze);
+
+    /// Waits for the queued arrays to be written
+    ~ImageIOAsync();
+
+    /// Changes how later exports are written. Call it before exporting, not while arrays are queued.
+    void configure(size_t queue_bytes, Format format);
+
+    /// "analyze" or "compressed"
+    static Format format_from_string(const std::string& format);
+
+    /// Waits until every queued array has been written
+    void flush();
+
+    /// Number of exports dropped because the queue was full
+    size_t dropped() const { return dropped_; }
+
+    template <typename T>
+    void export_array(const hoNDArray<T>& a, const std::string& filename)
+    {
+        this->submit(a, filename, [this](const hoNDArray<T>& x, const std::string& name) {
+            if (format_ == Format::compressed) this->write_compressed(x, name);
+            else analyze_.export_array(x, name);
+        });
+    }
+
+    template <typename T>
+    void export_array_complex(const hoNDArray<T>& a, const std::string& filename)
+    {
+        this->submit(a, filename, [this](const hoNDArray<T>& x, const std::string& name) {
+            if (format_ == Format::compressed) this->write_compressed(x, name);
+            else analyze_.export_array_complex(x, name);
+        });
+    }
+
+    template <typename T, unsigned int D>
+    void export_image(const hoNDImage<T, D>& a, const std::string& filename)
+    {
+        this->submit(a, filename, [this](const hoNDImage<T, D>& x, const std::string& name) {
+            if (format_ == Format::compressed) this->write_compressed(x, name);
+            else analyze_.export_image(x, name);
+        });
+    }
+
+    template <typename T, unsigned int D>
+    void export_image_complex(const hoNDImage<T, D>& a, const std::string& filename)
+    {
+        this->submit(a, filename, [this](const hoNDImage<T, D>& x, const std::string& name) {
+            if (format_ == Format::compressed) this->write_compressed(x, name);
+            else analyze_.export_image_complex(x, name);
+        });
+    }
+
+    /// Reads an array written in the compressed format; filename is given without the extension
+    template <typename T>
+    static void import_compressed(hoNDArray<T>& a, const std::string& filename)
+    {
+        std::vector<size_t> dims;
+        auto reader = open_compressed(filename, data_type<T>(), dims);
+        a.create(dims);
+        read_compressed(*reader, reinterpret_cast<char*>(a.begin()), a.get_number_of_bytes());
+    }
+
+    template <typename T>
+    static ImageIODataType data_type()
+    {
+        if (std::is_same<T, short>::value) return DT_SIGNED_SHORT;
+        if (std::is_same<T, unsigned short>::value) return DT_UINT16;
+        if (std::is_same<T, int>::value) return DT_SIGNED_INT;
+        if (std::is_same<T, unsigned int>::value) return DT_UINT32;
+        if (std::is_same<T, long long>::value || (std::is_same<T, long>::value && sizeof(long) == 8)) return DT_INT64;
+        if (std::is_same<T, unsigned long long>::value || (std::is_same<T, unsigned long>::value && sizeof(unsigned long) == 8)) return DT_UINT64;
+        if (std::is_same<T, float>::value) return DT_FLOAT;
+        if (std::is_same<T, double>::value) return DT_DOUBLE;
+        if (std::is_same<T, std::complex<float> >::value) return DT_COMPLEX;
+        if (std::is_same<T, std::complex<double> >::value) return DT_COMPLEX128;
+        return DT_UNKNOWN;
+    }
+
+protected:
+
+    struct Job
+    {
+        size_t bytes;
+        std::string filename;
+        std::function<void()> write;
+    };
+
+    // Writes a, or a snapshot of it on the writer thread. The snapshot shares the memory of a if a shares it.
+    template <typename Array, typename Write>
+    void submit(const Array& a, const std::string& filename, Write write)
+    {
+        if (queue_bytes_ == 0)
+        {
+            write(a, filename);
+            return;
+        }
+
+        size_t bytes = a.get_number_of_bytes();
+        if (!this->reserve(bytes, filename)) return;
+
+        std::shared_ptr<Array> snapshot;
+        try
+        {
+            snapshot = std::make_shared<Array>(a);
+        }
+        catch (...)
+        {
+            this->release(bytes);
+            throw;
+        }
+
+        this->enqueue(Job{ bytes, filename, [=]() { write(*snapshot, filename); } });
+    }
+
+    template <typename T>
+    void write_compressed(const hoNDArray<T>& a, const std::string& filename)
+    {
+        GADGET_CHECK_THROW(data_type<T>() != DT_UNKNOWN);
+        write_compressed(filename, data_type<T>(), *a.get_dimensions(), reinterpret_cast<const char*>(a.begin()), a.get_number_of_bytes());
+    }
+
+    void write_compressed(const std::string& filename, ImageIODataType type, const std::vector<size_t>& dims, const char* data, size_t bytes);
+
+    struct CompressedReader;
+    static std::shared_ptr<CompressedReader> open_compressed(const std::string& filename, ImageIODataType type, std::vector<size_t>& dims);
+    static void read_compressed(CompressedReader& reader, char* data, size_t bytes);
+
+    bool reserve(size_t bytes, const std::string& filename);
+    void release(size_t bytes);
+    void enqueue(Job job);
+    void write_queued();
+
+    size_t queue_bytes_;
+    Format format_;
+
+    // Used by the writer thread only, or by the caller when writing synchronously
+    ImageIOAnalyze analyze_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<Job> queue_;
+    size_t queued_bytes_;
+    bool writing_;
+    bool closed_;
+    std::atomic<size_t> dropped_;
+    std::thread writer_;
+};
+
+}
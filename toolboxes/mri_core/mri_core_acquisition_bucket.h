@@ -142,6 +142,16 @@ namespace Gadgetron
     }
 
 
+    /// Bytes held in the header, data and trajectory (see Core::payload_bytes).
+    size_t get_number_of_bytes() const
+    {
+      size_t bytes = 0;
+      if (head_) bytes += sizeof(ISMRMRD::AcquisitionHeader);
+      if (data_) bytes += data_->getObjectPtr()->get_number_of_bytes();
+      if (traj_) bytes += traj_->getObjectPtr()->get_number_of_bytes();
+      return bytes;
+    }
+
     GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* head_;
     GadgetContainerMessage< hoNDArray< std::complex<float> > >* data_;
     GadgetContainerMessage< hoNDArray< float > > * traj_;
@@ -166,6 +176,12 @@ namespace Gadgetron
     std::vector< IsmrmrdAcquisitionBucketStats > datastats_;
     std::vector< IsmrmrdAcquisitionBucketStats > refstats_;
     std::vector< ISMRMRD::Waveform > waveform_;
+
+    /// Bytes held in the acquisitions and waveforms of the bucket (see Core::payload_bytes).
+    size_t get_number_of_bytes() const
+    {
+      return Core::payload_bytes(data_) + Core::payload_bytes(ref_) + Core::payload_bytes(waveform_);
+    }
   };
   
 }
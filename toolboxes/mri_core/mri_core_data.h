@@ -119,26 +119,31 @@ namespace Gadgetron
     SamplingDescription sampling_;
 
     IsmrmrdDataBuffered() {}
-    IsmrmrdDataBuffered(const IsmrmrdDataBuffered& obj)
-    {
-        this->data_.copyFrom(obj.data_);
 
-        if (obj.trajectory_)
-        {
-            if (this->trajectory_) {
-                if (this->trajectory_->delete_data_on_destruct()) this->trajectory_->clear();
-            } else {
-                this->trajectory_ = hoNDArray<float>();
-            }
+    // Copies share the arrays of buffers which share them (see share()), and copy them in full otherwise.
+    IsmrmrdDataBuffered(const IsmrmrdDataBuffered& obj) = default;
+    IsmrmrdDataBuffered& operator=(const IsmrmrdDataBuffered& obj) = default;
+    IsmrmrdDataBuffered(IsmrmrdDataBuffered&& obj) = default;
+    IsmrmrdDataBuffered& operator=(IsmrmrdDataBuffered&& obj) = default;
 
-            this->trajectory_->copyFrom(*obj.trajectory_);
-        }
-        
-        this->headers_.copyFrom(obj.headers_);
-        this->sampling_ = obj.sampling_;
+    ~IsmrmrdDataBuffered() {}
+
+    /// Lets copies of the buffer share its arrays, until they are written to (see hoNDArray::share).
+    void share()
+    {
+        this->data_.share();
+        if (this->trajectory_) this->trajectory_->share();
+        if (this->density_) this->density_->share();
+        this->headers_.share();
     }
 
-    ~IsmrmrdDataBuffered() {}
+    /// Bytes held in the arrays of the buffer (see Core::payload_bytes).
+    size_t get_number_of_bytes() const
+    {
+        return Core::payload_bytes(this->data_) + Core::payload_bytes(this->trajectory_)
+            + Core::payload_bytes(this->density_) + Core::payload_bytes(this->headers_)
+            + sizeof(this->sampling_);
+    }
 
     void clear()
     {
@@ -177,6 +182,17 @@ namespace Gadgetron
     }
 
     ~IsmrmrdReconBit() {}
+
+    void share()
+    {
+        this->data_.share();
+        if (this->ref_) this->ref_->share();
+    }
+
+    size_t get_number_of_bytes() const
+    {
+        return Core::payload_bytes(this->data_) + Core::payload_bytes(this->ref_);
+    }
   };
 
   /**
@@ -186,6 +202,16 @@ namespace Gadgetron
   {
   public:
     std::vector<IsmrmrdReconBit> rbit_;
+
+    void share()
+    {
+        for (auto& bit : this->rbit_) bit.share();
+    }
+
+    size_t get_number_of_bytes() const
+    {
+        return Core::payload_bytes(this->rbit_);
+    }
   };
 
   
@@ -210,6 +236,20 @@ namespace Gadgetron
     // acquisition header, [Y, Z, N, S, LOC]
     Core::optional<hoNDArray< ISMRMRD::AcquisitionHeader >> acq_headers_;
 
+    void share()
+    {
+        this->data_.share();
+        this->headers_.share();
+        if (this->acq_headers_) this->acq_headers_->share();
+    }
+
+    size_t get_number_of_bytes() const
+    {
+        return Core::payload_bytes(this->data_) + Core::payload_bytes(this->headers_)
+            + Core::payload_bytes(this->meta_) + Core::payload_bytes(this->waveform_)
+            + Core::payload_bytes(this->acq_headers_);
+    }
+
   };
 
 
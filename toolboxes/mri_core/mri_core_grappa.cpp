@@ -243,6 +243,149 @@ template EXPORTMRICORE void grappa2d_perform_calib(const hoNDArray< std::complex
 
 // ------------------------------------------------------------------------
 
+template <typename T>
+void grappa2d_prepare_calib_lines(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, const std::vector<size_t>& e1Lines, hoNDArray<T>& A, hoNDArray<T>& B)
+{
+    try
+    {
+        GADGET_CHECK_THROW(acsSrc.get_size(0) == acsDst.get_size(0));
+        GADGET_CHECK_THROW(acsSrc.get_size(1) == acsDst.get_size(1));
+        GADGET_CHECK_THROW(acsSrc.get_size(2) >= acsDst.get_size(2));
+
+        size_t RO = acsSrc.get_size(0);
+        size_t E1 = acsSrc.get_size(1);
+        size_t srcCHA = acsSrc.get_size(2);
+        size_t dstCHA = acsDst.get_size(2);
+
+        const T* pSrc = acsSrc.begin();
+        const T* pDst = acsDst.begin();
+
+        long long kROhalf = kRO / 2;
+        kRO = 2 * kROhalf + 1;
+
+        size_t kNE1 = kE1.size();
+        size_t oNE1 = oE1.size();
+
+        size_t sRO = startRO + kROhalf;
+        size_t eRO = endRO - kROhalf;
+        size_t lenRO = eRO - sRO + 1;
+
+        size_t rowA = e1Lines.size()*lenRO;
+        size_t colA = kRO * kNE1*srcCHA;
+        size_t colB = dstCHA * oNE1;
+
+        A.create(rowA, colA);
+        B.create(rowA, colB);
+
+        T* pA = A.begin();
+        T* pB = B.begin();
+
+        for (size_t l = 0; l < e1Lines.size(); l++)
+        {
+            long long e1 = (long long)e1Lines[l];
+            GADGET_CHECK_THROW(e1 + kE1[0] >= 0 && e1 + kE1[kNE1 - 1] < (long long)E1 && e1 + oE1[oNE1 - 1] < (long long)E1);
+
+            for (long long ro = sRO; ro <= (long long)eRO; ro++)
+            {
+                size_t rInd = l*lenRO + ro - sRO;
+
+                size_t col = 0;
+                for (size_t src = 0; src < srcCHA; src++)
+                {
+                    for (size_t ke1 = 0; ke1 < kNE1; ke1++)
+                    {
+                        size_t offset = src * RO*E1 + (e1 + kE1[ke1])*RO;
+                        for (long long kro = -kROhalf; kro <= kROhalf; kro++)
+                        {
+                            pA[rInd + col * rowA] = pSrc[ro + kro + offset];
+                            col++;
+                        }
+                    }
+                }
+
+                col = 0;
+                for (size_t oe1 = 0; oe1 < oNE1; oe1++)
+                {
+                    for (size_t dst = 0; dst < dstCHA; dst++)
+                    {
+                        pB[rInd + col * rowA] = pDst[ro + (e1 + oE1[oe1])*RO + dst*RO*E1];
+                        col++;
+                    }
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa2d_prepare_calib_lines(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void grappa2d_prepare_calib_lines(const hoNDArray< std::complex<float> >& acsSrc, const hoNDArray< std::complex<float> >& acsDst, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, const std::vector<size_t>& e1Lines, hoNDArray< std::complex<float> >& A, hoNDArray< std::complex<float> >& B);
+template EXPORTMRICORE void grappa2d_prepare_calib_lines(const hoNDArray< std::complex<double> >& acsSrc, const hoNDArray< std::complex<double> >& acsDst, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, const std::vector<size_t>& e1Lines, hoNDArray< std::complex<double> >& A, hoNDArray< std::complex<double> >& B);
+
+// ------------------------------------------------------------------------
+
+template <typename T>
+void grappa2d_perform_calib_normal_equations(const hoNDArray<T>& AHA, const hoNDArray<T>& AHB, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, double thres, hoNDArray<T>& ker)
+{
+    try
+    {
+        size_t K = AHA.get_size(0);
+        size_t KB = AHB.get_size(1);
+
+        GADGET_CHECK_THROW(K == AHA.get_size(1));
+        GADGET_CHECK_THROW(K == AHB.get_size(0));
+
+        long long kROhalf = kRO / 2;
+        kRO = 2 * kROhalf + 1;
+
+        size_t kNE1 = kE1.size();
+        size_t oNE1 = oE1.size();
+
+        size_t srcCHA = K / (kRO*kNE1);
+        size_t dstCHA = KB / oNE1;
+
+        ker.create(kRO, kNE1, srcCHA, dstCHA, oNE1);
+
+        /// posv overwrites both sides of the equations
+        hoNDArray<T> lhs(AHA);
+        hoNDArray<T> x(AHB);
+
+        /// same regularization as SolveLinearSystem_Tikhonov
+        double trA = 0;
+        for (size_t c = 0; c < K; c++)
+        {
+            trA += abs(lhs(c, c));
+        }
+
+        double value = trA*thres / K;
+        for (size_t c = 0; c < K; c++)
+        {
+            lhs(c, c) = T((typename realType<T>::Type)(abs(lhs(c, c)) + value));
+        }
+
+        if (trA / K < 4.0)
+        {
+            typename realType<T>::Type scalingFactor = (typename realType<T>::Type)(K*4.0 / trA);
+            Gadgetron::scal(scalingFactor, lhs);
+            Gadgetron::scal(scalingFactor, x);
+        }
+
+        posv(lhs, x);
+        memcpy(ker.begin(), x.begin(), ker.get_number_of_bytes());
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in grappa2d_perform_calib_normal_equations(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void grappa2d_perform_calib_normal_equations(const hoNDArray< std::complex<float> >& AHA, const hoNDArray< std::complex<float> >& AHB, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, double thres, hoNDArray< std::complex<float> >& ker);
+template EXPORTMRICORE void grappa2d_perform_calib_normal_equations(const hoNDArray< std::complex<double> >& AHA, const hoNDArray< std::complex<double> >& AHB, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, double thres, hoNDArray< std::complex<double> >& ker);
+
+// ------------------------------------------------------------------------
+
 template <typename T> 
 void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker)
 {
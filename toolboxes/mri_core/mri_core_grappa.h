@@ -85,6 +85,13 @@ namespace Gadgetron {
     /// solve for ker
     template <typename T> EXPORTMRICORE void grappa2d_perform_calib(const hoNDArray<T>& A, const hoNDArray<T>& B, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, double thres, hoNDArray<T>& ker);
 
+    /// prepare calibration rows for the listed fitting positions e1 only; every e1 must satisfy startE1+|kE1[0]| <= e1 <= endE1-kE1[kNE1-1]
+    /// rows are ordered as in grappa2d_prepare_calib, so the rows of a set of lines can be added to or removed from normal equations
+    template <typename T> EXPORTMRICORE void grappa2d_prepare_calib_lines(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, const std::vector<size_t>& e1Lines, hoNDArray<T>& A, hoNDArray<T>& B);
+
+    /// solve for ker from the normal equations AHA*ker = AHB, with the same Tikhonov regularization as grappa2d_perform_calib
+    template <typename T> EXPORTMRICORE void grappa2d_perform_calib_normal_equations(const hoNDArray<T>& AHA, const hoNDArray<T>& AHB, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, double thres, hoNDArray<T>& ker);
+
     template <typename T> EXPORTMRICORE void grappa2d_calib(const hoNDArray<T>& acsSrc, const hoNDArray<T>& acsDst, double thres, size_t kRO, const std::vector<int>& kE1, const std::vector<int>& oE1, size_t startRO, size_t endRO, size_t startE1, size_t endE1, hoNDArray<T>& ker);
 
     /// convert the grappa multiplication kernel computed from grappa2d_calib to convolution kernel
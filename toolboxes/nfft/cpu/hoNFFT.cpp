@@ -18,6 +18,7 @@
 #include <stdexcept>
 #include <boost/make_shared.hpp>
 
+#include "hoNFFT_cache.h"
 #include "hoNFFT_sparseMatrix.h"
 #include <boost/math/constants/constants.hpp>
 #include <KaiserBessel_kernel.h>
@@ -142,6 +143,30 @@ namespace Gadgetron {
 
 
 
+    namespace {
+        template<class REAL, unsigned int D>
+        std::shared_ptr<const NFFT_internal::NFFT_Deapodization<REAL>> make_deapodization_filters(
+                const vector_td<size_t, D> &matrix_size, const vector_td<size_t, D> &matrix_size_os,
+                REAL W, const vector_td<REAL, D> &beta, bool do_scale) {
+
+            auto key = NFFT_internal::NFFT_Key("deapodization") << sizeof(REAL) << D << matrix_size
+                                                                 << matrix_size_os << W << do_scale;
+
+            return NFFT_internal::NFFT_Cache::instance().get<NFFT_internal::NFFT_Deapodization<REAL>>(key.str(), [&]() {
+                NFFT_internal::NFFT_Deapodization<REAL> filters;
+                filters.IFFT = compute_deapodization_filter(matrix_size_os, beta, W);
+                filters.FFT = filters.IFFT;
+
+                FFTD<std::complex<REAL>, D>::fft(filters.IFFT, NFFT_fft_mode::BACKWARDS, do_scale);
+                FFTD<std::complex<REAL>, D>::fft(filters.FFT, NFFT_fft_mode::FORWARDS, do_scale);
+
+                boost::transform(filters.IFFT, filters.IFFT.begin(), [](auto val) { return REAL(1) / val; });
+                boost::transform(filters.FFT, filters.FFT.begin(), [](auto val) { return REAL(1) / val; });
+                return filters;
+            });
+        }
+    }
+
     template<class REAL, unsigned int D>
     hoNFFT_plan<REAL, D>::hoNFFT_plan(
             const vector_td<size_t, D> &matrix_size,
@@ -150,13 +175,8 @@ namespace Gadgetron {
     ) : NFFT_plan<hoNDArray,REAL,D>(matrix_size,matrix_size_os,W) {
 
         this->beta = compute_beta(W,matrix_size,matrix_size_os);
-        this->deapodization_filter_IFFT = compute_deapodization_filter(this->matrix_size_os,this->beta, this->W);
-        this->deapodization_filter_FFT = deapodization_filter_IFFT;
-        FFTD<std::complex<REAL>,D>::fft(deapodization_filter_IFFT,NFFT_fft_mode::BACKWARDS,true);
-        FFTD<std::complex<REAL>,D>::fft(deapodization_filter_FFT,NFFT_fft_mode::FORWARDS,true);
-
-        boost::transform(deapodization_filter_IFFT,deapodization_filter_IFFT.begin(),[](auto val){return REAL(1)/val;});
-        boost::transform(deapodization_filter_FFT,deapodization_filter_FFT.begin(),[](auto val){return REAL(1)/val;});
+        this->deapodization_filters
+            = make_deapodization_filters(matrix_size, this->matrix_size_os, this->W, this->beta, true);
     }
 
     template<class REAL, unsigned int D>
@@ -165,16 +185,8 @@ namespace Gadgetron {
 
 
         this->beta = compute_beta(W, matrix_size, this->matrix_size_os);
-        this->deapodization_filter_IFFT = compute_deapodization_filter(this->matrix_size_os, this->beta, this->W);
-        this->deapodization_filter_FFT = deapodization_filter_IFFT;
-
-        FFTD<std::complex<REAL>, D>::fft(deapodization_filter_IFFT, NFFT_fft_mode::BACKWARDS, false);
-        FFTD<std::complex<REAL>, D>::fft(deapodization_filter_FFT, NFFT_fft_mode::FORWARDS, false);
-        
-        boost::transform(deapodization_filter_IFFT, deapodization_filter_IFFT.begin(),
-                         [](auto val) { return REAL(1) / val; });
-        boost::transform(deapodization_filter_FFT, deapodization_filter_FFT.begin(),
-                         [](auto val) { return REAL(1) / val; });
+        this->deapodization_filters
+            = make_deapodization_filters(matrix_size, this->matrix_size_os, this->W, this->beta, false);
     }
 
 
@@ -182,25 +194,32 @@ namespace Gadgetron {
     void hoNFFT_plan<REAL, D>::preprocess(
             const hoNDArray<vector_td<REAL, D>> &trajectories, NFFT_prep_mode mode) {
 
-        GadgetronTimer timer("Preprocess");
         NFFT_plan<hoNDArray,REAL,D>::preprocess(trajectories,mode);
-        auto trajectories_scaled = trajectories;
-        auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os);
-        std::transform(trajectories_scaled.begin(),trajectories_scaled.end(),trajectories_scaled.begin(),[matrix_size_os_real](auto point){
-           return (point+REAL(0.5))*matrix_size_os_real;
-        });
 
-        convolution_matrix.reserve(this->number_of_frames);
-        convolution_matrix_T.reserve(this->number_of_frames);
-
-        for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(trajectories_scaled,0)){
-            convolution_matrix.push_back(NFFT_internal::make_NFFT_matrix(traj, this->matrix_size_os, this->W, beta));
-            if (mode == NFFT_prep_mode::ALL || mode == NFFT_prep_mode::NC2C) {
-                convolution_matrix_T.push_back(NFFT_internal::transpose(convolution_matrix.back()));
+        const bool transpose = mode == NFFT_prep_mode::ALL || mode == NFFT_prep_mode::NC2C;
+        auto key = NFFT_internal::NFFT_Key("matrices") << sizeof(REAL) << D << this->matrix_size_os << this->W
+                                                        << beta << transpose << trajectories;
+
+        convolution_matrices = NFFT_internal::NFFT_Cache::instance().get<NFFT_internal::NFFT_Matrices<REAL>>(key.str(), [&]() {
+            GadgetronTimer timer("Preprocess");
+            auto trajectories_scaled = trajectories;
+            auto matrix_size_os_real = vector_td<REAL,D>(this->matrix_size_os);
+            std::transform(trajectories_scaled.begin(),trajectories_scaled.end(),trajectories_scaled.begin(),[matrix_size_os_real](auto point){
+               return (point+REAL(0.5))*matrix_size_os_real;
+            });
+
+            NFFT_internal::NFFT_Matrices<REAL> matrices;
+            matrices.forward.reserve(this->number_of_frames);
+            matrices.transposed.reserve(this->number_of_frames);
+
+            for (auto traj : NDArrayViewRange<hoNDArray<vector_td<REAL,D>>>(trajectories_scaled,0)){
+                matrices.forward.push_back(NFFT_internal::make_NFFT_matrix(traj, this->matrix_size_os, this->W, beta));
+                if (transpose) {
+                    matrices.transposed.push_back(NFFT_internal::transpose(matrices.forward.back()));
+                }
             }
-        }
-
-
+            return matrices;
+        });
     }
 
     template<class REAL, unsigned int D>
@@ -306,9 +325,9 @@ namespace Gadgetron {
             bool fourierDomain
     ) {
         if (fourierDomain){
-            d *= deapodization_filter_FFT;
+            d *= deapodization_filters->FFT;
         } else {
-            d *= deapodization_filter_IFFT;
+            d *= deapodization_filters->IFFT;
         }
     }
         template<class REAL, unsigned int D>
@@ -323,22 +342,15 @@ namespace Gadgetron {
 
 
     namespace {
-        template<class REAL> void
-        matrix_vector_multiply(const Gadgetron::NFFT_internal::NFFT_Matrix<REAL>& matrix, const complext<REAL>* vector, complext<REAL>* result) {
-
-            for (size_t i = 0; i < matrix.n_cols; i++) {
-                auto &row_indices = matrix.indices[i];
-                auto &weights = matrix.weights[i];
-
-#ifndef WIN32
-    #pragma omp simd
-#endif // WIN32
-                for (size_t n = 0; n < row_indices.size(); n++) {
-                    result[i] += vector[row_indices[n]] * weights[n];
-                }
-            }
+        // Batches (frames and coils) are spread over threads when there are enough of them, otherwise the rows
+        // of each convolution are.
+        bool parallel_over_batches(size_t nbatches) {
+#ifdef USE_OMP
+            return nbatches >= size_t(omp_get_max_threads());
+#else
+            return true;
+#endif // USE_OMP
         }
-
     }
     template<class REAL, unsigned int D>
     void hoNFFT_plan<REAL, D>::convolve_NFFT_C2NC(
@@ -346,18 +358,19 @@ namespace Gadgetron {
             hoNDArray<ComplexType> &non_cartesian, bool accumulate
     ) {
 
-        size_t nbatches = cartesian.get_number_of_elements()/convolution_matrix.front().n_rows;
-        assert(nbatches == non_cartesian.get_number_of_elements()/convolution_matrix.front().n_cols);
+        size_t nbatches = cartesian.get_number_of_elements()/convolution_matrices->forward.front().n_rows;
+        assert(nbatches == non_cartesian.get_number_of_elements()/convolution_matrices->forward.front().n_cols);
 
         if (!accumulate) clear(&non_cartesian);
 
-#pragma omp parallel for
+        const bool over_batches = parallel_over_batches(nbatches);
+#pragma omp parallel for if (over_batches)
         for (int b = 0; b < (int)nbatches; b++) {
 
-            const ComplexType* cartesian_view = cartesian.get_data_ptr()+b*convolution_matrix.front().n_rows;
-            ComplexType* non_cartesian_view = non_cartesian.get_data_ptr()+b*convolution_matrix.front().n_cols;
-            size_t matrix_index = b%convolution_matrix.size();
-            matrix_vector_multiply(convolution_matrix[matrix_index],(complext<REAL>*)cartesian_view,(complext<REAL>*)non_cartesian_view);
+            const ComplexType* cartesian_view = cartesian.get_data_ptr()+b*convolution_matrices->forward.front().n_rows;
+            ComplexType* non_cartesian_view = non_cartesian.get_data_ptr()+b*convolution_matrices->forward.front().n_cols;
+            size_t matrix_index = b%convolution_matrices->forward.size();
+            NFFT_internal::matrix_vector_multiply(convolution_matrices->forward[matrix_index],(complext<REAL>*)cartesian_view,(complext<REAL>*)non_cartesian_view, !over_batches);
         }
 
     }
@@ -367,17 +380,19 @@ namespace Gadgetron {
             const hoNDArray<ComplexType> &non_cartesian,
             hoNDArray<ComplexType> &cartesian, bool accumulate
     ) {
-                size_t nbatches = cartesian.get_number_of_elements()/convolution_matrix.front().n_rows;
-        assert(nbatches == non_cartesian.get_number_of_elements()/convolution_matrix.front().n_cols);
+                size_t nbatches = cartesian.get_number_of_elements()/convolution_matrices->forward.front().n_rows;
+        assert(nbatches == non_cartesian.get_number_of_elements()/convolution_matrices->forward.front().n_cols);
         GadgetronTimer timer("Convolution");
         if (!accumulate) clear(&cartesian);
-#pragma omp parallel for
+
+        const bool over_batches = parallel_over_batches(nbatches);
+#pragma omp parallel for if (over_batches)
         for (int b = 0; b < (int)nbatches; b++) {
 
-            ComplexType *cartesian_view = cartesian.get_data_ptr() + b * convolution_matrix.front().n_rows;
-            const ComplexType *non_cartesian_view = non_cartesian.get_data_ptr() + b * convolution_matrix.front().n_cols;
-            size_t matrix_index = b%convolution_matrix.size();
-            matrix_vector_multiply(convolution_matrix_T[matrix_index], (complext<REAL>*)non_cartesian_view, (complext<REAL>*)cartesian_view);
+            ComplexType *cartesian_view = cartesian.get_data_ptr() + b * convolution_matrices->forward.front().n_rows;
+            const ComplexType *non_cartesian_view = non_cartesian.get_data_ptr() + b * convolution_matrices->forward.front().n_cols;
+            size_t matrix_index = b%convolution_matrices->forward.size();
+            NFFT_internal::matrix_vector_multiply(convolution_matrices->transposed[matrix_index], (complext<REAL>*)non_cartesian_view, (complext<REAL>*)cartesian_view, !over_batches);
 
         }
     }
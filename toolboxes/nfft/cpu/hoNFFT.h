@@ -20,6 +20,7 @@
 #include "hoArmadillo.h"
 
 #include "../nfft_export.h"
+#include "hoNFFT_cache.h"
 #include "hoNFFT_sparseMatrix.h"
 
 namespace Gadgetron{
@@ -205,11 +206,8 @@ namespace Gadgetron{
         private:
 
         vector_td<REAL,D> beta;
-        std::vector<NFFT_internal::NFFT_Matrix<REAL>> convolution_matrix;
-        std::vector<NFFT_internal::NFFT_Matrix<REAL>> convolution_matrix_T;
-
-        hoNDArray<ComplexType> deapodization_filter_IFFT;
-        hoNDArray<ComplexType> deapodization_filter_FFT;
+        std::shared_ptr<const NFFT_internal::NFFT_Matrices<REAL>> convolution_matrices;
+        std::shared_ptr<const NFFT_internal::NFFT_Deapodization<REAL>> deapodization_filters;
 
     };
 
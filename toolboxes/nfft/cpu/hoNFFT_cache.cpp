@@ -0,0 +1,87 @@
+#include "hoNFFT_cache.h"
+#include "log.h"
+
+#include <cstdlib>
+
+namespace Gadgetron {
+    namespace NFFT_internal {
+
+        namespace {
+            size_t budget_from_environment() {
+                auto megabytes = std::getenv("GADGETRON_NFFT_CACHE_MB");
+                if (!megabytes)
+                    return size_t(512) << 20;
+                try {
+                    return std::stoull(megabytes) << 20;
+                } catch (const std::exception&) {
+                    GWARN_STREAM("Invalid GADGETRON_NFFT_CACHE_MB " << megabytes << "; using 512 MB.");
+                    return size_t(512) << 20;
+                }
+            }
+
+            template<class REAL> size_t matrix_bytes(const NFFT_Matrix<REAL>& matrix) {
+                return matrix.offsets.size() * sizeof(size_t) + matrix.indices.size() * sizeof(uint32_t)
+                       + matrix.weights.size() * sizeof(REAL) + matrix.order.size() * sizeof(uint32_t);
+            }
+        }
+
+        template<class REAL> size_t NFFT_Matrices<REAL>::bytes() const {
+            size_t total = 0;
+            for (auto& matrix : forward)
+                total += matrix_bytes(matrix);
+            for (auto& matrix : transposed)
+                total += matrix_bytes(matrix);
+            return total;
+        }
+
+        NFFT_Cache& NFFT_Cache::instance() {
+            static NFFT_Cache cache(budget_from_environment());
+            return cache;
+        }
+
+        NFFT_Cache::NFFT_Cache(size_t budget) : budget(budget) {}
+
+        size_t NFFT_Cache::bytes() const {
+            std::lock_guard<std::mutex> guard(mutex);
+            return used;
+        }
+
+        std::shared_ptr<const void> NFFT_Cache::find(const std::string& key) {
+            std::lock_guard<std::mutex> guard(mutex);
+
+            auto entry = entries.find(key);
+            if (entry == entries.end())
+                return nullptr;
+
+            recently_used.splice(recently_used.begin(), recently_used, entry->second.position);
+            return entry->second.value;
+        }
+
+        void NFFT_Cache::insert(const std::string& key, std::shared_ptr<const void> value, size_t bytes) {
+            bytes += key.size();
+            if (bytes > budget)
+                return;
+
+            std::lock_guard<std::mutex> guard(mutex);
+
+            // Another thread may have made the same value in the meantime.
+            if (entries.count(key))
+                return;
+
+            while (used + bytes > budget) {
+                auto oldest = entries.find(*recently_used.back());
+                used -= oldest->second.bytes;
+                recently_used.pop_back();
+                entries.erase(oldest);
+            }
+
+            auto entry = entries.emplace(key, Entry{ std::move(value), bytes, {} }).first;
+            recently_used.push_front(&entry->first);
+            entry->second.position = recently_used.begin();
+            used += bytes;
+        }
+
+        template struct NFFT_Matrices<float>;
+        template struct NFFT_Matrices<double>;
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "../nfft_export.h"
+#include "hoNFFT_sparseMatrix.h"
+
+#include <complex>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+namespace Gadgetron {
+    namespace NFFT_internal {
+
+        /// Convolution matrices of every frame of a trajectory, and their transposes if the adjoint is needed.
+        template<class REAL> struct NFFT_Matrices {
+            std::vector<NFFT_Matrix<REAL>> forward;
+            std::vector<NFFT_Matrix<REAL>> transposed;
+
+            size_t bytes() const;
+        };
+
+        template<class REAL> struct NFFT_Deapodization {
+            hoNDArray<std::complex<REAL>> IFFT;
+            hoNDArray<std::complex<REAL>> FFT;
+
+            size_t bytes() const { return IFFT.get_number_of_bytes() + FFT.get_number_of_bytes(); }
+        };
+
+        /**
+         * Process wide cache of NFFT preprocessing, so plans for a trajectory seen before (the next frame of a
+         * radial or spiral series, or the next scan with the same sequence) skip it entirely.
+         *
+         * Keys are the raw bytes of everything the value depends on, including the trajectory itself, so equal
+         * keys always mean equal values. Keys count towards the memory held by an entry. Least recently used entries are dropped once the cache holds more than
+         * GADGETRON_NFFT_CACHE_MB megabytes (default 512; 0 disables the cache). Values are shared and immutable, so
+         * dropping an entry never affects plans using it.
+         */
+        class EXPORTNFFT NFFT_Cache {
+        public:
+            static NFFT_Cache& instance();
+
+            template<class T, class F> std::shared_ptr<const T> get(const std::string& key, F&& create) {
+                if (auto cached = find(key))
+                    return std::static_pointer_cast<const T>(cached);
+
+                auto value = std::make_shared<const T>(create());
+                insert(key, value, value->bytes());
+                return value;
+            }
+
+            size_t bytes() const;
+
+        private:
+            explicit NFFT_Cache(size_t budget);
+
+            std::shared_ptr<const void> find(const std::string& key);
+            void insert(const std::string& key, std::shared_ptr<const void> value, size_t bytes);
+
+            struct Entry {
+                std::shared_ptr<const void> value;
+                size_t bytes;
+                std::list<const std::string*>::iterator position;
+            };
+
+            const size_t budget;
+            size_t used = 0;
+            mutable std::mutex mutex;
+            std::list<const std::string*> recently_used;
+            std::unordered_map<std::string, Entry> entries;
+        };
+
+        /// Builds cache keys from trivially copyable values and arrays of them.
+        class NFFT_Key {
+        public:
+            explicit NFFT_Key(const std::string& kind) : key(kind) {}
+
+            template<class T> NFFT_Key& operator<<(const T& value) {
+                static_assert(std::is_trivially_copyable<T>::value, "Keys are made from trivially copyable values");
+                key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+                return *this;
+            }
+
+            template<class T> NFFT_Key& operator<<(const hoNDArray<T>& array) {
+                static_assert(std::is_trivially_copyable<T>::value, "Keys are made from trivially copyable values");
+                *this << array.get_number_of_dimensions();
+                for (auto dimension : array.dimensions())
+                    *this << dimension;
+                key.append(reinterpret_cast<const char*>(array.data()), array.get_number_of_bytes());
+                return *this;
+            }
+
+            const std::string& str() const { return key; }
+
+        private:
+            std::string key;
+        };
+    }
+}
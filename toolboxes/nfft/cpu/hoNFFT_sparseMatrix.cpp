@@ -7,7 +7,8 @@
 #include "hoNFFT_sparseMatrix.h"
 #include "KaiserBessel_kernel.h"
 #include "vector_td_utilities.h"
-#include <boost/range/irange.hpp>
+#include <algorithm>
+#include <limits>
 
 namespace {
     using namespace Gadgetron;
@@ -24,19 +25,19 @@ namespace {
     template<class REAL, unsigned int D>
     void iterate_body(const vector_td<REAL, D> &point,
                       const vector_td<size_t, D> &matrix_size, REAL W, const vector_td<REAL, D> &beta,
-                      std::vector<size_t> &indices,
-                      std::vector<REAL> &weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<-1>) {
+                      uint32_t *&indices,
+                      REAL *&weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<-1>) {
 
-        indices.push_back(index);
-        weights.push_back(KaiserBessel(abs(image_point - point), vector_td<REAL,D>(matrix_size), REAL(1) / W, beta));
+        *indices++ = uint32_t(index);
+        *weights++ = KaiserBessel(abs(image_point - point), vector_td<REAL,D>(matrix_size), REAL(1) / W, beta);
 
     }
 
     template<class REAL, unsigned int D, int N>
     void iterate_body(const vector_td<REAL, D> &point,
                       const vector_td<size_t, D> &matrix_size, REAL W, const vector_td<REAL, D> &beta,
-                      std::vector<size_t> &indices,
-                      std::vector<REAL> &weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<N>) {
+                      uint32_t *&indices,
+                      REAL *&weights, vector_td<REAL, D> &image_point, size_t index, iteration_counter<N>) {
 
         size_t frame_offset = std::accumulate(&matrix_size[0], &matrix_size[N], 1, std::multiplies<size_t>());
 
@@ -49,22 +50,30 @@ namespace {
         }
     }
 
+    // The number of grid points iterate_body visits for a sample.
     template<class REAL, unsigned int D>
-    std::tuple<std::vector<size_t>, std::vector<REAL>>
-    get_indices(const vector_td<REAL, D> &point, const vector_td<size_t, D> &matrix_size,
-                REAL W, const vector_td<REAL, D> &beta) {
-
-        std::vector<size_t> indices;
-        indices.reserve(size_t(std::pow(std::ceil(W), D)));
-
-        std::vector<REAL> weights;
-        weights.reserve(size_t(std::pow(std::ceil(W), D)));
-
-        vector_td<REAL, D> image_point;
-        size_t index = 0;
-        iterate_body(point, matrix_size, W, beta, indices, weights, image_point, index, iteration_counter<D - 1>());
+    size_t number_of_neighbours(const vector_td<REAL, D> &point, REAL W) {
+        size_t count = 1;
+        for (unsigned int d = 0; d < D; d++) {
+            int first = std::ceil(point[d] - W * 0.5);
+            int last = std::floor(point[d] + W * 0.5);
+            count *= size_t(std::max(last - first + 1, 0));
+        }
+        return count;
+    }
 
-        return std::make_tuple(std::move(indices), std::move(weights));
+    // Linear index of the grid tile a sample falls in, used to order samples for locality.
+    template<class REAL, unsigned int D>
+    uint64_t tile_of(const vector_td<REAL, D> &point, const vector_td<size_t, D> &matrix_size) {
+        constexpr size_t tile_size = 8;
+
+        uint64_t tile = 0;
+        for (int d = D - 1; d >= 0; d--) {
+            uint64_t tiles = matrix_size[d] / tile_size + 1;
+            uint64_t t = uint64_t(std::max(point[d], REAL(0))) / tile_size;
+            tile = tile * tiles + std::min(t, tiles - 1);
+        }
+        return tile;
     }
 
 
@@ -77,20 +86,40 @@ Gadgetron::NFFT_internal::make_NFFT_matrix(const Gadgetron::hoNDArray<Gadgetron:
                                   const Gadgetron::vector_td<size_t, D> &image_dims, REAL W,
                                   const Gadgetron::vector_td<REAL, D> &beta) {
     GadgetronTimer timer("Make NFFT");
-//    std::vector<std::vector<size_t>> rowind;
-//    rowind.reserve(trajectories.get_number_of_elements() * std::ceil(std::pow(W, 3)));
 
-//    std::vector<size_t> colptr;
-//    colptr.reserve(trajectories.get_number_of_elements() + 1);
+    const size_t samples = trajectories.get_number_of_elements();
+    if (prod(image_dims) > std::numeric_limits<uint32_t>::max() || samples > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("NFFT matrix is too large for 32 bit indices");
+
+    NFFT_Matrix<REAL> matrix(samples, prod(image_dims));
+
+#pragma omp parallel for
+    for (long long i = 0; i < (long long)samples; i++) {
+        matrix.offsets[i + 1] = number_of_neighbours(trajectories[i], W);
+    }
+    std::partial_sum(matrix.offsets.begin(), matrix.offsets.end(), matrix.offsets.begin());
 
-//    std::vector<std::vector<REAL>> weights;
-//    weights.reserve(trajectories.get_number_of_elements() * std::ceil(std::pow(W, 3)));
+    matrix.indices.resize(matrix.offsets.back());
+    matrix.weights.resize(matrix.offsets.back());
 
-    NFFT_Matrix<REAL> matrix(trajectories.get_number_of_elements(),prod(image_dims));
-#pragma omp parallel for 
-    for (int i = 0; i < (int)trajectories.get_number_of_elements(); i++) {
-        std::tie(matrix.indices[i], matrix.weights[i]) = get_indices(trajectories[i], image_dims, W, beta);
+#pragma omp parallel for
+    for (long long i = 0; i < (long long)samples; i++) {
+        uint32_t *indices = matrix.indices.data() + matrix.offsets[i];
+        REAL *weights = matrix.weights.data() + matrix.offsets[i];
+        vector_td<REAL, D> image_point;
+        iterate_body(trajectories[i], image_dims, W, beta, indices, weights, image_point, 0,
+                     iteration_counter<D - 1>());
     }
+
+    std::vector<uint64_t> tiles(samples);
+    for (size_t i = 0; i < samples; i++)
+        tiles[i] = tile_of(trajectories[i], image_dims);
+
+    matrix.order.resize(samples);
+    std::iota(matrix.order.begin(), matrix.order.end(), uint32_t(0));
+    std::stable_sort(matrix.order.begin(), matrix.order.end(),
+                     [&tiles](uint32_t a, uint32_t b) { return tiles[a] < tiles[b]; });
+
     return matrix;
 }
 
@@ -101,36 +130,57 @@ Gadgetron::NFFT_internal::NFFT_Matrix<REAL>
 Gadgetron::NFFT_internal::transpose(const Gadgetron::NFFT_internal::NFFT_Matrix<REAL> &matrix) {
     GadgetronTimer timer("Transpose");
 
-    auto work_index = boost::irange(size_t(0),matrix.n_cols);
-
     NFFT_Matrix<REAL> transposed(matrix.n_rows, matrix.n_cols);
 
-    std::vector<int> counts(matrix.n_rows, 0);
-
-
-    for (size_t i : work_index) {
-        auto &rows = matrix.indices[i];
-        for (auto &row : rows) {
-            counts[row]++;
+    for (auto row : matrix.indices)
+        transposed.offsets[row + 1]++;
+    std::partial_sum(transposed.offsets.begin(), transposed.offsets.end(), transposed.offsets.begin());
+
+    transposed.indices.resize(matrix.indices.size());
+    transposed.weights.resize(matrix.weights.size());
+
+    // Columns are taken in index order, so every transposed row reads its input in increasing order.
+    auto next = std::vector<size_t>(transposed.offsets.begin(), transposed.offsets.end() - 1);
+    for (size_t i = 0; i < matrix.n_cols; i++) {
+        for (size_t n = matrix.offsets[i]; n < matrix.offsets[i + 1]; n++) {
+            auto row = matrix.indices[n];
+            transposed.indices[next[row]] = uint32_t(i);
+            transposed.weights[next[row]] = matrix.weights[n];
+            next[row]++;
         }
     }
 
-    for (size_t i = 0; i < counts.size(); i++) {
-        transposed.indices[i].reserve(counts[i]);
-        transposed.weights[i].reserve(counts[i]);
-    }
-
+    return transposed;
+}
 
-    for (size_t i : work_index ) {
-        auto &rows = matrix.indices[i];
-        auto &weights = matrix.weights[i];
-        for (size_t n = 0; n < rows.size(); n++) {
-            transposed.indices[rows[n]].push_back(i);
-            transposed.weights[rows[n]].push_back(weights[n]);
+template<class REAL>
+void Gadgetron::NFFT_internal::matrix_vector_multiply(const Gadgetron::NFFT_internal::NFFT_Matrix<REAL> &matrix,
+                                                      const Gadgetron::complext<REAL> *vector,
+                                                      Gadgetron::complext<REAL> *result, bool parallel) {
+
+    const REAL *input = reinterpret_cast<const REAL *>(vector);
+    REAL *output = reinterpret_cast<REAL *>(result);
+    const uint32_t *indices = matrix.indices.data();
+    const REAL *weights = matrix.weights.data();
+    const bool ordered = !matrix.order.empty();
+
+#pragma omp parallel for schedule(static, 256) if (parallel)
+    for (long long k = 0; k < (long long)matrix.n_cols; k++) {
+        const size_t i = ordered ? matrix.order[k] : size_t(k);
+
+        REAL real = 0;
+        REAL imag = 0;
+#ifndef WIN32
+    #pragma omp simd reduction(+ : real, imag)
+#endif // WIN32
+        for (size_t n = matrix.offsets[i]; n < matrix.offsets[i + 1]; n++) {
+            real += input[2 * size_t(indices[n])] * weights[n];
+            imag += input[2 * size_t(indices[n]) + 1] * weights[n];
         }
-    }
 
-    return transposed;
+        output[2 * i] += real;
+        output[2 * i + 1] += imag;
+    }
 }
 
 
@@ -163,4 +213,10 @@ template Gadgetron::NFFT_internal::NFFT_Matrix<double> Gadgetron::NFFT_internal:
 template Gadgetron::NFFT_internal::NFFT_Matrix<float> Gadgetron::NFFT_internal::transpose(
         const Gadgetron::NFFT_internal::NFFT_Matrix<float> &matrix);
 template Gadgetron::NFFT_internal::NFFT_Matrix<double> Gadgetron::NFFT_internal::transpose(
-        const Gadgetron::NFFT_internal::NFFT_Matrix<double> &matrix);
\ No newline at end of file
+        const Gadgetron::NFFT_internal::NFFT_Matrix<double> &matrix);
+template void Gadgetron::NFFT_internal::matrix_vector_multiply(
+        const Gadgetron::NFFT_internal::NFFT_Matrix<float> &matrix, const Gadgetron::complext<float> *vector,
+        Gadgetron::complext<float> *result, bool parallel);
+template void Gadgetron::NFFT_internal::matrix_vector_multiply(
+        const Gadgetron::NFFT_internal::NFFT_Matrix<double> &matrix, const Gadgetron::complext<double> *vector,
+        Gadgetron::complext<double> *result, bool parallel);
@@ -3,19 +3,30 @@
 #include "hoArmadillo.h"
 #include "hoNDArray.h"
 #include "vector_td.h"
+#include "complext.h"
+
+#include <cstdint>
 
 namespace Gadgetron {
     namespace NFFT_internal {
 
+        /**
+         * Gridding convolution matrix in compressed sparse row form. Row i (one of n_cols; a non-Cartesian sample
+         * for the forward matrix, a grid point for the transposed one) holds the entries offsets[i] to
+         * offsets[i+1] of indices and weights, so the whole matrix lives in three contiguous arrays.
+         *
+         * Rows are visited in the order given by order, which for the forward matrix groups samples by grid tile,
+         * so consecutive samples gather from the same part of the grid.
+         */
         template<class REAL> struct NFFT_Matrix {
 
-            NFFT_Matrix(size_t cols, size_t rows) : n_cols(cols),n_rows(rows) {
-                weights = std::vector<std::vector<REAL>>(n_cols);
-                indices = std::vector<std::vector<size_t>>(n_cols);
-            }
+            NFFT_Matrix(size_t cols, size_t rows) : offsets(cols + 1, 0), n_cols(cols), n_rows(rows) {}
             NFFT_Matrix(){}
-            std::vector<std::vector<REAL>> weights;
-            std::vector<std::vector<size_t>> indices;
+
+            std::vector<size_t> offsets;
+            std::vector<uint32_t> indices;
+            std::vector<REAL> weights;
+            std::vector<uint32_t> order;
             size_t n_cols, n_rows;
         };
 
@@ -26,7 +37,14 @@ namespace Gadgetron {
         NFFT_Matrix<REAL>
         make_NFFT_matrix(const hoNDArray<vector_td<REAL, D>> trajectories, const vector_td<size_t, D> &image_dims,
                          REAL W, const vector_td<REAL, D> &beta);
+
+        /**
+         * Computes result += matrix * vector. Rows are independent, so the rows are split over threads when
+         * parallel is set, with no synchronisation between them.
+         */
+        template<class REAL>
+        void matrix_vector_multiply(const NFFT_Matrix<REAL>& matrix, const complext<REAL>* vector,
+                                    complext<REAL>* result, bool parallel);
     }
 }
 
-